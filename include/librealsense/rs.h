@@ -44,6 +44,7 @@ typedef enum rs_stream
     RS_STREAM_DEPTH_ALIGNED_TO_COLOR           , /**< Synthetic stream containing depth data but sharing intrinsic of color stream */
     RS_STREAM_DEPTH_ALIGNED_TO_RECTIFIED_COLOR , /**< Synthetic stream containing depth data but sharing intrinsic of rectified color stream */
     RS_STREAM_DEPTH_ALIGNED_TO_INFRARED2       , /**< Synthetic stream containing depth data but sharing intrinsic of second viewpoint infrared stream */
+    RS_STREAM_COLORED_POINTS                   , /**< Synthetic stream containing point cloud data generated by deprojecting the depth image, with the color of the pixel of the color stream each point lands on */
     RS_STREAM_COUNT                              /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
 } rs_stream;
 
@@ -66,6 +67,9 @@ typedef enum rs_format
     RS_FORMAT_RAW10       , /**< Four 10-bit luminance values encoded into a 5-byte macropixel */
     RS_FORMAT_RAW16       , /**< 16-bit raw image */
     RS_FORMAT_RAW8        , /**< 8-bit raw image */
+    RS_FORMAT_XYZ16F      , /**< 16-bit half precision floating point 3D coordinates, in meters. */
+    RS_FORMAT_XYZ16       , /**< 16-bit signed 3D coordinates, in millimeters. Coordinates beyond the range of the type are saturated. */
+    RS_FORMAT_XYZRGB      , /**< 32-bit floating point 3D coordinates, followed by 8-bit red, green and blue channels and one byte of padding, 16 bytes in all. */
     RS_FORMAT_COUNT         /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
 } rs_format;
 
@@ -77,6 +81,25 @@ typedef enum rs_output_buffer_format
     RS_OUTPUT_BUFFER_FORMAT_COUNT            /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
 } rs_output_buffer_format;
 
+/** \brief Capture memory: sets how the driver-side buffers that receive raw frames are allocated and shared. Only honored by the V4L2 backend. */
+typedef enum rs_capture_memory
+{
+    RS_CAPTURE_MEMORY_MMAP                 , /**< Driver-allocated buffers mapped into the process */
+    RS_CAPTURE_MEMORY_USERPTR              , /**< Page-aligned buffers allocated by librealsense that the driver captures into directly */
+    RS_CAPTURE_MEMORY_DMABUF               , /**< Driver-allocated buffers that are also exported as DMABUF file descriptors, see \c RS_FRAME_METADATA_DMABUF_FD */
+    RS_CAPTURE_MEMORY_COUNT                  /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
+} rs_capture_memory;
+
+/** \brief Sync policy: sets how rs_wait_for_frames() matches the frames of other streams to each frame of the key stream, trading latency against coherence */
+typedef enum rs_sync_policy
+{
+    RS_SYNC_POLICY_NEAREST                 , /**< Every key stream frame forms a frameset right away, with the frames of other streams nearest to it in time */
+    RS_SYNC_POLICY_FRAME_NUMBER            , /**< Frames of other streams are matched to the key stream frame with the same frame number, which streams of one subdevice share */
+    RS_SYNC_POLICY_WINDOW                  , /**< Frames of other streams are matched to the key stream frame if within \c RS_OPTION_SYNC_TOLERANCE of it */
+    RS_SYNC_POLICY_COMPLETE                , /**< Like \c RS_SYNC_POLICY_WINDOW, but key stream frames without a match in every stream are dropped */
+    RS_SYNC_POLICY_COUNT                     /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
+} rs_sync_policy;
+
 /** \brief Presets: general preferences that are translated by librealsense into concrete resolution and FPS. */
 typedef enum rs_preset
 {
@@ -192,9 +215,32 @@ typedef enum rs_option
     RS_OPTION_FISHEYE_AUTO_EXPOSURE_ANTIFLICKER_RATE          , /**< Fisheye auto-exposure anti-flicker rate. Can be 50 or 60 Hz. */
     RS_OPTION_FISHEYE_AUTO_EXPOSURE_PIXEL_SAMPLE_RATE         , /**< In Fisheye auto-exposure sample frame every given number of pixels */
     RS_OPTION_FISHEYE_AUTO_EXPOSURE_SKIP_FRAMES               , /**< In Fisheye auto-exposure sample every given number of frames */
-    RS_OPTION_FRAMES_QUEUE_SIZE                               , /**< Number of frames the user is allowed to keep per stream. Trying to hold on to more frames will cause frame-drops.*/
+    RS_OPTION_FRAMES_QUEUE_SIZE                               , /**< Number of frames the user is allowed to keep per stream. Trying to hold on to more frames will cause frame-drops. Room for this many frames of every stream is reserved when streaming starts.*/
     RS_OPTION_HARDWARE_LOGGER_ENABLED                         , /**< Enable/disable fetching log data from the device */
     RS_OPTION_TOTAL_FRAME_DROPS                               , /**< Total number of detected frame drops from all streams */
+    RS_OPTION_FRAME_POOL_HITS                                 , /**< Total number of frame buffers reused from the frame pool */
+    RS_OPTION_FRAME_POOL_MISSES                               , /**< Total number of frame buffers allocated because the frame pool was empty */
+    RS_OPTION_FRAME_POOL_EVICTIONS                            , /**< Total number of released frame buffers freed because the frame pool was full */
+    RS_OPTION_CAPTURE_BUFFERS_COUNT                           , /**< Number of buffers each subdevice streams into on the driver side (V4L2 backend). Takes effect on the next start. */
+    RS_OPTION_ZERO_COPY_ENABLED                               , /**< Enable/disable passing the driver's buffers directly to the application for frames that need no unpacking, whatever the capture memory. Every held frame keeps a capture buffer busy. Nothing falls back: a subdevice without RS_CAPTURE_MEMORY_USERPTR support fails to start, and a RS_CAPTURE_MEMORY_DMABUF buffer the driver cannot export is passed through without RS_FRAME_METADATA_DMABUF_FD. Takes effect on the next start. */
+    RS_OPTION_CAPTURE_THREAD_PER_SUBDEVICE                    , /**< Enable/disable a dedicated capture thread for each subdevice, so that processing one stream never delays dequeuing another (V4L2 backend). Takes effect on the next start. */
+    RS_OPTION_CAPTURE_THREAD_AFFINITY                         , /**< First CPU the capture threads are pinned to, one CPU per thread, or -1 to leave them unpinned (V4L2 backend). Takes effect on the next start. */
+    RS_OPTION_CAPTURE_THREAD_PRIORITY                         , /**< SCHED_FIFO priority of the capture threads, or 0 for the default scheduler (V4L2 backend). Usually requires CAP_SYS_NICE. Takes effect on the next start. */
+    RS_OPTION_UNPACK_THREADS                                  , /**< Number of threads that unpack each frame in bands of rows, including the capture thread. 1 unpacks on the capture thread alone. Takes effect on the next start. */
+    RS_OPTION_LAZY_UNPACK_ENABLED                             , /**< Enable/disable converting frames only when their data is first accessed, so that dropped frames are never unpacked. Until then every frame keeps a capture buffer busy. Applies to formats that unpack into a single stream. Takes effect on the next start. */
+    RS_OPTION_ALIGNMENT_THREADS                               , /**< Number of threads that compute aligned streams, such as RS_STREAM_DEPTH_ALIGNED_TO_COLOR, including the thread reading the frame. Takes effect on the next start. */
+    RS_OPTION_INCREMENTAL_ALIGNMENT_ENABLED                   , /**< Enable/disable reprojecting only the blocks of the depth image that changed since the previous frame when computing aligned streams. Speeds up static scenes, the result is unchanged. Takes effect on the next start. */
+    RS_OPTION_COMPACT_POINT_CLOUD_ENABLED                     , /**< Enable/disable writing only the points of pixels with depth to RS_STREAM_POINTS, packed at the start of the frame in the order of their pixels. rs_get_point_count() returns how many there are. Takes effect on the next start. */
+    RS_OPTION_SYNC_QUEUE_SIZE                                 , /**< Number of frames each stream keeps queued while waiting to be matched into a frameset by rs_wait_for_frames(), beyond which the oldest is dropped. Takes effect on the next start. */
+    RS_OPTION_SYNC_POLICY                                     , /**< How rs_wait_for_frames() matches frames into framesets, see rs_sync_policy. Takes effect on the next start. */
+    RS_OPTION_SYNC_TOLERANCE                                  , /**< Largest difference in milliseconds between the timestamps of matching frames under RS_SYNC_POLICY_WINDOW and RS_SYNC_POLICY_COMPLETE, or 0 for half the frame interval of the key stream. Takes effect on the next start. */
+    RS_OPTION_SYNC_MAX_LATENCY                                , /**< Longest time in milliseconds a key stream frame waits for its matches in other streams under every policy but RS_SYNC_POLICY_NEAREST, or 0 for one frame interval of the key stream. Takes effect on the next start. */
+    RS_OPTION_SYNC_FRAMESETS                                  , /**< Total number of framesets delivered by rs_wait_for_frames() and rs_poll_for_frames() */
+    RS_OPTION_SYNC_INCOMPLETE_FRAMESETS                       , /**< Total number of delivered framesets in which some stream had no frame matching the key stream frame, and kept its previous frame */
+    RS_OPTION_SYNC_DROPPED_FRAMES                             , /**< Total number of key stream frames dropped by RS_SYNC_POLICY_COMPLETE for lack of a match in every stream */
+    RS_OPTION_SYNC_AVERAGE_LATENCY                            , /**< Average time in milliseconds the key stream frame of each delivered frameset was queued */
+    RS_OPTION_FRAME_CAPACITY_DROPS                            , /**< Total number of frames, framesets and frame references withheld from the user because the room reserved from RS_OPTION_FRAMES_QUEUE_SIZE at start was exhausted */
+    RS_OPTION_BILINEAR_RECTIFICATION_ENABLED                  , /**< Enable/disable interpolating RS_STREAM_RECTIFIED_COLOR between the four nearest color pixels instead of copying the nearest one. Smoother, but several times slower, especially without AVX2. Depth is always sampled at the nearest pixel. Takes effect on the next start. */
     RS_OPTION_COUNT                                           , /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
 
 } rs_option;
@@ -204,6 +250,7 @@ typedef enum rs_frame_metadata
 {
     RS_FRAME_METADATA_ACTUAL_EXPOSURE, /**< Actual exposure at which the frame was captured */
     RS_FRAME_METADATA_ACTUAL_FPS,      /**< Actual FPS at the time of capture */
+    RS_FRAME_METADATA_DMABUF_FD,       /**< DMABUF file descriptor of the capture buffer holding the frame. Only available for frames that need no unpacking, when captured with \c RS_CAPTURE_MEMORY_DMABUF. Owned by the library and valid while the frame is held. */
     RS_FRAME_METADATA_COUNT            /**< Number of enumeration values. Not a valid input: intended to be used in for-loops. */
 } rs_frame_metadata;
 
@@ -361,11 +408,14 @@ typedef struct rs_motion_callback rs_motion_callback;
 typedef struct rs_frame_callback rs_frame_callback;
 typedef struct rs_timestamp_callback rs_timestamp_callback;
 typedef struct rs_log_callback rs_log_callback;
+typedef struct rs_frame_allocator rs_frame_allocator;
 
 typedef void (*rs_frame_callback_ptr)(rs_device * dev, rs_frame_ref * frame, void * user);
 typedef void (*rs_motion_callback_ptr)(rs_device * , rs_motion_data, void * );
 typedef void (*rs_timestamp_callback_ptr)(rs_device * , rs_timestamp_data, void * );
 typedef void (*rs_log_callback_ptr)(rs_log_severity min_severity, const char * message, void * user);
+typedef void * (*rs_frame_alloc_ptr)(rs_device * dev, unsigned int size, unsigned int alignment, void * user);
+typedef void (*rs_frame_free_ptr)(rs_device * dev, void * ptr, unsigned int size, void * user);
 
 /**
 * \brief Creates RealSense context that is required for the rest of the API.
@@ -461,6 +511,78 @@ void rs_get_device_extrinsics(const rs_device * device, rs_stream from_stream, r
 */
 void rs_get_motion_extrinsics_from(const rs_device * device, rs_stream from, rs_extrinsics * extrin, rs_error ** error);
 
+/**
+ * \brief Projects an array of points to pixel coordinates, as rs_project_point_to_pixel() does for each, including distortion models it does not support
+ * \param[out] pixels  Array of count pixel coordinates, as interleaved x, y pairs
+ * \param[in] intrin   Intrinsics of the image the points are projected into
+ * \param[in] points   Array of count points, as interleaved x, y, z triples
+ * \param[in] count    Number of points
+ * \param[out] error   If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ */
+void rs_project_points_to_pixels(float * pixels, const rs_intrinsics * intrin, const float * points, int count, rs_error ** error);
+
+/**
+ * \brief Projects an array of points to pixel coordinates, with each coordinate held in a separate array
+ * \param[out] pixel_x  Array of count pixel x coordinates
+ * \param[out] pixel_y  Array of count pixel y coordinates
+ * \param[in] intrin    Intrinsics of the image the points are projected into
+ * \param[in] point_x   Array of count point x coordinates
+ * \param[in] point_y   Array of count point y coordinates
+ * \param[in] point_z   Array of count point z coordinates
+ * \param[in] count     Number of points
+ * \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ */
+void rs_project_points_to_pixels_soa(float * pixel_x, float * pixel_y, const rs_intrinsics * intrin, const float * point_x, const float * point_y, const float * point_z, int count, rs_error ** error);
+
+/**
+ * \brief Deprojects an array of pixels with known depths to points, as rs_deproject_pixel_to_point() does for each, including distortion models it does not support
+ * \param[out] points  Array of count points, as interleaved x, y, z triples
+ * \param[in] intrin   Intrinsics of the image the pixels belong to
+ * \param[in] pixels   Array of count pixel coordinates, as interleaved x, y pairs
+ * \param[in] depths   Array of count depths, in the units the points are produced in
+ * \param[in] count    Number of pixels
+ * \param[out] error   If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ */
+void rs_deproject_pixels_to_points(float * points, const rs_intrinsics * intrin, const float * pixels, const float * depths, int count, rs_error ** error);
+
+/**
+ * \brief Deprojects an array of pixels with known depths to points, with each coordinate held in a separate array
+ * \param[out] point_x  Array of count point x coordinates
+ * \param[out] point_y  Array of count point y coordinates
+ * \param[out] point_z  Array of count point z coordinates
+ * \param[in] intrin    Intrinsics of the image the pixels belong to
+ * \param[in] pixel_x   Array of count pixel x coordinates
+ * \param[in] pixel_y   Array of count pixel y coordinates
+ * \param[in] depths    Array of count depths, in the units the points are produced in
+ * \param[in] count     Number of pixels
+ * \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ */
+void rs_deproject_pixels_to_points_soa(float * point_x, float * point_y, float * point_z, const rs_intrinsics * intrin, const float * pixel_x, const float * pixel_y, const float * depths, int count, rs_error ** error);
+
+/**
+ * \brief Transforms an array of points from one viewpoint to another, as rs_transform_point_to_point() does for each
+ * \param[out] to_points  Array of count transformed points, as interleaved x, y, z triples, which may be the same array as from_points
+ * \param[in] extrin      Transformation between the two viewpoints
+ * \param[in] from_points Array of count points, as interleaved x, y, z triples
+ * \param[in] count       Number of points
+ * \param[out] error      If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ */
+void rs_transform_points_to_points(float * to_points, const rs_extrinsics * extrin, const float * from_points, int count, rs_error ** error);
+
+/**
+ * \brief Transforms an array of points from one viewpoint to another, with each coordinate held in a separate array
+ * \param[out] to_x    Array of count transformed x coordinates, which may be the same array as from_x, and likewise for y and z
+ * \param[out] to_y    Array of count transformed y coordinates
+ * \param[out] to_z    Array of count transformed z coordinates
+ * \param[in] extrin   Transformation between the two viewpoints
+ * \param[in] from_x   Array of count x coordinates
+ * \param[in] from_y   Array of count y coordinates
+ * \param[in] from_z   Array of count z coordinates
+ * \param[in] count    Number of points
+ * \param[out] error   If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ */
+void rs_transform_points_to_points_soa(float * to_x, float * to_y, float * to_z, const rs_extrinsics * extrin, const float * from_x, const float * from_y, const float * from_z, int count, rs_error ** error);
+
 /**
  * \brief Retrieves mapping between the units of the depth image and meters
  * \param[in] device  Relevant RealSense device
@@ -522,6 +644,7 @@ void rs_enable_stream_ex(rs_device * device, rs_stream stream, int width, int he
 * \param[in] format         Pixel format of a frame image, or ANY if any format is acceptable
 * \param[in] framerate      Number of frames that will be streamed per second, or 0 if any frame rate is acceptable
 * \param[out] error         If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+* \note RS_STREAM_POINTS is always available along with RS_STREAM_DEPTH, and only its format can be requested: RS_FORMAT_XYZ32F, RS_FORMAT_XYZ16F or RS_FORMAT_XYZ16
 */
 void rs_enable_stream(rs_device * device, rs_stream stream, int width, int height, rs_format format, int framerate, rs_error ** error);
 
@@ -668,6 +791,57 @@ void rs_enable_motion_tracking_cpp(rs_device * device,
  */
 void rs_set_frame_callback_cpp(rs_device * device, rs_stream stream, rs_frame_callback * callback, rs_error ** error);
 
+/**
+* \brief Sets up a custom allocator for the buffers that receive unpacked frame data
+*
+* The allocator is asked for memory whenever the library runs out of recycled frame buffers, and must return a block of at least \c size bytes,
+* aligned to \c alignment (currently 64) bytes. Buffers are returned through \c on_free, possibly from any thread that releases a frame.
+* If the allocator fails or returns a misaligned block, the frame is placed in library-owned memory instead.
+* Must be called before \c rs_start_device().
+* \param[in] device    Relevant RealSense device
+* \param[in] on_alloc  User-defined routine that allocates a frame buffer
+* \param[in] on_free   User-defined routine that frees a frame buffer obtained from \c on_alloc
+* \param[in] user      User data point to be passed to both routines
+* \param[out] error    If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+* \see \c rs_set_frame_allocator_cpp()
+*/
+void rs_set_frame_allocator(rs_device * device, rs_frame_alloc_ptr on_alloc, rs_frame_free_ptr on_free, void * user, rs_error ** error);
+
+/**
+* \brief Sets up a custom allocator for the buffers that receive unpacked frame data
+*
+* This variant of \c rs_set_frame_allocator() is provided specifically to enable passing lambdas with capture lists safely into the library.
+* \param[in] device     Relevant RealSense device
+* \param[in] allocator  Allocator object, released by the library once no frame buffer obtained from it is alive
+* \param[out] error     If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+* \see \c rs_set_frame_allocator()
+*/
+void rs_set_frame_allocator_cpp(rs_device * device, rs_frame_allocator * allocator, rs_error ** error);
+
+/**
+* \brief Sets the number of driver-side capture buffers and how they are allocated for a specific stream
+*
+* Streams that are served by the same subdevice share its buffers: the largest count and the first memory type other than \c RS_CAPTURE_MEMORY_MMAP win.
+* Must be called before \c rs_start_device().
+* \param[in] device  Relevant RealSense device
+* \param[in] stream  Native stream
+* \param[in] count   Number of buffers to request from the driver, or 0 to use \c RS_OPTION_CAPTURE_BUFFERS_COUNT
+* \param[in] memory  Capture memory model
+* \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+*/
+void rs_set_stream_capture_buffers(rs_device * device, rs_stream stream, int count, rs_capture_memory memory, rs_error ** error);
+
+/**
+* \brief Sets the number of frames a specific stream keeps queued while waiting to be matched into a frameset by \c rs_wait_for_frames()
+*
+* When the queue is full, the oldest frame is dropped. Must be called before \c rs_start_device().
+* \param[in] device  Relevant RealSense device
+* \param[in] stream  Native stream
+* \param[in] size    Number of frames to keep queued, or 0 to use \c RS_OPTION_SYNC_QUEUE_SIZE
+* \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+*/
+void rs_set_stream_sync_queue_size(rs_device * device, rs_stream stream, int size, rs_error ** error);
+
 /**
 * \brief Disables motion-tracking handlers
 * \param[in] device    Relevant RealSense device
@@ -810,6 +984,15 @@ void rs_set_device_option(rs_device * device, rs_option option, double value, rs
  */
 void rs_wait_for_frames(rs_device * device, rs_error ** error);
 
+/**
+ * \brief Blocks until new frames are available or the timeout expires
+ * \param[in] device      Relevant RealSense device
+ * \param[in] timeout_ms  Longest time to wait, in milliseconds. 0 checks for new frames without blocking.
+ * \param[out] error      If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ * \return                1 if new frames are available, 0 if the timeout expired first
+ */
+int rs_wait_for_frames_timeout(rs_device * device, unsigned int timeout_ms, rs_error ** error);
+
 /**
  * \brief Checks if new frames are available, without blocking
  * \param[in] device  Relevant RealSense device
@@ -818,6 +1001,16 @@ void rs_wait_for_frames(rs_device * device, rs_error ** error);
  */
 int rs_poll_for_frames(rs_device * device, rs_error ** error);
 
+/**
+ * \brief Retrieves a file descriptor which is readable while new frames are available, to wait for frames with poll(), select() or epoll alongside other events
+ * \details The descriptor is owned by the device and stays valid across start and stop, it must not be read from or closed by the application.
+ * Call rs_poll_for_frames() when it becomes readable. Not supported on Windows.
+ * \param[in] device  Relevant RealSense device
+ * \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ * \return            The file descriptor
+ */
+int rs_get_frames_ready_fd(const rs_device * device, rs_error ** error);
+
 /**
  * \brief Determines device capabilities
  * \param[in] device      Relevant RealSense device
@@ -881,6 +1074,41 @@ unsigned long long rs_get_frame_number(const rs_device * device, rs_stream strea
  */
 const void * rs_get_frame_data(const rs_device * device, rs_stream stream, rs_error ** error);
 
+/**
+ * \brief Retrieves the number of points in the latest frame of RS_STREAM_POINTS, which is every pixel unless RS_OPTION_COMPACT_POINT_CLOUD_ENABLED is set
+ * \param[in] device  Relevant RealSense device
+ * \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ * \return            Number of points
+ */
+int rs_get_point_count(const rs_device * device, rs_error ** error);
+
+/**
+ * \brief Retrieves the index into the depth image, y * width + x, of the pixel each point of the latest frame of RS_STREAM_POINTS was deprojected from
+ * \param[in] device  Relevant RealSense device
+ * \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ * \return            Pointer to rs_get_point_count() indices, valid until the next frame
+ */
+const int * rs_get_point_pixel_indices(const rs_device * device, rs_error ** error);
+
+/**
+ * \brief Retrieves where each point of the latest frame of RS_STREAM_POINTS lands in the image of RS_STREAM_COLOR, which must be enabled
+ * \param[in] device  Relevant RealSense device
+ * \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ * \return            Pointer to rs_get_point_count() u, v pairs, from 0 to 1 across the color image, valid until the next frame. Points without depth have no coordinates.
+ */
+const float * rs_get_point_texture_coordinates(const rs_device * device, rs_error ** error);
+
+/**
+ * \brief Computes a frame of a stream derived from other streams, such as RS_STREAM_POINTS or RS_STREAM_DEPTH_ALIGNED_TO_COLOR, from detached frames
+ * \param[in] device  Relevant RealSense device, which must be streaming
+ * \param[in] stream  Derived stream whose frame to compute
+ * \param[in] frame   Frame of the stream the derived stream is computed from, such as RS_STREAM_DEPTH for RS_STREAM_POINTS
+ * \param[in] other   Frame of the second stream the derived stream is computed from, such as RS_STREAM_COLOR for RS_STREAM_COLOR_ALIGNED_TO_DEPTH, or null if it has none
+ * \param[out] error  If non-null, receives any error that occurs during this call, otherwise, errors are ignored.
+ * \return            Handle to the new frame, with the frame number and timestamp of frame, to be released with rs_release_frame(). Point frames hold a point for every pixel.
+ */
+rs_frame_ref * rs_compute_detached_frame(rs_device * device, rs_stream stream, const rs_frame_ref * frame, const rs_frame_ref * other, rs_error ** error);
+
 /**
 * \brief Releases frame handle
 * \param[in] device  Relevant RealSense device
@@ -1038,6 +1266,8 @@ const char * rs_camera_info_to_string(rs_camera_info info);
 const char * rs_camera_info_to_string(rs_camera_info info);
 const char * rs_timestamp_domain_to_string(rs_timestamp_domain info);
 const char * rs_frame_metadata_to_string(rs_frame_metadata md);
+const char * rs_capture_memory_to_string(rs_capture_memory memory);
+const char * rs_sync_policy_to_string(rs_sync_policy policy);
 
 /**
 * \brief Starts logging to console
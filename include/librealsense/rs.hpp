@@ -34,7 +34,8 @@ namespace rs
         infrared2_aligned_to_depth      ,  /**< Synthetic stream containing second viewpoint infrared data but sharing intrinsic of depth stream */
         depth_aligned_to_color          ,  /**< Synthetic stream containing depth data but sharing intrinsic of color stream */
         depth_aligned_to_rectified_color,  /**< Synthetic stream containing depth data but sharing intrinsic of rectified color stream */
-        depth_aligned_to_infrared2         /**< Synthetic stream containing depth data but sharing intrinsic of second viewpoint infrared stream */
+        depth_aligned_to_infrared2      ,  /**< Synthetic stream containing depth data but sharing intrinsic of second viewpoint infrared stream */
+        colored_points                     /**< Synthetic stream containing point cloud data generated by deprojecting the depth image, with the color of the pixel of the color stream each point lands on */
     };
 
     ///  \brief Formats: defines how each stream can be encoded.
@@ -54,7 +55,10 @@ namespace rs
         y16         ,  /**< 16-bit per-pixel grayscale image */
         raw10       ,  /**< Four 10-bit luminance values encoded into a 5-byte macropixel */
         raw16       ,  /**< 16-bit raw image */
-        raw8           /**< 8-bit raw image */
+        raw8        ,  /**< 8-bit raw image */
+        xyz16f      ,  /**< 16-bit half precision floating point 3D coordinates, in meters. */
+        xyz16       ,  /**< 16-bit signed 3D coordinates, in millimeters. Coordinates beyond the range of the type are saturated. */
+        xyzrgb         /**< 32-bit floating point 3D coordinates, followed by 8-bit red, green and blue channels and one byte of padding, 16 bytes in all. */
     };
 
     /// \brief Output buffer format: sets how librealsense works with frame memory.
@@ -64,6 +68,23 @@ namespace rs
         native           /**< Does not convert buffer to continuous. The user has to handle pitch manually. */
     };
 
+    /// \brief Capture memory: sets how the driver-side buffers that receive raw frames are allocated and shared. Only honored by the V4L2 backend.
+    enum class capture_memory : int32_t
+    {
+        mmap           , /**< Driver-allocated buffers mapped into the process */
+        userptr        , /**< Page-aligned buffers allocated by librealsense that the driver captures into directly */
+        dmabuf           /**< Driver-allocated buffers that are also exported as DMABUF file descriptors, see frame_metadata::dmabuf_fd */
+    };
+
+    /// \brief Sync policy: sets how rs::device::wait_for_frames() matches the frames of other streams to each frame of the key stream, trading latency against coherence
+    enum class sync_policy : int32_t
+    {
+        nearest        , /**< Every key stream frame forms a frameset right away, with the frames of other streams nearest to it in time */
+        frame_number   , /**< Frames of other streams are matched to the key stream frame with the same frame number, which streams of one subdevice share */
+        window         , /**< Frames of other streams are matched to the key stream frame if within option::sync_tolerance of it */
+        complete         /**< Like sync_policy::window, but key stream frames without a match in every stream are dropped */
+    };
+
     /// \brief Presets: general preferences that are translated by librealsense into concrete resolution and FPS.
     enum class preset : int32_t
     {
@@ -151,16 +172,40 @@ namespace rs
         fisheye_color_auto_exposure_rate                , /**< Fisheye auto-exposure anti-flicker rate. Can be 50 or 60 Hz. */
         fisheye_color_auto_exposure_sample_rate         , /**< In fisheye auto-exposure sample frame, every given number of pixels */
         fisheye_color_auto_exposure_skip_frames         , /**< In fisheye auto-exposure sample, every given number of frames. */
-        frames_queue_size                               , /**< Number of frames the user is allowed to keep per stream. Trying to hold on to more frames will cause frame-drops.*/
+        frames_queue_size                               , /**< Number of frames the user is allowed to keep per stream. Trying to hold on to more frames will cause frame-drops. Room for this many frames of every stream is reserved when streaming starts.*/
         hardware_logger_enabled                         , /**< Enable/disable fetching log data from the device */
         total_frame_drops                               , /**< Total number of detected frame drops from all streams*/
+        frame_pool_hits                                 , /**< Total number of frame buffers reused from the frame pool */
+        frame_pool_misses                               , /**< Total number of frame buffers allocated because the frame pool was empty */
+        frame_pool_evictions                            , /**< Total number of released frame buffers freed because the frame pool was full */
+        capture_buffers_count                           , /**< Number of buffers each subdevice streams into on the driver side (V4L2 backend). Takes effect on the next start. */
+        zero_copy_enabled                               , /**< Enable/disable passing the driver's buffers directly to the application for frames that need no unpacking, whatever the capture memory. Every held frame keeps a capture buffer busy. Nothing falls back: a subdevice without RS_CAPTURE_MEMORY_USERPTR support fails to start, and a RS_CAPTURE_MEMORY_DMABUF buffer the driver cannot export is passed through without RS_FRAME_METADATA_DMABUF_FD. Takes effect on the next start. */
+        capture_thread_per_subdevice                    , /**< Enable/disable a dedicated capture thread for each subdevice, so that processing one stream never delays dequeuing another (V4L2 backend). Takes effect on the next start. */
+        capture_thread_affinity                         , /**< First CPU the capture threads are pinned to, one CPU per thread, or -1 to leave them unpinned (V4L2 backend). Takes effect on the next start. */
+        capture_thread_priority                         , /**< SCHED_FIFO priority of the capture threads, or 0 for the default scheduler (V4L2 backend). Usually requires CAP_SYS_NICE. Takes effect on the next start. */
+        unpack_threads                                  , /**< Number of threads that unpack each frame in bands of rows, including the capture thread. 1 unpacks on the capture thread alone. Takes effect on the next start. */
+        lazy_unpack_enabled                             , /**< Enable/disable converting frames only when their data is first accessed, so that dropped frames are never unpacked. Until then every frame keeps a capture buffer busy. Applies to formats that unpack into a single stream. Takes effect on the next start. */
+        alignment_threads                               , /**< Number of threads that compute aligned streams, such as rs::stream::depth_aligned_to_color, including the thread reading the frame. Takes effect on the next start. */
+        incremental_alignment_enabled                   , /**< Enable/disable reprojecting only the blocks of the depth image that changed since the previous frame when computing aligned streams. Speeds up static scenes, the result is unchanged. Takes effect on the next start. */
+        compact_point_cloud_enabled                     , /**< Enable/disable writing only the points of pixels with depth to rs::stream::points, packed at the start of the frame in the order of their pixels. rs::device::get_point_count() returns how many there are. Takes effect on the next start. */
+        sync_queue_size                                 , /**< Number of frames each stream keeps queued while waiting to be matched into a frameset by rs::device::wait_for_frames(), beyond which the oldest is dropped. Takes effect on the next start. */
+        sync_policy                                     , /**< How rs::device::wait_for_frames() matches frames into framesets, see rs::sync_policy. Takes effect on the next start. */
+        sync_tolerance                                  , /**< Largest difference in milliseconds between the timestamps of matching frames under sync_policy::window and sync_policy::complete, or 0 for half the frame interval of the key stream. Takes effect on the next start. */
+        sync_max_latency                                , /**< Longest time in milliseconds a key stream frame waits for its matches in other streams under every policy but sync_policy::nearest, or 0 for one frame interval of the key stream. Takes effect on the next start. */
+        sync_framesets                                  , /**< Total number of framesets delivered by rs::device::wait_for_frames() and rs::device::poll_for_frames() */
+        sync_incomplete_framesets                       , /**< Total number of delivered framesets in which some stream had no frame matching the key stream frame, and kept its previous frame */
+        sync_dropped_frames                             , /**< Total number of key stream frames dropped by sync_policy::complete for lack of a match in every stream */
+        sync_average_latency                            , /**< Average time in milliseconds the key stream frame of each delivered frameset was queued */
+        frame_capacity_drops                            , /**< Total number of frames, framesets and frame references withheld from the user because the room reserved from frames_queue_size at start was exhausted */
+        bilinear_rectification_enabled                  , /**< Enable/disable interpolating stream::rectified_color between the four nearest color pixels instead of copying the nearest one. Smoother, but several times slower, especially without AVX2. Depth is always sampled at the nearest pixel. Takes effect on the next start. */
     };
 
     /// \brief Types of value provided from the device with each frame
     enum class frame_metadata
     {
         actual_exposure, /**< Actual exposure at which the frame was captured */
-        actual_fps       /**< Actual FPS at the time of capture */
+        actual_fps     , /**< Actual FPS at the time of capture */
+        dmabuf_fd        /**< DMABUF file descriptor of the capture buffer holding the frame, see capture_memory::dmabuf */
     };
 
     /// \brief Specifies various capabilities of a RealSense device.
@@ -395,6 +440,7 @@ namespace rs
         rs_frame_ref * frame_ref;
 
         frame(const frame &) = delete;
+        friend class device;
 
     public:
         frame() : device(nullptr), frame_ref(nullptr) {}
@@ -563,6 +609,26 @@ namespace rs
 
         void release() override { delete this; }
     };
+    class frame_allocator : public rs_frame_allocator
+    {
+        std::function<void *(size_t, size_t)> allocate_function;
+        std::function<void(void *, size_t)> deallocate_function;
+    public:
+        frame_allocator(std::function<void *(size_t, size_t)> allocate, std::function<void(void *, size_t)> deallocate) : allocate_function(allocate), deallocate_function(deallocate) {}
+
+        void * allocate(size_t size, size_t alignment) override
+        {
+            return allocate_function(size, alignment);
+        }
+
+        void deallocate(void * ptr, size_t size) override
+        {
+            deallocate_function(ptr, size);
+        }
+
+        void release() override { delete this; }
+    };
+
     /// \brief Provides convenience methods relating to devices
     class device
     {
@@ -821,6 +887,44 @@ namespace rs
             error::handle(e);
         }
 
+        /// \brief Sets a custom allocator for the buffers that receive unpacked frame data
+        ///
+        /// \c allocate must return at least \c size bytes aligned to \c alignment (currently 64) bytes. \c deallocate may be invoked from any thread that releases a frame.
+        /// Must be called before the device is started
+        /// \param[in] allocate    Routine that allocates a frame buffer of given size and alignment
+        /// \param[in] deallocate  Routine that frees a frame buffer previously returned by \c allocate
+        void set_frame_allocator(std::function<void *(size_t size, size_t alignment)> allocate, std::function<void(void * ptr, size_t size)> deallocate)
+        {
+            rs_error * e = nullptr;
+            rs_set_frame_allocator_cpp((rs_device *)this, new frame_allocator(allocate, deallocate), &e);
+            error::handle(e);
+        }
+
+        /// Sets the number of driver-side capture buffers and how they are allocated for a specific stream
+        ///
+        /// Must be called before the device is started
+        /// \param[in] stream  Native stream
+        /// \param[in] count   Number of buffers to request from the driver, or 0 to use option::capture_buffers_count
+        /// \param[in] memory  Capture memory model
+        void set_stream_capture_buffers(stream stream, int count, capture_memory memory = capture_memory::mmap)
+        {
+            rs_error * e = nullptr;
+            rs_set_stream_capture_buffers((rs_device *)this, (rs_stream)stream, count, (rs_capture_memory)memory, &e);
+            error::handle(e);
+        }
+
+        /// Sets the number of frames a specific stream keeps queued while waiting to be matched into a frameset, beyond which the oldest is dropped
+        ///
+        /// Must be called before the device is started
+        /// \param[in] stream  Native stream
+        /// \param[in] size    Number of frames to keep queued, or 0 to use option::sync_queue_size
+        void set_stream_sync_queue_size(stream stream, int size)
+        {
+            rs_error * e = nullptr;
+            rs_set_stream_sync_queue_size((rs_device *)this, (rs_stream)stream, size, &e);
+            error::handle(e);
+        }
+
         ///  \brief Sets callback for motion module event. 
 		/// 
 		///  The provided callback will be called the instant new motion or timestamp event is available. 
@@ -989,6 +1093,17 @@ namespace rs
             error::handle(e);
         }
 
+        /// \brief Blocks until new frames are available or the timeout expires
+        /// \param[in] timeout_ms  Longest time to wait, in milliseconds. 0 checks for new frames without blocking.
+        /// \return                true if new frames are available; false if the timeout expired first.
+        bool wait_for_frames(unsigned int timeout_ms)
+        {
+            rs_error * e = nullptr;
+            auto r = rs_wait_for_frames_timeout((rs_device *)this, timeout_ms, &e);
+            error::handle(e);
+            return r != 0;
+        }
+
         /// \brief Checks if new frames are available, without blocking
         /// \return  true if new frames are available; false if no new frames have arrived.
         bool poll_for_frames()
@@ -999,6 +1114,17 @@ namespace rs
             return r != 0;
         }
 
+        /// \brief Retrieves a file descriptor which is readable while new frames are available, to wait for frames with poll(), select() or epoll
+        /// The descriptor is owned by the device and stays valid across start and stop. Call poll_for_frames() when it becomes readable. Not supported on Windows.
+        /// \return  The file descriptor
+        int get_frames_ready_fd() const
+        {
+            rs_error * e = nullptr;
+            auto r = rs_get_frames_ready_fd((const rs_device *)this, &e);
+            error::handle(e);
+            return r;
+        }
+
         /// \brief Determines device capabilities
         /// \param[in] capability  Capability to check
         /// \return                true if device has this capability
@@ -1055,6 +1181,49 @@ namespace rs
             return r;
         }
 
+        /// \brief Retrieves the number of points in the latest frame of stream::points, which is every pixel unless option::compact_point_cloud_enabled is set
+        /// \return            Number of points
+        int get_point_count() const
+        {
+            rs_error * e = nullptr;
+            auto r = rs_get_point_count((const rs_device *)this, &e);
+            error::handle(e);
+            return r;
+        }
+
+        /// \brief Retrieves the index into the depth image of the pixel each point of the latest frame of stream::points was deprojected from
+        /// \return            Pointer to get_point_count() indices, valid until the next frame
+        const int * get_point_pixel_indices() const
+        {
+            rs_error * e = nullptr;
+            auto r = rs_get_point_pixel_indices((const rs_device *)this, &e);
+            error::handle(e);
+            return r;
+        }
+
+        /// \brief Retrieves where each point of the latest frame of stream::points lands in the image of stream::color, from 0 to 1
+        /// \return            Pointer to get_point_count() u, v pairs, valid until the next frame
+        const float * get_point_texture_coordinates() const
+        {
+            rs_error * e = nullptr;
+            auto r = rs_get_point_texture_coordinates((const rs_device *)this, &e);
+            error::handle(e);
+            return r;
+        }
+
+        /// \brief Computes a frame of a derived stream, such as stream::points, from frames received by a frame callback
+        /// \param[in] stream  Derived stream whose frame to compute
+        /// \param[in] source  Frame of the stream the derived stream is computed from
+        /// \param[in] other   Frame of the second stream the derived stream is computed from, if it has one
+        /// \return            New frame, with the frame number and timestamp of source
+        frame compute_frame(stream stream, const frame & source, const frame * other = nullptr)
+        {
+            rs_error * e = nullptr;
+            auto r = rs_compute_detached_frame((rs_device *)this, (rs_stream)stream, source.frame_ref, other ? other->frame_ref : nullptr, &e);
+            error::handle(e);
+            return frame((rs_device *)this, r);
+        }
+
         /// \brief Sends device-specific data to device
         /// \param[in] type  Type of raw data to send to the device
         /// \param[in] data  Raw data pointer to send
@@ -1075,6 +1244,8 @@ namespace rs
     inline std::ostream & operator << (std::ostream & o, capabilities capability) { return o << rs_capabilities_to_string((rs_capabilities)capability); }
     inline std::ostream & operator << (std::ostream & o, source src) { return o << rs_source_to_string((rs_source)src); }
     inline std::ostream & operator << (std::ostream & o, event evt) { return o << rs_event_to_string((rs_event_source)evt); }
+    inline std::ostream & operator << (std::ostream & o, capture_memory memory) { return o << rs_capture_memory_to_string((rs_capture_memory)memory); }
+    inline std::ostream & operator << (std::ostream & o, sync_policy policy) { return o << rs_sync_policy_to_string((rs_sync_policy)policy); }
 
     /// \brief Severity of the librealsense logger
     enum class log_severity : int32_t
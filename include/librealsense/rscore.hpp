@@ -65,6 +65,9 @@ struct rs_device
 {
     virtual                                 ~rs_device() {}
     virtual const rs_stream_interface &     get_stream_interface(rs_stream stream) const = 0;
+    virtual int                             get_point_count() const = 0;
+    virtual const int *                     get_point_pixel_indices() const = 0;
+    virtual const float *                   get_point_texture_coordinates() const = 0;
 
     virtual const char *                    get_name() const = 0;
     virtual const char *                    get_serial() const = 0;
@@ -87,6 +90,10 @@ struct rs_device
     virtual void                            set_motion_callback(rs_motion_callback * callback) = 0;
     virtual void                            set_timestamp_callback(void(*on_event)(rs_device * device, rs_timestamp_data data, void * user), void * user) = 0;
     virtual void                            set_timestamp_callback(rs_timestamp_callback * callback) = 0;
+    virtual void                            set_frame_allocator(rs_frame_alloc_ptr on_alloc, rs_frame_free_ptr on_free, void * user) = 0;
+    virtual void                            set_frame_allocator(rs_frame_allocator * allocator) = 0;
+    virtual void                            set_stream_capture_buffers(rs_stream stream, int count, rs_capture_memory memory) = 0;
+    virtual void                            set_stream_sync_queue_size(rs_stream stream, int size) = 0;
                                             
     virtual void                            start(rs_source source) = 0;
     virtual void                            stop(rs_source source) = 0;
@@ -98,7 +105,9 @@ struct rs_device
     virtual int                             is_motion_tracking_active() const = 0;
                                             
     virtual void                            wait_all_streams() = 0;
+    virtual bool                            wait_all_streams(unsigned int timeout_ms) = 0;
     virtual bool                            poll_all_streams() = 0;
+    virtual int                             get_frames_ready_fd() const = 0;
                                             
     virtual bool                            supports(rs_capabilities capability) const = 0;
     virtual bool                            supports(rs_camera_info info_param) const = 0;
@@ -111,6 +120,7 @@ struct rs_device
 
     virtual void                            release_frame(rs_frame_ref * ref) = 0;
     virtual rs_frame_ref *                  clone_frame(rs_frame_ref * frame) = 0;
+    virtual rs_frame_ref *                  compute_frame(rs_stream stream, const rs_frame_ref * frame, const rs_frame_ref * other) = 0;
 
     virtual const char *                    get_usb_port_id() const = 0;
 };
@@ -143,6 +153,14 @@ struct rs_timestamp_callback
     virtual                                 ~rs_timestamp_callback() {}
 };
 
+struct rs_frame_allocator
+{
+    virtual void *                          allocate(size_t size, size_t alignment) = 0;
+    virtual void                            deallocate(void * ptr, size_t size) = 0;
+    virtual void                            release() = 0;
+    virtual                                 ~rs_frame_allocator() {}
+};
+
 struct rs_log_callback
 {
     virtual void                            on_event(rs_log_severity severity, const char * message) = 0;
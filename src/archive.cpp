@@ -4,8 +4,130 @@
 
 using namespace rsimpl;
 
-frame_archive::frame_archive(const std::vector<subdevice_mode_selection>& selection, std::atomic<uint32_t>* in_max_frame_queue_size, std::chrono::high_resolution_clock::time_point capture_started)
-    : max_frame_queue_size(in_max_frame_queue_size), mutex(), capture_started(capture_started)
+frame_buffer::frame_buffer(size_t size, frame_allocator_ptr frame_allocator) : raw(nullptr), ptr(nullptr), length(size)
+{
+    if (frame_allocator)
+    {
+        raw = static_cast<byte *>(frame_allocator->allocate(size, RS_FRAME_BUFFER_ALIGNMENT));
+        if (raw && reinterpret_cast<uintptr_t>(raw) % RS_FRAME_BUFFER_ALIGNMENT == 0)
+        {
+            ptr = raw;
+            allocator = std::move(frame_allocator);
+            return;
+        }
+
+        LOG_ERROR("Frame allocator returned " << (raw ? "a misaligned" : "no") << " buffer, falling back to library memory");
+        if (raw) frame_allocator->deallocate(raw, size);
+    }
+
+    // Over-allocate so that the frame data can start on an aligned address
+    raw = new byte[size + RS_FRAME_BUFFER_ALIGNMENT];
+    auto offset = reinterpret_cast<uintptr_t>(raw) % RS_FRAME_BUFFER_ALIGNMENT;
+    ptr = raw + (offset ? RS_FRAME_BUFFER_ALIGNMENT - offset : 0);
+}
+
+frame_buffer & frame_buffer::operator=(frame_buffer && other)
+{
+    if (this != &other)
+    {
+        free();
+        raw = other.raw;
+        ptr = other.ptr;
+        length = other.length;
+        allocator = std::move(other.allocator);
+        other.raw = other.ptr = nullptr;
+        other.length = 0;
+    }
+    return *this;
+}
+
+void frame_buffer::free()
+{
+    if (!raw) return;
+    if (allocator) allocator->deallocate(raw, length);
+    else delete[] raw;
+    allocator.reset();
+    raw = ptr = nullptr;
+    length = 0;
+}
+
+frame_buffer_pool::frame_buffer_pool() : filled_slots(RS_FRAME_POOL_SIZE), free_slots(RS_FRAME_POOL_SIZE), buffer_size(0), counters(nullptr)
+{
+    for (uint32_t i = 0; i < RS_FRAME_POOL_SIZE; ++i) free_slots.push(i);
+}
+
+void frame_buffer_pool::reset(size_t size, int preallocated, frame_pool_counters * pool_counters, frame_allocator_ptr frame_allocator)
+{
+    buffer_size = size;
+    counters = pool_counters;
+    allocator = frame_allocator;
+    for (auto i = 0; i < preallocated && i < RS_FRAME_POOL_SIZE; ++i)
+    {
+        frame_buffer buffer(size, allocator);
+        push(buffer);
+    }
+}
+
+bool frame_buffer_pool::push(frame_buffer & buffer)
+{
+    uint32_t slot;
+    if (!free_slots.pop(slot)) return false; // pool is full
+    slots[slot] = std::move(buffer);
+    filled_slots.push(slot);
+    return true;
+}
+
+bool frame_buffer_pool::pop(frame_buffer & buffer)
+{
+    uint32_t slot;
+    if (!filled_slots.pop(slot)) return false; // pool is empty
+    buffer = std::move(slots[slot]);
+    free_slots.push(slot);
+    return true;
+}
+
+frame_buffer frame_buffer_pool::acquire()
+{
+    frame_buffer buffer;
+    if (pop(buffer))
+    {
+        if (counters) ++counters->hits;
+        return buffer;
+    }
+
+    if (counters) ++counters->misses;
+    return frame_buffer(buffer_size, allocator);
+}
+
+void frame_buffer_pool::release(frame_buffer & buffer)
+{
+    if (buffer.empty()) return; // frames which borrow the driver's buffer own no memory
+
+    // Buffers of a foreign size can never be served again, and a full pool has enough spares already
+    if (buffer.size() != buffer_size || !push(buffer))
+    {
+        if (counters) ++counters->evictions;
+    }
+}
+
+// Room for the frames the user may hold of every stream, chosen from RS_OPTION_FRAMES_QUEUE_SIZE when streaming starts
+static int get_published_capacity(uint32_t max_frame_queue_size)
+{
+    return std::max(1, std::min((int)max_frame_queue_size, RS_MAX_USER_QUEUE_SIZE)) * RS_STREAM_COUNT;
+}
+
+// Allocations that fail while the archive is not being flushed are due to the user holding on to every slot
+template<class T> static T * allocate_published(small_heap<T> & heap, frame_pool_counters * counters)
+{
+    auto item = heap.allocate();
+    if (!item && counters && heap.is_allocating()) ++counters->exhausted;
+    return item;
+}
+
+frame_archive::frame_archive(const std::vector<subdevice_mode_selection>& selection, std::atomic<uint32_t>* in_max_frame_queue_size, frame_pool_counters* pool_counters, frame_allocator_ptr allocator, std::chrono::high_resolution_clock::time_point capture_started)
+    : max_frame_queue_size(in_max_frame_queue_size),
+      published_frames(get_published_capacity(*in_max_frame_queue_size)), published_sets(get_published_capacity(*in_max_frame_queue_size)), detached_refs(get_published_capacity(*in_max_frame_queue_size)),
+      pool_counters(pool_counters), allocator(allocator), mutex(), capture_started(capture_started)
 {
     // Store the mode selection that pertains to each native stream
     for (auto & mode : selection)
@@ -16,15 +138,19 @@ frame_archive::frame_archive(const std::vector<subdevice_mode_selection>& select
         }
     }
 
+    for(auto & count : published_frames_per_stream) count = 0; // Derived streams publish frames too
+
     for(auto s : {RS_STREAM_DEPTH, RS_STREAM_INFRARED, RS_STREAM_INFRARED2, RS_STREAM_COLOR, RS_STREAM_FISHEYE})
     {
-        published_frames_per_stream[s] = 0;
+        // Frames of streams that are not unpacked borrow the driver's buffer, so only preallocate for those that are
+        if (is_stream_enabled(s))
+            pools[s].reset(modes[s].get_image_size(s), modes[s].requires_processing() ? RS_FRAME_POOL_PREALLOCATED : 0, pool_counters, allocator);
     }
 }
 
 frame_archive::frameset* frame_archive::clone_frameset(frameset* frameset)
 {
-    auto new_set = published_sets.allocate();
+    auto new_set = allocate_published(published_sets, pool_counters);
     if (new_set)
     {
         *new_set = *frameset;
@@ -32,22 +158,63 @@ frame_archive::frameset* frame_archive::clone_frameset(frameset* frameset)
     return new_set;
 }
 
+// Frames of derived streams are only computed on request, so their buffers are allocated on first use and recycled afterwards
+void frame_archive::reset_derived_pool(rs_stream stream, size_t size)
+{
+    pools[stream].reset(size, 0, pool_counters, allocator);
+}
+
+frame_archive::frame_ref* frame_archive::derive_frame(rs_stream stream, const frame_additional_data& additional_data, const std::function<void(byte *)>& compute)
+{
+    frame new_frame;
+    new_frame.update_owner(this);
+    new_frame.additional_data = additional_data;
+    new_frame.data = pools[stream].acquire();
+    try
+    {
+        compute(new_frame.data.data());
+    }
+    catch (...)
+    {
+        pools[stream].release(new_frame.data);
+        throw;
+    }
+
+    auto published_frame = publish_frame(std::move(new_frame));
+    if (!published_frame)
+    {
+        recycle_frame(new_frame);
+        return nullptr;
+    }
+    frame_ref new_ref(published_frame); // allocate new frame_ref to ref-counter the now published frame
+    return clone_frame(&new_ref);
+}
+
 void frame_archive::unpublish_frame(frame* frame)
 {
     if (frame)
     {
         log_frame_callback_end(frame);
-        std::lock_guard<std::recursive_mutex> lock(mutex);
 
-        if (is_valid(frame->get_stream_type()))
-            --published_frames_per_stream[frame->get_stream_type()];
+        auto stream = frame->get_stream_type();
+        if (is_valid(stream))
+        {
+            --published_frames_per_stream[stream];
+            pools[stream].release(frame->data);
+        }
 
-        freelist.push_back(std::move(*frame));
         published_frames.deallocate(frame);
-       
     }
 }
 
+// Return the buffer of a frame that will never be published, and hand any borrowed driver buffer back
+void frame_archive::recycle_frame(frame& frame)
+{
+    frame.complete_continuation();
+    auto stream = frame.get_stream_type();
+    if (is_valid(stream)) pools[stream].release(frame.data);
+}
+
 frame_archive::frame* frame_archive::publish_frame(frame&& frame)
 {
     if (is_valid(frame.get_stream_type()) &&
@@ -55,7 +222,7 @@ frame_archive::frame* frame_archive::publish_frame(frame&& frame)
     {
         return nullptr;
     }
-    auto new_frame = published_frames.allocate();
+    auto new_frame = allocate_published(published_frames, pool_counters);
     if (new_frame)
     {
         if (is_valid(frame.get_stream_type())) ++published_frames_per_stream[frame.get_stream_type()];
@@ -66,7 +233,7 @@ frame_archive::frame* frame_archive::publish_frame(frame&& frame)
 
 frame_archive::frame_ref* frame_archive::detach_frame_ref(frameset* frameset, rs_stream stream)
 {
-    auto new_ref = detached_refs.allocate();
+    auto new_ref = allocate_published(detached_refs, pool_counters);
     if (new_ref)
     {
         *new_ref = frameset->detach_ref(stream);
@@ -76,7 +243,7 @@ frame_archive::frame_ref* frame_archive::detach_frame_ref(frameset* frameset, rs
 
 frame_archive::frame_ref* frame_archive::clone_frame(frame_ref* frameset)
 {
-    auto new_ref = detached_refs.allocate();
+    auto new_ref = allocate_published(detached_refs, pool_counters);
     if (new_ref)
     {
         *new_ref = *frameset;
@@ -84,38 +251,14 @@ frame_archive::frame_ref* frame_archive::clone_frame(frame_ref* frameset)
     return new_ref;
 }
 
-// Allocate a new frame in the backbuffer, potentially recycling a buffer from the freelist
+// Allocate a new frame in the backbuffer, recycling a buffer from the stream's pool when one is available
 byte * frame_archive::alloc_frame(rs_stream stream, const frame_additional_data& additional_data, bool requires_memory)
 {
-    const size_t size = modes[stream].get_image_size(stream);
+    // The backbuffer still owns its buffer if the previous frame could not be published, in which case it is reused as is
+    if (requires_memory && backbuffer[stream].data.size() != modes[stream].get_image_size(stream))
     {
-        std::lock_guard<std::recursive_mutex> guard(mutex);
-
-        if (requires_memory)
-        {
-            // Attempt to obtain a buffer of the appropriate size from the freelist
-            for (auto it = begin(freelist); it != end(freelist); ++it)
-            {
-                if (it->data.size() == size)
-                {
-                    backbuffer[stream] = std::move(*it);
-                    freelist.erase(it);
-                    break;
-                }
-            }
-        }
-
-        // Discard buffers that have been in the freelist for longer than 1s
-        for (auto it = begin(freelist); it != end(freelist);)
-        {
-            if (additional_data.timestamp > it->additional_data.timestamp + 1000) it = freelist.erase(it);
-            else ++it;
-        }
-    }
-    
-    if (requires_memory)
-    {
-        backbuffer[stream].data.resize(size); // TODO: Allow users to provide a custom allocator for frame buffers
+        pools[stream].release(backbuffer[stream].data);
+        backbuffer[stream].data = pools[stream].acquire();
     }
     backbuffer[stream].update_owner(this);
     backbuffer[stream].additional_data = additional_data;
@@ -127,6 +270,13 @@ void frame_archive::attach_continuation(rs_stream stream, frame_continuation&& c
     backbuffer[stream].attach_continuation(std::move(continuation));
 }
 
+// Leave the native frame in the capture buffer held by the continuation, to be unpacked only if its data is ever accessed
+void frame_archive::defer_unpack(rs_stream stream, frame_continuation&& continuation)
+{
+    backbuffer[stream].attach_continuation(std::move(continuation));
+    backbuffer[stream].defer_unpack();
+}
+
 frame_archive::frame_ref* frame_archive::track_frame(rs_stream stream)
 {
     std::unique_lock<std::recursive_mutex> lock(mutex);
@@ -286,6 +436,9 @@ double frame_archive::frame::get_frame_metadata(rs_frame_metadata frame_metadata
         case RS_FRAME_METADATA_ACTUAL_FPS:
             return additional_data.actual_fps;
             break;
+        case RS_FRAME_METADATA_DMABUF_FD:
+            return additional_data.dmabuf_fd;
+            break;
         default:
             throw std::logic_error("unsupported metadata type");
             break;
@@ -294,12 +447,31 @@ double frame_archive::frame::get_frame_metadata(rs_frame_metadata frame_metadata
 
 bool frame_archive::frame::supports_frame_metadata(rs_frame_metadata frame_metadata) const
 {
+    if (frame_metadata == RS_FRAME_METADATA_DMABUF_FD) return additional_data.dmabuf_fd >= 0;
     for (auto & md : *additional_data.supported_metadata_vector) if (md == frame_metadata) return true;
     return false;
 }
 
+// Unpack a deferred frame into its own buffer and hand the capture buffer back. Concurrent readers sleep on the mutex until the first one is done.
+void frame_archive::frame::unpack_deferred() const
+{
+    std::lock_guard<std::mutex> lock(unpack_mutex);
+    if (unpack_state.load(std::memory_order_relaxed) == unpacked) return; // Unpacked by the reader that held the lock before us
+
+    // The capture buffer is gone if streaming stopped and disabled the continuation, leaving nothing to unpack
+    if (auto source = static_cast<const byte *>(on_release.get_data()))
+    {
+        byte * dest[] = { data.data() };
+        owner->get_mode(get_stream_type()).unpack(dest, source);
+        on_release();
+    }
+    unpack_state.store(unpacked, std::memory_order_release);
+}
+
 const byte* frame_archive::frame::get_frame_data() const
 {
+    if (unpack_state.load(std::memory_order_acquire) != unpacked) unpack_deferred();
+
 	const byte* frame_data = data.data();;
 
     if (on_release.get_data())
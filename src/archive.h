@@ -11,6 +11,55 @@
 
 namespace rsimpl
 {
+    // Movable, noncopyable block of RS_FRAME_BUFFER_ALIGNMENT-aligned memory holding frame data.
+    // The memory comes from the user-provided allocator when one is set, and from the heap otherwise.
+    class frame_buffer
+    {
+        byte * raw;         // start of the block as returned by the allocator
+        byte * ptr;         // aligned start of the frame data
+        size_t length;
+        frame_allocator_ptr allocator;
+
+        void free();
+    public:
+        frame_buffer() : raw(nullptr), ptr(nullptr), length(0) {}
+        frame_buffer(size_t size, frame_allocator_ptr allocator);
+        frame_buffer(const frame_buffer &) = delete;
+        frame_buffer(frame_buffer && other) : raw(other.raw), ptr(other.ptr), length(other.length), allocator(std::move(other.allocator)) { other.raw = other.ptr = nullptr; other.length = 0; }
+        ~frame_buffer() { free(); }
+
+        frame_buffer & operator=(const frame_buffer &) = delete;
+        frame_buffer & operator=(frame_buffer && other);
+
+        byte * data() { return ptr; }
+        const byte * data() const { return ptr; }
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+    };
+
+    // Fixed-capacity, lock-free pool of equally sized frame buffers.
+    // Buffers are acquired by the frame callback thread and returned by whichever thread drops the last reference to a frame.
+    class frame_buffer_pool
+    {
+        frame_buffer slots[RS_FRAME_POOL_SIZE];
+        index_stack filled_slots; // slots holding an idle buffer
+        index_stack free_slots;   // slots available to receive a released buffer
+        size_t buffer_size;
+        frame_pool_counters * counters;
+        frame_allocator_ptr allocator;
+
+        bool push(frame_buffer & buffer);
+        bool pop(frame_buffer & buffer);
+    public:
+        frame_buffer_pool();
+
+        // Not thread safe, must be called before the pool is shared between threads
+        void reset(size_t size, int preallocated, frame_pool_counters * counters, frame_allocator_ptr allocator);
+
+        frame_buffer acquire();
+        void release(frame_buffer & buffer);
+    };
+
     // Defines general frames storage model
     class frame_archive
     {
@@ -32,6 +81,7 @@ namespace rsimpl
             rs_stream stream_type = RS_STREAM_COUNT;
             rs_timestamp_domain timestamp_domain = RS_TIMESTAMP_DOMAIN_CAMERA;
             int pad = 0;
+            int dmabuf_fd = -1;
             std::shared_ptr<std::vector<rs_frame_metadata>> supported_metadata_vector;
             std::chrono::high_resolution_clock::time_point frame_callback_started {};
 
@@ -63,19 +113,25 @@ namespace rsimpl
         {
         private:
             // TODO: check boost::intrusive_ptr or an alternative
+            enum { unpacked, unpack_pending };
+
             std::atomic<int> ref_count; // the reference count is on how many times this placeholder has been observed (not lifetime, not content)
             frame_archive * owner; // pointer to the owner to be returned to by last observe
-            frame_continuation on_release;
+            mutable frame_continuation on_release; // Released by the first read of a deferred frame
+            mutable std::atomic<int> unpack_state; // unpack_pending while the native frame waits in the capture buffer held by on_release
+            mutable std::mutex unpack_mutex; // Held by the reader unpacking a deferred frame, concurrent readers block on it
+
+            void unpack_deferred() const;
 
         public:
-            std::vector<byte> data;
+            mutable frame_buffer data; // Filled in by the first read of a deferred frame, the data the frame logically held all along
             frame_additional_data additional_data;
 
-            explicit frame() : ref_count(0), owner(nullptr), on_release(){}
+            explicit frame() : ref_count(0), owner(nullptr), on_release(), unpack_state(unpacked){}
             frame(const frame & r) = delete;
             frame(frame && r) 
                 : ref_count(r.ref_count.exchange(0)), 
-                  owner(r.owner), on_release() 
+                  owner(r.owner), on_release(), unpack_state(unpacked)
             {
                 *this = std::move(r); // TODO: This is not very safe, refactor later
             }
@@ -83,10 +139,11 @@ namespace rsimpl
             frame & operator=(const frame & r) = delete;
             frame& operator=(frame&& r)
             {
-                data = move(r.data);
+                data = std::move(r.data);
                 owner = r.owner;
                 ref_count = r.ref_count.exchange(0);
                 on_release = std::move(r.on_release);
+                unpack_state = r.unpack_state.exchange(unpacked);
                 additional_data = std::move(r.additional_data);
                 return *this;
             }
@@ -118,7 +175,9 @@ namespace rsimpl
             frame* publish();
             void update_owner(frame_archive * new_owner) { owner = new_owner; }
             void attach_continuation(frame_continuation&& continuation) { on_release = std::move(continuation); }
+            void defer_unpack() { unpack_state = unpack_pending; }
             void disable_continuation() { on_release.reset(); }
+            void complete_continuation() { on_release(); }
         };
 
         class frame_ref : public rs_frame_ref // esentially an intrusive shared_ptr<frame>
@@ -163,6 +222,11 @@ namespace rsimpl
                 if (frame_ptr) frame_ptr->disable_continuation();
             }
 
+            frame_additional_data get_additional_data() const
+            {
+                return frame_ptr ? frame_ptr->additional_data : frame_additional_data();
+            }
+
             double get_frame_metadata(rs_frame_metadata frame_metadata) const override;
             bool supports_frame_metadata(rs_frame_metadata frame_metadata) const override;
             const byte* get_frame_data() const override;
@@ -214,19 +278,20 @@ namespace rsimpl
         
         std::atomic<uint32_t>* max_frame_queue_size;
         std::atomic<uint32_t> published_frames_per_stream[RS_STREAM_COUNT];
-        small_heap<frame, RS_USER_QUEUE_SIZE*RS_STREAM_COUNT> published_frames;
-        small_heap<frameset, RS_USER_QUEUE_SIZE*RS_STREAM_COUNT> published_sets;
-        small_heap<frame_ref, RS_USER_QUEUE_SIZE*RS_STREAM_COUNT> detached_refs;
-        
+        small_heap<frame> published_frames;
+        small_heap<frameset> published_sets;
+        small_heap<frame_ref> detached_refs;
+        frame_buffer_pool pools[RS_STREAM_COUNT]; // recycled frame buffers, one bucket per stream sized to its mode
+        frame_pool_counters * pool_counters;
+        frame_allocator_ptr allocator;
 
     protected:
         frame backbuffer[RS_STREAM_NATIVE_COUNT]; // receive frame here
-        std::vector<frame> freelist; // return frames here
         std::recursive_mutex mutex;
         std::chrono::high_resolution_clock::time_point capture_started;
 
     public:
-        frame_archive(const std::vector<subdevice_mode_selection> & selection, std::atomic<uint32_t>* max_frame_queue_size, std::chrono::high_resolution_clock::time_point capture_started = std::chrono::high_resolution_clock::now());
+        frame_archive(const std::vector<subdevice_mode_selection> & selection, std::atomic<uint32_t>* max_frame_queue_size, frame_pool_counters* pool_counters, frame_allocator_ptr allocator, std::chrono::high_resolution_clock::time_point capture_started = std::chrono::high_resolution_clock::now());
 
         // Safe to call from any thread
         bool is_stream_enabled(rs_stream stream) const { return modes[stream].mode.pf.fourcc != 0; }
@@ -238,8 +303,15 @@ namespace rsimpl
         }
         frameset * clone_frameset(frameset * frameset);
 
+        // Not thread safe, must be called before frames of derived streams are computed
+        void reset_derived_pool(rs_stream stream, size_t size);
+
+        // Computes a frame of a derived stream into a buffer from its pool, and publishes it
+        frame_ref * derive_frame(rs_stream stream, const frame_additional_data & additional_data, const std::function<void(byte *)> & compute);
+
         void unpublish_frame(frame * frame);
         frame * publish_frame(frame && frame);
+        void recycle_frame(frame & frame);
 
         frame_ref * detach_frame_ref(frameset * frameset, rs_stream stream);
         frame_ref * clone_frame(frame_ref * frameset);
@@ -252,6 +324,7 @@ namespace rsimpl
         byte * alloc_frame(rs_stream stream, const frame_additional_data& additional_data, bool requires_memory);
         frame_ref * track_frame(rs_stream stream);
         void attach_continuation(rs_stream stream, frame_continuation&& continuation);
+        void defer_unpack(rs_stream stream, frame_continuation&& continuation);
         void log_frame_callback_end(frame* frame);
         void log_callback_start(frame_ref* frame_ref, std::chrono::high_resolution_clock::time_point capture_start_time);
 
@@ -20,9 +20,10 @@ const int NUMBER_OF_FRAMES_TO_SAMPLE = 5;
 
 rs_device_base::rs_device_base(std::shared_ptr<rsimpl::uvc::device> device, const rsimpl::static_device_info & info, calibration_validator validator) : device(device), config(info),
     depth(config, RS_STREAM_DEPTH, validator), color(config, RS_STREAM_COLOR, validator), infrared(config, RS_STREAM_INFRARED, validator), infrared2(config, RS_STREAM_INFRARED2, validator), fisheye(config, RS_STREAM_FISHEYE, validator),
-    points(depth), rect_color(color), color_to_depth(color, depth), depth_to_color(depth, color), depth_to_rect_color(depth, rect_color), infrared2_to_depth(infrared2,depth), depth_to_infrared2(depth,infrared2),
+    points(depth, color), colored_points(depth, color), rect_color(color), color_to_depth(color, depth), depth_to_color(depth, color), depth_to_rect_color(depth, rect_color), infrared2_to_depth(infrared2,depth), depth_to_infrared2(depth,infrared2),
     capturing(false), data_acquisition_active(false), max_publish_list_size(RS_USER_QUEUE_SIZE), event_queue_size(RS_MAX_EVENT_QUEUE_SIZE), events_timeout(RS_MAX_EVENT_TIME_OUT),
-    usb_port_id(""), motion_module_ready(false), keep_fw_logger_alive(false), frames_drops_counter(0)
+    capture_buffers_count(RS_DEFAULT_CAPTURE_BUFFERS), zero_copy_enabled(false), capture_thread_per_subdevice(false), capture_thread_affinity(-1), capture_thread_priority(0), unpack_threads(1), lazy_unpack_enabled(false), alignment_threads(1), incremental_alignment_enabled(false), compact_point_cloud_enabled(false), bilinear_rectification_enabled(false), sync_queue_size(RS_DEFAULT_SYNC_QUEUE_SIZE), sync_policy(RS_SYNC_POLICY_NEAREST), sync_tolerance(0), sync_max_latency(0),
+    frames_ready(std::make_shared<frameset_event>()), usb_port_id(""), motion_module_ready(false), keep_fw_logger_alive(false), frames_drops_counter(0)
 {
     streams[RS_STREAM_DEPTH    ] = native_streams[RS_STREAM_DEPTH]     = &depth;
     streams[RS_STREAM_COLOR    ] = native_streams[RS_STREAM_COLOR]     = &color;
@@ -36,6 +37,7 @@ rs_device_base::rs_device_base(std::shared_ptr<rsimpl::uvc::device> device, cons
     streams[RS_STREAM_DEPTH_ALIGNED_TO_RECTIFIED_COLOR]                = &depth_to_rect_color;
     streams[RS_STREAM_INFRARED2_ALIGNED_TO_DEPTH]                      = &infrared2_to_depth;
     streams[RS_STREAM_DEPTH_ALIGNED_TO_INFRARED2]                      = &depth_to_infrared2;
+    streams[RS_STREAM_COLORED_POINTS]                                  = &colored_points;
 }
 
 rs_device_base::~rs_device_base()
@@ -70,6 +72,14 @@ const char* rs_device_base::get_camera_info(rs_camera_info info) const
 void rs_device_base::enable_stream(rs_stream stream, int width, int height, rs_format format, int fps, rs_output_buffer_format output)
 {
     if(capturing) throw std::runtime_error("streams cannot be reconfigured after having called rs_start_device()");
+    if(stream == RS_STREAM_POINTS)
+    {
+        // The point cloud follows the depth stream, so only its format can be chosen
+        if(format == RS_FORMAT_ANY) format = RS_FORMAT_XYZ32F;
+        if(format != RS_FORMAT_XYZ32F && format != RS_FORMAT_XYZ16F && format != RS_FORMAT_XYZ16) throw std::runtime_error(to_string() << "unsupported point cloud format: " << format);
+        points.set_format(format);
+        return;
+    }
     if(config.info.stream_subdevices[stream] == -1) throw std::runtime_error("unsupported stream");
 
     config.requests[stream] = { true, width, height, format, fps, output };
@@ -115,6 +125,38 @@ void rs_device_base::set_stream_callback(rs_stream stream, rs_frame_callback* ca
     config.callbacks[stream] = frame_callback_ptr(callback);
 }
 
+void rs_device_base::set_frame_allocator(rs_frame_alloc_ptr on_alloc, rs_frame_free_ptr on_free, void * user)
+{
+    set_frame_allocator(new frame_allocator(this, on_alloc, on_free, user));
+}
+
+void rs_device_base::set_frame_allocator(rs_frame_allocator * allocator)
+{
+    if (capturing)
+    {
+        allocator->release();
+        throw std::runtime_error("cannot set frame allocator while streaming");
+    }
+
+    // Buffers handed out by the previous allocator keep it alive until they are freed
+    config.allocator = frame_allocator_ptr(allocator, [](rs_frame_allocator * a) { a->release(); });
+}
+
+void rs_device_base::set_stream_capture_buffers(rs_stream stream, int count, rs_capture_memory memory)
+{
+    if (capturing) throw std::runtime_error("cannot set capture buffers while streaming");
+
+    config.capture_requests[stream].buffer_count = count;
+    config.capture_requests[stream].memory = memory;
+}
+
+void rs_device_base::set_stream_sync_queue_size(rs_stream stream, int size)
+{
+    if (capturing) throw std::runtime_error("cannot set sync queue size while streaming");
+
+    config.capture_requests[stream].sync_queue_size = size;
+}
+
 void rs_device_base::enable_motion_tracking()
 {
     if (data_acquisition_active) throw std::runtime_error("motion-tracking cannot be reconfigured after having called rs_start_device()");
@@ -329,12 +371,33 @@ void rs_device_base::start_video_streaming()
 
     auto capture_start_time = std::chrono::high_resolution_clock::now();
     auto selected_modes = config.select_modes();
-    auto archive = std::make_shared<syncronizing_archive>(selected_modes, select_key_stream(selected_modes), &max_publish_list_size, &event_queue_size, &events_timeout, capture_start_time);
+    for (auto & mode_selection : selected_modes) mode_selection.zero_copy = zero_copy_enabled;
+    int queue_sizes[RS_STREAM_NATIVE_COUNT];
+    for (int i = 0; i < RS_STREAM_NATIVE_COUNT; ++i) queue_sizes[i] = config.capture_requests[i].sync_queue_size ? config.capture_requests[i].sync_queue_size : static_cast<int>(sync_queue_size);
+    sync_settings sync;
+    sync.policy = static_cast<rs_sync_policy>(sync_policy.load());
+    sync.tolerance = sync_tolerance;
+    sync.max_latency = sync_max_latency;
+    auto archive = std::make_shared<syncronizing_archive>(selected_modes, select_key_stream(selected_modes), queue_sizes, sync, &sync_counters, frames_ready.get(), &max_publish_list_size, &event_queue_size, &events_timeout, &frame_pool_counters, config.allocator, capture_start_time);
 
     for(auto & s : native_streams) s->archive.reset(); // Starting capture invalidates the current stream info, if any exists from previous capture
 
     auto timestamp_readers = create_frame_timestamp_readers();
 
+    // All subdevices share one pool, a frame which arrives while it is busy is unpacked on its capture thread alone
+    unpack_pool.reset(unpack_threads > 1 ? new worker_pool(unpack_threads) : nullptr);
+    auto pool = unpack_pool.get();
+
+    // Aligned streams are computed by whoever reads them, and share a pool of their own
+    auto align_pool = alignment_threads > 1 ? std::make_shared<worker_pool>(alignment_threads) : nullptr;
+    for(auto s : {&color_to_depth, &depth_to_color, &depth_to_rect_color, &infrared2_to_depth, &depth_to_infrared2})
+    {
+        s->set_pool(align_pool);
+        s->set_incremental(incremental_alignment_enabled);
+    }
+    points.set_compact(compact_point_cloud_enabled);
+    rect_color.set_bilinear(bilinear_rectification_enabled);
+
     // Satisfy stream_requests as necessary for each subdevice, calling set_mode and
     // dispatching the uvc configuration for a requested stream to the hardware
     for(auto mode_selection : selected_modes)
@@ -360,9 +423,24 @@ void rs_device_base::start_video_streaming()
 
         auto actual_fps_calc = std::make_shared<fps_calc>(NUMBER_OF_FRAMES_TO_SAMPLE, mode_selection.get_framerate());
         std::shared_ptr<drops_status> frame_drops_status(new drops_status{});
+        // Streams sharing a subdevice share its capture buffers, so merge their capture requests
+        int buffer_count = 0;
+        auto capture_memory = RS_CAPTURE_MEMORY_MMAP;
+        for (auto & output : mode_selection.get_outputs())
+        {
+            auto & req = config.capture_requests[output.first];
+            buffer_count = std::max(buffer_count, req.buffer_count ? req.buffer_count : static_cast<int>(capture_buffers_count));
+            if (capture_memory == RS_CAPTURE_MEMORY_MMAP) capture_memory = req.memory;
+        }
+        auto export_dmabuf = capture_memory == RS_CAPTURE_MEMORY_DMABUF;
+
+        // A deferred unpack fills in a single frame, unpackers that split the native frame into several streams always run eagerly
+        auto lazy_unpack = lazy_unpack_enabled && streams.size() == 1;
+
         // Initialize the subdevice and set it to the selected mode
+        set_subdevice_buffers(*device, mode_selection.mode.subdevice, buffer_count, capture_memory);
         set_subdevice_mode(*device, mode_selection.mode.subdevice, mode_selection.mode.native_dims.x, mode_selection.mode.native_dims.y, mode_selection.mode.pf.fourcc, mode_selection.mode.fps, 
-            [this, mode_selection, archive, timestamp_reader, streams, capture_start_time, frame_drops_status, actual_fps_calc, supported_metadata_vector](const void * frame, std::function<void()> continuation) mutable
+            [this, mode_selection, archive, timestamp_reader, streams, capture_start_time, frame_drops_status, actual_fps_calc, supported_metadata_vector, export_dmabuf, pool, lazy_unpack](const void * frame, std::function<void()> continuation) mutable
         {
             auto now = std::chrono::system_clock::now();
             auto sys_time = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
@@ -381,6 +459,9 @@ void rs_device_base::start_video_streaming()
 
             auto requires_processing = mode_selection.requires_processing();
 
+            // Only frames that are handed out in place can be identified by their capture buffer
+            auto dmabuf_fd = export_dmabuf && !requires_processing ? get_dmabuf_fd(*device, mode_selection.mode.subdevice, frame) : -1;
+
             double exposure_value[1] = {};
             if (streams[0] == rs_stream::RS_STREAM_FISHEYE)
             {
@@ -436,6 +517,7 @@ void rs_device_base::start_video_streaming()
                     supported_metadata_vector,
                     exposure_value[0],
                     actual_fps);
+                additional_data.dmabuf_fd = dmabuf_fd;
 
                 // Obtain buffers for unpacking the frame
                 dest.push_back(archive->alloc_frame(output.first, additional_data, requires_processing));
@@ -446,10 +528,11 @@ void rs_device_base::start_video_streaming()
                     archive->correct_timestamp(output.first);
                 }
             }
-            // Unpack the frame
+            // Unpack the frame, or leave that to whoever first reads its data
             if (requires_processing)
             {
-                mode_selection.unpack(dest.data(), reinterpret_cast<const byte *>(frame));
+                if (lazy_unpack) archive->defer_unpack(streams[0], std::move(release_and_enqueue));
+                else mode_selection.unpack(dest.data(), reinterpret_cast<const byte *>(frame), pool);
             }
 
             // If any frame callbacks were specified, dispatch them now
@@ -480,8 +563,20 @@ void rs_device_base::start_video_streaming()
         });
     }
     
+    // Frames of derived streams computed from detached frames are recycled through pools of their own
+    for(int i = RS_STREAM_NATIVE_COUNT; i < RS_STREAM_COUNT; ++i)
+    {
+        auto & s = *streams[i];
+        try
+        {
+            if(s.is_enabled()) archive->reset_derived_pool((rs_stream)i, get_image_size(s.get_intrinsics().width, s.get_intrinsics().height, s.get_format()));
+        }
+        catch(const std::exception &) {} // Streams without valid calibration cannot be derived, and compute_frame() reports why
+    }
+
     this->archive = archive;
     on_before_start(selected_modes);
+    set_capture_threads(*device, capture_thread_per_subdevice, capture_thread_affinity, capture_thread_priority);
     start_streaming(*device, config.info.num_libuvc_transfer_buffers);
     capture_started = std::chrono::high_resolution_clock::now();
     capturing = true;
@@ -491,6 +586,8 @@ void rs_device_base::stop_video_streaming()
 {
     if(!capturing) throw std::runtime_error("cannot stop device without first starting device");
     stop_streaming(*device);
+    unpack_pool.reset();
+    for(auto s : {&color_to_depth, &depth_to_color, &depth_to_rect_color, &infrared2_to_depth, &depth_to_infrared2}) s->set_pool(nullptr);
     archive->flush();
     capturing = false;
 }
@@ -503,6 +600,13 @@ void rs_device_base::wait_all_streams()
     archive->wait_for_frames();
 }
 
+bool rs_device_base::wait_all_streams(unsigned int timeout_ms)
+{
+    if(!capturing) return false;
+    if(!archive) return false;
+    return archive->wait_for_frames(std::chrono::milliseconds(timeout_ms));
+}
+
 bool rs_device_base::poll_all_streams()
 {
     if(!capturing) return false;
@@ -510,6 +614,11 @@ bool rs_device_base::poll_all_streams()
     return archive->poll_for_frames();
 }
 
+int rs_device_base::get_frames_ready_fd() const
+{
+    return frames_ready->get_fd();
+}
+
 void rs_device_base::release_frame(rs_frame_ref* ref)
 {
     archive->release_frame_ref((frame_archive::frame_ref *)ref);
@@ -522,9 +631,47 @@ rs_frame_ref* ::rs_device_base::clone_frame(rs_frame_ref* frame)
     return result;
 }
 
+rs_frame_ref * rs_device_base::compute_frame(rs_stream stream, const rs_frame_ref * frame, const rs_frame_ref * other)
+{
+    if(!capturing || !archive) throw std::runtime_error("streaming not started!");
+    auto & s = *streams[stream];
+    if(!s.is_enabled()) throw std::runtime_error(to_string() << "stream not enabled: " << stream);
+
+    // The derived frame is a tightly packed image, with the timing and metadata of the frame it was computed from
+    auto intrin = s.get_intrinsics();
+    auto additional_data = static_cast<const frame_archive::frame_ref *>(frame)->get_additional_data();
+    additional_data.width = additional_data.stride_x = intrin.width;
+    additional_data.height = additional_data.stride_y = intrin.height;
+    additional_data.bpp = s.get_frame_bpp();
+    additional_data.format = s.get_format();
+    additional_data.stream_type = stream;
+    additional_data.pad = 0;
+    additional_data.dmabuf_fd = -1;
+    additional_data.frame_callback_started = std::chrono::high_resolution_clock::now();
+
+    auto result = archive->derive_frame(stream, additional_data, [&](byte * dest) { s.compute_frame(dest, frame, other); });
+    if (!result) throw std::runtime_error("Not enough resources to compute frame!");
+    return result;
+}
+
 void rs_device_base::update_device_info(rsimpl::static_device_info& info)
 {
-    info.options.push_back({ RS_OPTION_FRAMES_QUEUE_SIZE,     1, RS_USER_QUEUE_SIZE,      1, RS_USER_QUEUE_SIZE });
+    info.options.push_back({ RS_OPTION_FRAMES_QUEUE_SIZE,     1, RS_MAX_USER_QUEUE_SIZE,  1, RS_USER_QUEUE_SIZE });
+    info.options.push_back({ RS_OPTION_CAPTURE_BUFFERS_COUNT, 2, RS_MAX_CAPTURE_BUFFERS,  1, RS_DEFAULT_CAPTURE_BUFFERS });
+    info.options.push_back({ RS_OPTION_ZERO_COPY_ENABLED,     0, 1,                       1, 0 });
+    info.options.push_back({ RS_OPTION_CAPTURE_THREAD_PER_SUBDEVICE, 0, 1,                1, 0 });
+    info.options.push_back({ RS_OPTION_CAPTURE_THREAD_AFFINITY,     -1, std::max(1u, std::thread::hardware_concurrency()) - 1.0, 1, -1 });
+    info.options.push_back({ RS_OPTION_CAPTURE_THREAD_PRIORITY,      0, 99,               1, 0 });
+    info.options.push_back({ RS_OPTION_UNPACK_THREADS,               1, (double)std::max(1u, std::thread::hardware_concurrency()), 1, 1 });
+    info.options.push_back({ RS_OPTION_LAZY_UNPACK_ENABLED,          0, 1,                1, 0 });
+    info.options.push_back({ RS_OPTION_ALIGNMENT_THREADS,            1, (double)std::max(1u, std::thread::hardware_concurrency()), 1, 1 });
+    info.options.push_back({ RS_OPTION_INCREMENTAL_ALIGNMENT_ENABLED, 0, 1,               1, 0 });
+    info.options.push_back({ RS_OPTION_COMPACT_POINT_CLOUD_ENABLED,  0, 1,                1, 0 });
+    info.options.push_back({ RS_OPTION_BILINEAR_RECTIFICATION_ENABLED, 0, 1,              1, 0 });
+    info.options.push_back({ RS_OPTION_SYNC_QUEUE_SIZE,              1, RS_MAX_SYNC_QUEUE_SIZE, 1, RS_DEFAULT_SYNC_QUEUE_SIZE });
+    info.options.push_back({ RS_OPTION_SYNC_POLICY,                  0, RS_SYNC_POLICY_COUNT - 1, 1, RS_SYNC_POLICY_NEAREST });
+    info.options.push_back({ RS_OPTION_SYNC_TOLERANCE,               0, 1000,             0.1, 0 });
+    info.options.push_back({ RS_OPTION_SYNC_MAX_LATENCY,             0, 1000,             0.1, 0 });
 }
 
 const char * rs_device_base::get_option_description(rs_option option) const
@@ -591,7 +738,7 @@ const char * rs_device_base::get_option_description(rs_option option) const
     case RS_OPTION_FISHEYE_GAIN                                    : return "Fisheye image gain";
     case RS_OPTION_FISHEYE_STROBE                                  : return "Enables / disables fisheye strobe. When enabled this will align timestamps to common clock-domain with the motion events";
     case RS_OPTION_FISHEYE_EXTERNAL_TRIGGER                        : return "Enables / disables fisheye external trigger mode. When enabled fisheye image will be acquired in-sync with the depth image";
-    case RS_OPTION_FRAMES_QUEUE_SIZE                               : return "Number of frames the user is allowed to keep per stream. Trying to hold-on to more frames will cause frame-drops.";
+    case RS_OPTION_FRAMES_QUEUE_SIZE                               : return "Number of frames the user is allowed to keep per stream. Trying to hold-on to more frames will cause frame-drops. Room for this many frames of every stream is reserved on start.";
     case RS_OPTION_FISHEYE_ENABLE_AUTO_EXPOSURE                    : return "Enable / disable fisheye auto-exposure";
     case RS_OPTION_FISHEYE_AUTO_EXPOSURE_MODE                      : return "0 - static auto-exposure, 1 - anti-flicker auto-exposure, 2 - hybrid";
     case RS_OPTION_FISHEYE_AUTO_EXPOSURE_ANTIFLICKER_RATE          : return "Fisheye auto-exposure anti-flicker rate, can be 50 or 60 Hz";
@@ -599,6 +746,29 @@ const char * rs_device_base::get_option_description(rs_option option) const
     case RS_OPTION_FISHEYE_AUTO_EXPOSURE_SKIP_FRAMES               : return "In Fisheye auto-exposure sample every given number of frames";
     case RS_OPTION_HARDWARE_LOGGER_ENABLED                         : return "Enables / disables fetching diagnostic information from hardware (and writting the results to log)";
     case RS_OPTION_TOTAL_FRAME_DROPS                               : return "Total number of detected frame drops from all streams";
+    case RS_OPTION_FRAME_POOL_HITS                                 : return "Total number of frame buffers reused from the frame pool";
+    case RS_OPTION_FRAME_POOL_MISSES                               : return "Total number of frame buffers allocated because the frame pool was empty";
+    case RS_OPTION_FRAME_POOL_EVICTIONS                            : return "Total number of released frame buffers freed because the frame pool was full";
+    case RS_OPTION_CAPTURE_BUFFERS_COUNT                           : return "Number of buffers each subdevice streams into on the driver side (V4L2 backend). Takes effect on the next start";
+    case RS_OPTION_ZERO_COPY_ENABLED                               : return "Enable/disable passing the driver's buffers directly to the application for frames that need no unpacking, whatever the capture memory. Every held frame keeps a capture buffer busy. Nothing falls back: a subdevice without RS_CAPTURE_MEMORY_USERPTR support fails to start, and a RS_CAPTURE_MEMORY_DMABUF buffer the driver cannot export is passed through without RS_FRAME_METADATA_DMABUF_FD. Takes effect on the next start";
+    case RS_OPTION_CAPTURE_THREAD_PER_SUBDEVICE                    : return "Service each subdevice from its own capture thread (V4L2 backend). Takes effect on the next start";
+    case RS_OPTION_CAPTURE_THREAD_AFFINITY                         : return "First CPU to pin capture threads to, one CPU per thread, -1 to leave them unpinned (V4L2 backend). Takes effect on the next start";
+    case RS_OPTION_CAPTURE_THREAD_PRIORITY                         : return "SCHED_FIFO priority of the capture threads, 0 for the default scheduler (V4L2 backend). Takes effect on the next start";
+    case RS_OPTION_UNPACK_THREADS                                  : return "Number of threads unpacking each frame in bands of rows, 1 to unpack on the capture thread alone. Takes effect on the next start";
+    case RS_OPTION_LAZY_UNPACK_ENABLED                             : return "Unpack frames only when their data is first accessed. Until then every frame keeps a capture buffer busy. Takes effect on the next start";
+    case RS_OPTION_ALIGNMENT_THREADS                               : return "Number of threads computing aligned streams, including the thread reading the frame. Takes effect on the next start";
+    case RS_OPTION_INCREMENTAL_ALIGNMENT_ENABLED                   : return "Reproject only the blocks of the depth image that changed since the previous frame when aligning. Takes effect on the next start";
+    case RS_OPTION_COMPACT_POINT_CLOUD_ENABLED                     : return "Write only the points of pixels with depth to the point cloud, packed at its start. Takes effect on the next start";
+    case RS_OPTION_BILINEAR_RECTIFICATION_ENABLED                  : return "Interpolate the rectified color stream between the four nearest pixels instead of copying the nearest one, at several times the cost. Takes effect on the next start";
+    case RS_OPTION_SYNC_QUEUE_SIZE                                 : return "Number of frames each stream keeps queued to be matched into framesets, beyond which the oldest is dropped. Takes effect on the next start";
+    case RS_OPTION_SYNC_POLICY                                     : return "How frames are matched into framesets: 0 nearest in time, 1 same frame number, 2 within the tolerance, 3 within the tolerance in every stream or dropped. Takes effect on the next start";
+    case RS_OPTION_SYNC_TOLERANCE                                  : return "Largest timestamp difference in milliseconds between matching frames, 0 for half a frame interval. Takes effect on the next start";
+    case RS_OPTION_SYNC_MAX_LATENCY                                : return "Longest time in milliseconds a frame waits for its matches in other streams, 0 for one frame interval. Takes effect on the next start";
+    case RS_OPTION_SYNC_FRAMESETS                                  : return "Total number of framesets delivered";
+    case RS_OPTION_SYNC_INCOMPLETE_FRAMESETS                       : return "Total number of delivered framesets in which some stream had no matching frame";
+    case RS_OPTION_SYNC_DROPPED_FRAMES                             : return "Total number of key stream frames dropped for lack of a match in every stream";
+    case RS_OPTION_SYNC_AVERAGE_LATENCY                            : return "Average time in milliseconds the key stream frame of each delivered frameset was queued";
+    case RS_OPTION_FRAME_CAPACITY_DROPS                            : return "Total number of frames, framesets and frame references withheld because the room reserved for frames held by the user was exhausted";
     default: return rs_option_to_string(option);
     }
 }
@@ -670,6 +840,75 @@ void rs_device_base::set_options(const rs_option options[], size_t count, const
         case RS_OPTION_TOTAL_FRAME_DROPS:
             frames_drops_counter = (uint32_t)values[i];
             break;
+        case RS_OPTION_FRAME_POOL_HITS:
+            frame_pool_counters.hits = (uint32_t)values[i];
+            break;
+        case RS_OPTION_FRAME_POOL_MISSES:
+            frame_pool_counters.misses = (uint32_t)values[i];
+            break;
+        case RS_OPTION_FRAME_POOL_EVICTIONS:
+            frame_pool_counters.evictions = (uint32_t)values[i];
+            break;
+        case RS_OPTION_CAPTURE_BUFFERS_COUNT:
+            capture_buffers_count = (uint32_t)values[i];
+            break;
+        case RS_OPTION_ZERO_COPY_ENABLED:
+            zero_copy_enabled = values[i] != 0;
+            break;
+        case RS_OPTION_CAPTURE_THREAD_PER_SUBDEVICE:
+            capture_thread_per_subdevice = values[i] != 0;
+            break;
+        case RS_OPTION_CAPTURE_THREAD_AFFINITY:
+            capture_thread_affinity = (int)values[i];
+            break;
+        case RS_OPTION_CAPTURE_THREAD_PRIORITY:
+            capture_thread_priority = (int)values[i];
+            break;
+        case RS_OPTION_UNPACK_THREADS:
+            unpack_threads = (int)values[i];
+            break;
+        case RS_OPTION_LAZY_UNPACK_ENABLED:
+            lazy_unpack_enabled = values[i] != 0;
+            break;
+        case RS_OPTION_ALIGNMENT_THREADS:
+            alignment_threads = (int)values[i];
+            break;
+        case RS_OPTION_INCREMENTAL_ALIGNMENT_ENABLED:
+            incremental_alignment_enabled = values[i] != 0;
+            break;
+        case RS_OPTION_COMPACT_POINT_CLOUD_ENABLED:
+            compact_point_cloud_enabled = values[i] != 0;
+            break;
+        case RS_OPTION_BILINEAR_RECTIFICATION_ENABLED:
+            bilinear_rectification_enabled = values[i] != 0;
+            break;
+        case RS_OPTION_SYNC_QUEUE_SIZE:
+            sync_queue_size = (int)values[i];
+            break;
+        case RS_OPTION_SYNC_POLICY:
+            sync_policy = (int)values[i];
+            break;
+        case RS_OPTION_SYNC_TOLERANCE:
+            sync_tolerance = values[i];
+            break;
+        case RS_OPTION_SYNC_MAX_LATENCY:
+            sync_max_latency = values[i];
+            break;
+        case RS_OPTION_SYNC_FRAMESETS:
+            sync_counters.framesets = (uint32_t)values[i];
+            break;
+        case RS_OPTION_SYNC_INCOMPLETE_FRAMESETS:
+            sync_counters.incomplete = (uint32_t)values[i];
+            break;
+        case RS_OPTION_SYNC_DROPPED_FRAMES:
+            sync_counters.dropped = (uint32_t)values[i];
+            break;
+        case RS_OPTION_SYNC_AVERAGE_LATENCY:
+            sync_counters.total_latency = (uint64_t)(values[i] * 1000 * sync_counters.framesets);
+            break;
+        case RS_OPTION_FRAME_CAPACITY_DROPS:
+            frame_pool_counters.exhausted = (uint32_t)values[i];
+            break;
         default:
             LOG_WARNING("Cannot set " << options[i] << " to " << values[i] << " on " << get_name());
             throw std::logic_error("Option unsupported");
@@ -690,6 +929,75 @@ void rs_device_base::get_options(const rs_option options[], size_t count, double
         case  RS_OPTION_TOTAL_FRAME_DROPS:
             values[i] = frames_drops_counter;
             break;
+        case  RS_OPTION_FRAME_POOL_HITS:
+            values[i] = frame_pool_counters.hits;
+            break;
+        case  RS_OPTION_FRAME_POOL_MISSES:
+            values[i] = frame_pool_counters.misses;
+            break;
+        case  RS_OPTION_FRAME_POOL_EVICTIONS:
+            values[i] = frame_pool_counters.evictions;
+            break;
+        case  RS_OPTION_CAPTURE_BUFFERS_COUNT:
+            values[i] = capture_buffers_count;
+            break;
+        case  RS_OPTION_ZERO_COPY_ENABLED:
+            values[i] = zero_copy_enabled;
+            break;
+        case  RS_OPTION_CAPTURE_THREAD_PER_SUBDEVICE:
+            values[i] = capture_thread_per_subdevice;
+            break;
+        case  RS_OPTION_CAPTURE_THREAD_AFFINITY:
+            values[i] = capture_thread_affinity;
+            break;
+        case  RS_OPTION_CAPTURE_THREAD_PRIORITY:
+            values[i] = capture_thread_priority;
+            break;
+        case  RS_OPTION_UNPACK_THREADS:
+            values[i] = unpack_threads;
+            break;
+        case  RS_OPTION_LAZY_UNPACK_ENABLED:
+            values[i] = lazy_unpack_enabled;
+            break;
+        case  RS_OPTION_ALIGNMENT_THREADS:
+            values[i] = alignment_threads;
+            break;
+        case  RS_OPTION_INCREMENTAL_ALIGNMENT_ENABLED:
+            values[i] = incremental_alignment_enabled;
+            break;
+        case  RS_OPTION_COMPACT_POINT_CLOUD_ENABLED:
+            values[i] = compact_point_cloud_enabled;
+            break;
+        case  RS_OPTION_BILINEAR_RECTIFICATION_ENABLED:
+            values[i] = bilinear_rectification_enabled;
+            break;
+        case  RS_OPTION_SYNC_QUEUE_SIZE:
+            values[i] = sync_queue_size;
+            break;
+        case  RS_OPTION_SYNC_POLICY:
+            values[i] = sync_policy;
+            break;
+        case  RS_OPTION_SYNC_TOLERANCE:
+            values[i] = sync_tolerance;
+            break;
+        case  RS_OPTION_SYNC_MAX_LATENCY:
+            values[i] = sync_max_latency;
+            break;
+        case  RS_OPTION_SYNC_FRAMESETS:
+            values[i] = sync_counters.framesets;
+            break;
+        case  RS_OPTION_SYNC_INCOMPLETE_FRAMESETS:
+            values[i] = sync_counters.incomplete;
+            break;
+        case  RS_OPTION_SYNC_DROPPED_FRAMES:
+            values[i] = sync_counters.dropped;
+            break;
+        case  RS_OPTION_SYNC_AVERAGE_LATENCY:
+            values[i] = sync_counters.framesets ? sync_counters.total_latency / 1000.0 / sync_counters.framesets : 0;
+            break;
+        case  RS_OPTION_FRAME_CAPACITY_DROPS:
+            values[i] = frame_pool_counters.exhausted;
+            break;
         default:
             LOG_WARNING("Cannot get " << options[i] << " on " << get_name());
             throw std::logic_error("Option unsupported");
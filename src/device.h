@@ -80,6 +80,7 @@ protected:
 private:
     rsimpl::native_stream                       depth, color, infrared, infrared2, fisheye;
     rsimpl::point_stream                        points;
+    rsimpl::colored_point_stream                colored_points;
     rsimpl::rectified_stream                    rect_color;
     rsimpl::aligned_stream                      color_to_depth, depth_to_color, depth_to_rect_color, infrared2_to_depth, depth_to_infrared2;
     rsimpl::native_stream *                     native_streams[RS_STREAM_NATIVE_COUNT];
@@ -91,7 +92,23 @@ private:
     std::atomic<uint32_t>                       max_publish_list_size;
     std::atomic<uint32_t>                       event_queue_size;
     std::atomic<uint32_t>                       events_timeout;
+    std::atomic<uint32_t>                       capture_buffers_count;
+    std::atomic<bool>                           zero_copy_enabled;
+    std::atomic<bool>                           capture_thread_per_subdevice;
+    std::atomic<int>                            capture_thread_affinity;
+    std::atomic<int>                            capture_thread_priority;
+    std::atomic<int>                            unpack_threads;
+    std::atomic<bool>                           lazy_unpack_enabled;
+    std::atomic<int>                            alignment_threads;
+    std::atomic<bool>                           incremental_alignment_enabled;
+    std::atomic<bool>                           compact_point_cloud_enabled;
+    std::atomic<bool>                           bilinear_rectification_enabled;
+    std::atomic<int>                            sync_queue_size;
+    std::atomic<int>                            sync_policy;
+    std::atomic<double>                         sync_tolerance, sync_max_latency;
+    std::unique_ptr<rsimpl::worker_pool>        unpack_pool;
     std::shared_ptr<rsimpl::syncronizing_archive> archive;
+    std::shared_ptr<rsimpl::frameset_event>     frames_ready;                   // Outlives the archive, so applications can keep waiting on its descriptor across restarts
 
     mutable std::string                         usb_port_id;
     mutable std::mutex                          usb_port_mutex;
@@ -114,12 +131,17 @@ protected:
     std::atomic<bool>                           keep_fw_logger_alive;
     
     std::atomic<int>                            frames_drops_counter;
+    rsimpl::frame_pool_counters                 frame_pool_counters;
+    rsimpl::sync_counters                       sync_counters;
 
 public:
     rs_device_base(std::shared_ptr<rsimpl::uvc::device> device, const rsimpl::static_device_info & info, rsimpl::calibration_validator validator = rsimpl::calibration_validator());
     virtual ~rs_device_base();
 
     const rsimpl::stream_interface &            get_stream_interface(rs_stream stream) const override { return *streams[stream]; }
+    int                                         get_point_count() const override { return points.get_point_count(); }
+    const int *                                 get_point_pixel_indices() const override { return points.get_point_pixel_indices(); }
+    const float *                               get_point_texture_coordinates() const override { return points.get_point_texture_coordinates(); }
 
     const char *                                get_name() const override { return config.info.name.c_str(); }
     const char *                                get_serial() const override { return config.info.serial.c_str(); }
@@ -137,6 +159,10 @@ public:
     void                                        enable_motion_tracking() override;
     void                                        set_stream_callback(rs_stream stream, void(*on_frame)(rs_device * device, rs_frame_ref * frame, void * user), void * user) override;
     void                                        set_stream_callback(rs_stream stream, rs_frame_callback * callback) override;
+    void                                        set_frame_allocator(rs_frame_alloc_ptr on_alloc, rs_frame_free_ptr on_free, void * user) override;
+    void                                        set_frame_allocator(rs_frame_allocator * allocator) override;
+    void                                        set_stream_capture_buffers(rs_stream stream, int count, rs_capture_memory memory) override;
+    void                                        set_stream_sync_queue_size(rs_stream stream, int size) override;
     void                                        disable_motion_tracking() override;
 
     void                                        set_motion_callback(rs_motion_callback * callback) override;
@@ -154,7 +180,9 @@ public:
     int                                         is_motion_tracking_active() const override { return data_acquisition_active; }
 
     void                                        wait_all_streams() override;
+    bool                                        wait_all_streams(unsigned int timeout_ms) override;
     bool                                        poll_all_streams() override;
+    int                                         get_frames_ready_fd() const override;
 
     virtual bool                                supports(rs_capabilities capability) const override;
     virtual bool                                supports(rs_camera_info info_param) const override;
@@ -170,6 +198,7 @@ public:
     void                                        release_frame(rs_frame_ref * ref) override;
     const char *                                get_usb_port_id() const override;
     rs_frame_ref *                              clone_frame(rs_frame_ref * frame) override;
+    rs_frame_ref *                              compute_frame(rs_stream stream, const rs_frame_ref * frame, const rs_frame_ref * other) override;
 
     virtual void                                send_blob_to_device(rs_blob_type /*type*/, void * /*data*/, int /*size*/) { throw std::runtime_error("not supported!"); }
     static void                                 update_device_info(rsimpl::static_device_info& info);
@@ -7,8 +7,12 @@
 #include <cstring> // For memcpy
 #include <cmath>
 #include <algorithm>
-#ifdef __SSSE3__
-#include <tmmintrin.h> // For SSE3 intrinsic used in unpack_yuy2_sse
+#include <limits>
+#ifdef RS_SIMD_X86
+#include <immintrin.h> // For the SSSE3, AVX2 and AVX-512 intrinsics used by the unpacking kernels
+#endif
+#ifdef RS_SIMD_NEON
+#include <arm_neon.h>  // For the NEON intrinsics used by the unpacking kernels
 #endif
 
 #pragma pack(push, 1) // All structs in this file are assumed to be byte-packed
@@ -33,6 +37,9 @@ namespace rsimpl
         case RS_FORMAT_Z16: return  16;
         case RS_FORMAT_DISPARITY16: return 16;
         case RS_FORMAT_XYZ32F: return 12 * 8;
+        case RS_FORMAT_XYZ16F: return 6 * 8;
+        case RS_FORMAT_XYZ16: return 6 * 8;
+        case RS_FORMAT_XYZRGB: return 16 * 8;
         case RS_FORMAT_YUYV:  return 16;
         case RS_FORMAT_RGB8: return 24;
         case RS_FORMAT_BGR8: return 24;
@@ -66,53 +73,281 @@ namespace rsimpl
         for(int i=0; i<count; ++i) *out++ = unpack(*source++);
     }
 
-    void unpack_y16_from_y8    (byte * const d[], const byte * s, int n) { unpack_pixels(d, n, reinterpret_cast<const uint8_t  *>(s), [](uint8_t  pixel) -> uint16_t { return pixel | pixel << 8; }); }
-    void unpack_y16_from_y16_10(byte * const d[], const byte * s, int n) { unpack_pixels(d, n, reinterpret_cast<const uint16_t *>(s), [](uint16_t pixel) -> uint16_t { return pixel << 6; }); }
-    void unpack_y8_from_y16_10 (byte * const d[], const byte * s, int n) { unpack_pixels(d, n, reinterpret_cast<const uint16_t *>(s), [](uint16_t pixel) -> uint8_t  { return pixel >> 2; }); }
-    void unpack_rw10_from_rw8 (byte *  const d[], const byte * s, int n)
+    // Runs the widest kernel the CPU supports over as many pixels as it handles, and finishes the rest with the scalar reference.
+    // KERNELS provides generic(), and also ssse3() and avx2() on x86 or neon() on ARM, which advance the destination and source
+    // pointers past the pixels they convert and return the number of pixels left over.
+    template<class KERNELS, int OUTPUTS> void unpack_dispatch(byte * const dest[], const byte * source, int count)
     {
-#ifdef __SSSE3__
-        auto src = reinterpret_cast<const __m128i *>(s);
-        auto dst = reinterpret_cast<__m128i *>(d[0]);
+        byte * d[OUTPUTS];
+        for(int i = 0; i < OUTPUTS; ++i) d[i] = dest[i];
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx2) count = KERNELS::avx2(d, source, count);
+        if(level >= simd_level::ssse3) count = KERNELS::ssse3(d, source, count);
+#endif
+#ifdef RS_SIMD_NEON
+        if(get_simd_level() == simd_level::neon) count = KERNELS::neon(d, source, count);
+#endif
+        KERNELS::generic(d, source, count);
+    }
 
-        __m128i* xin = (__m128i*)src;
-        __m128i* xout = (__m128i*) dst;
-        for (int i = 0; i < n; i += 16, ++xout, xin += 2)
+    struct y16_from_y8
+    {
+        static void generic(byte * const d[], const byte * s, int n) { unpack_pixels(d, n, reinterpret_cast<const uint8_t  *>(s), [](uint8_t  pixel) -> uint16_t { return pixel | pixel << 8; }); }
+#ifdef RS_SIMD_X86
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[1], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 16, d[0] += 32)
+            {
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), _mm_unpacklo_epi8(y, y));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]) + 1, _mm_unpackhi_epi8(y, y));
+            }
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[1], const byte * & s, int n)
+        {
+            for(; n >= 32; n -= 32, s += 32, d[0] += 64)
+            {
+                __m256i y = _mm256_permute4x64_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s)), 0xd8); // Unpacking works within 128-bit lanes
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), _mm256_unpacklo_epi8(y, y));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]) + 1, _mm256_unpackhi_epi8(y, y));
+            }
+            return n;
+        }
+#endif
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[1], const byte * & s, int n)
         {
-            __m128i  in1_16 = _mm_load_si128((__m128i*)(xin));
-            __m128i  in2_16 = _mm_load_si128((__m128i*)(xin + 1));
-            __m128i  out1_16 = _mm_srli_epi16(in1_16, 2);
-            __m128i  out2_16 = _mm_srli_epi16(in2_16, 2);
-            __m128i  out8 = _mm_packus_epi16(out1_16, out2_16);
-            _mm_store_si128(xout, out8);
+            for(; n >= 16; n -= 16, s += 16, d[0] += 32)
+            {
+                uint8x16_t y = vld1q_u8(s);
+                vst2q_u8(d[0], (uint8x16x2_t{{ y, y }}));
+            }
+            return n;
         }
-#else  // Generic code for when SSSE3 is not available.
-        unsigned short* from = (unsigned short*)s;
-        byte* to = d[0];
+#endif
+    };
 
-        for(int i = 0; i < n; ++i)
+    struct y16_from_y16_10
+    {
+        static void generic(byte * const d[], const byte * s, int n) { unpack_pixels(d, n, reinterpret_cast<const uint16_t *>(s), [](uint16_t pixel) -> uint16_t { return pixel << 6; }); }
+#ifdef RS_SIMD_X86
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[1], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 16, d[0] += 16) _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), _mm_slli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s)), 6));
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[1], const byte * & s, int n)
         {
-          byte temp = (byte)(*from >> 2);
-          *to = temp;
-          ++from;
-          ++to;
+            for(; n >= 16; n -= 16, s += 32, d[0] += 32) _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), _mm256_slli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s)), 6));
+            return n;
         }
 #endif
-    }
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[1], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 16, d[0] += 16) vst1q_u16(reinterpret_cast<uint16_t *>(d[0]), vshlq_n_u16(vld1q_u16(reinterpret_cast<const uint16_t *>(s)), 6));
+            return n;
+        }
+#endif
+    };
+
+    struct y8_from_y16_10
+    {
+        static void generic(byte * const d[], const byte * s, int n) { unpack_pixels(d, n, reinterpret_cast<const uint16_t *>(s), [](uint16_t pixel) -> uint8_t  { return pixel >> 2; }); }
+#ifdef RS_SIMD_X86
+        // Pixels are masked rather than saturated down to 8 bits, to truncate exactly like the scalar conversion
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[1], const byte * & s, int n)
+        {
+            const __m128i low_byte = _mm_set1_epi16(0xff);
+            for(; n >= 16; n -= 16, s += 32, d[0] += 16)
+            {
+                __m128i a = _mm_and_si128(_mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s)), 2), low_byte);
+                __m128i b = _mm_and_si128(_mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s) + 1), 2), low_byte);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), _mm_packus_epi16(a, b));
+            }
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[1], const byte * & s, int n)
+        {
+            const __m256i low_byte = _mm256_set1_epi16(0xff);
+            for(; n >= 32; n -= 32, s += 64, d[0] += 32)
+            {
+                __m256i a = _mm256_and_si256(_mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s)), 2), low_byte);
+                __m256i b = _mm256_and_si256(_mm256_srli_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s) + 1), 2), low_byte);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8)); // Packing works within 128-bit lanes
+            }
+            return n;
+        }
+#endif
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[1], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 16, d[0] += 8) vst1_u8(d[0], vmovn_u16(vshrq_n_u16(vld1q_u16(reinterpret_cast<const uint16_t *>(s)), 2)));
+            return n;
+        }
+#endif
+    };
+
+    void unpack_y16_from_y8    (byte * const d[], const byte * s, int n) { unpack_dispatch<y16_from_y8, 1>(d, s, n); }
+    void unpack_y16_from_y16_10(byte * const d[], const byte * s, int n) { unpack_dispatch<y16_from_y16_10, 1>(d, s, n); }
+    void unpack_y8_from_y16_10 (byte * const d[], const byte * s, int n) { unpack_dispatch<y8_from_y16_10, 1>(d, s, n); }
+    void unpack_rw10_from_rw8  (byte * const d[], const byte * s, int n) { unpack_y8_from_y16_10(d, s, n); }
 
     /////////////////////////////
     // YUY2 unpacking routines //
     /////////////////////////////
     
-    // This templated function unpacks YUY2 into Y8/Y16/RGB8/RGBA8/BGR8/BGRA8, depending on the compile-time parameter FORMAT.
+    // These templated functions unpack YUY2 into Y8/Y16/RGB8/RGBA8/BGR8/BGRA8, depending on the compile-time parameter FORMAT.
     // It is expected that all branching outside of the loop control variable will be removed due to constant-folding.
-    template<rs_format FORMAT> void unpack_yuy2(byte * const d [], const byte * s, int n)
+    // Each kernel converts as many whole 16 pixel blocks as fit in n pixels, advances d and s past them, and returns the number
+    // of pixels left over. All of them produce bit-identical output, so the choice of kernel never changes the image.
+    template<rs_format FORMAT> int unpack_yuy2_generic(byte * & d, const byte * & s, int n)
+    {
+        auto src = reinterpret_cast<const uint8_t *>(s);
+        auto dst = reinterpret_cast<uint8_t *>(d);
+        for(; n >= 16; n -= 16, src += 32)
+        {
+            if(FORMAT == RS_FORMAT_Y8)
+            {
+                uint8_t out[16] = {
+                    src[ 0], src[ 2], src[ 4], src[ 6],
+                    src[ 8], src[10], src[12], src[14],
+                    src[16], src[18], src[20], src[22],
+                    src[24], src[26], src[28], src[30],
+                };
+                memcpy(dst, out, sizeof out);
+                dst += sizeof out;
+                continue;
+            }
+
+            if(FORMAT == RS_FORMAT_Y16)
+            {
+                // Y16 is little-endian.  We output Y << 8.
+                uint8_t out[32] = {
+                    0, src[ 0], 0, src[ 2], 0, src[ 4], 0, src[ 6],
+                    0, src[ 8], 0, src[10], 0, src[12], 0, src[14],
+                    0, src[16], 0, src[18], 0, src[20], 0, src[22],
+                    0, src[24], 0, src[26], 0, src[28], 0, src[30],
+                };
+                memcpy(dst, out, sizeof out);
+                dst += sizeof out;
+                continue;
+            }
+
+            int16_t y[16] = {
+                src[ 0], src[ 2], src[ 4], src[ 6],
+                src[ 8], src[10], src[12], src[14],
+                src[16], src[18], src[20], src[22],
+                src[24], src[26], src[28], src[30],
+            }, u[16] = {
+                src[ 1], src[ 1], src[ 5], src[ 5],
+                src[ 9], src[ 9], src[13], src[13],
+                src[17], src[17], src[21], src[21],
+                src[25], src[25], src[29], src[29],
+            }, v[16] = {
+                src[ 3], src[ 3], src[ 7], src[ 7],
+                src[11], src[11], src[15], src[15],
+                src[19], src[19], src[23], src[23],
+                src[27], src[27], src[31], src[31],
+            };
+
+            uint8_t r[16], g[16], b[16];
+            for(int i = 0; i < 16; i++)
+            {
+                int32_t c = y[i] - 16;
+                int32_t d = u[i] - 128;
+                int32_t e = v[i] - 128;
+
+                // Each product is scaled down separately, exactly as the 16-bit fixed point arithmetic of the vectorized kernels does
+                int32_t t;
+                #define clamp(x)  ((t=(x)) > 255 ? 255 : t < 0 ? 0 : t)
+                r[i] = clamp((298 * c >> 8)                 + (409 * e >> 8));
+                g[i] = clamp((298 * c >> 8) - (100 * d >> 8) - (208 * e >> 8));
+                b[i] = clamp((298 * c >> 8) + (516 * d >> 8));
+                #undef clamp
+            }
+
+            if(FORMAT == RS_FORMAT_RGB8)
+            {
+                uint8_t out[16*3] = {
+                    r[ 0], g[ 0], b[ 0], r[ 1], g[ 1], b[ 1],
+                    r[ 2], g[ 2], b[ 2], r[ 3], g[ 3], b[ 3],
+                    r[ 4], g[ 4], b[ 4], r[ 5], g[ 5], b[ 5],
+                    r[ 6], g[ 6], b[ 6], r[ 7], g[ 7], b[ 7],
+                    r[ 8], g[ 8], b[ 8], r[ 9], g[ 9], b[ 9],
+                    r[10], g[10], b[10], r[11], g[11], b[11],
+                    r[12], g[12], b[12], r[13], g[13], b[13],
+                    r[14], g[14], b[14], r[15], g[15], b[15],
+                };
+                memcpy(dst, out, sizeof out);
+                dst += sizeof out;
+                continue;
+            }
+
+            if(FORMAT == RS_FORMAT_BGR8)
+            {
+                uint8_t out[16*3] = {
+                    b[ 0], g[ 0], r[ 0], b[ 1], g[ 1], r[ 1],
+                    b[ 2], g[ 2], r[ 2], b[ 3], g[ 3], r[ 3],
+                    b[ 4], g[ 4], r[ 4], b[ 5], g[ 5], r[ 5],
+                    b[ 6], g[ 6], r[ 6], b[ 7], g[ 7], r[ 7],
+                    b[ 8], g[ 8], r[ 8], b[ 9], g[ 9], r[ 9],
+                    b[10], g[10], r[10], b[11], g[11], r[11],
+                    b[12], g[12], r[12], b[13], g[13], r[13],
+                    b[14], g[14], r[14], b[15], g[15], r[15],
+                };
+                memcpy(dst, out, sizeof out);
+                dst += sizeof out;
+                continue;
+            }
+
+            if(FORMAT == RS_FORMAT_RGBA8)
+            {
+                uint8_t out[16*4] = {
+                    r[ 0], g[ 0], b[ 0], 255, r[ 1], g[ 1], b[ 1], 255,
+                    r[ 2], g[ 2], b[ 2], 255, r[ 3], g[ 3], b[ 3], 255,
+                    r[ 4], g[ 4], b[ 4], 255, r[ 5], g[ 5], b[ 5], 255,
+                    r[ 6], g[ 6], b[ 6], 255, r[ 7], g[ 7], b[ 7], 255,
+                    r[ 8], g[ 8], b[ 8], 255, r[ 9], g[ 9], b[ 9], 255,
+                    r[10], g[10], b[10], 255, r[11], g[11], b[11], 255,
+                    r[12], g[12], b[12], 255, r[13], g[13], b[13], 255,
+                    r[14], g[14], b[14], 255, r[15], g[15], b[15], 255,
+                };
+                memcpy(dst, out, sizeof out);
+                dst += sizeof out;
+                continue;
+            }
+
+            if(FORMAT == RS_FORMAT_BGRA8)
+            {
+                uint8_t out[16*4] = {
+                    b[ 0], g[ 0], r[ 0], 255, b[ 1], g[ 1], r[ 1], 255,
+                    b[ 2], g[ 2], r[ 2], 255, b[ 3], g[ 3], r[ 3], 255,
+                    b[ 4], g[ 4], r[ 4], 255, b[ 5], g[ 5], r[ 5], 255,
+                    b[ 6], g[ 6], r[ 6], 255, b[ 7], g[ 7], r[ 7], 255,
+                    b[ 8], g[ 8], r[ 8], 255, b[ 9], g[ 9], r[ 9], 255,
+                    b[10], g[10], r[10], 255, b[11], g[11], r[11], 255,
+                    b[12], g[12], r[12], 255, b[13], g[13], r[13], 255,
+                    b[14], g[14], r[14], 255, b[15], g[15], r[15], 255,
+                };
+                memcpy(dst, out, sizeof out);
+                dst += sizeof out;
+                continue;
+            }
+        }
+        d = dst;
+        s = reinterpret_cast<const byte *>(src);
+        return n;
+    }
+
+#ifdef RS_SIMD_X86
+    template<rs_format FORMAT> RS_TARGET("ssse3") int unpack_yuy2_ssse3(byte * & d, const byte * & s, int n)
     {
-        assert(n % 16 == 0); // All currently supported color resolutions are multiples of 16 pixels. Could easily extend support to other resolutions by copying final n<16 pixels into a zero-padded buffer and recursively calling self for final iteration.
-#ifdef __SSSE3__
         auto src = reinterpret_cast<const __m128i *>(s);
-        auto dst = reinterpret_cast<__m128i *>(d[0]);
-        for(; n; n -= 16)
+        auto dst = reinterpret_cast<__m128i *>(d);
+        for(; n >= 16; n -= 16)
         {
             const __m128i zero = _mm_set1_epi8(0);
             const __m128i n100 = _mm_set1_epi16(100 << 4);
@@ -251,139 +486,307 @@ namespace rsimpl
                 }
             }
         }    
-#else  // Generic code for when SSSE3 is not available.
-        auto src = reinterpret_cast<const uint8_t *>(s);
-        auto dst = reinterpret_cast<uint8_t *>(d[0]);
-        for(; n; n -= 16, src += 32)
+        d = reinterpret_cast<byte *>(dst);
+        s = reinterpret_cast<const byte *>(src);
+        return n;
+    }
+
+    // The wider kernels run the SSSE3 algorithm on a separate 16 pixel block in each 128-bit lane, since most AVX2 and AVX-512
+    // byte shuffles cannot cross lanes. Lane i of every result therefore holds consecutive output of block i, and the blocks
+    // are written back in pixel order.
+    template<int COUNT> RS_TARGET("avx2") inline void store_lanes(__m128i * dst, const __m256i (&r)[COUNT])
+    {
+        for(int i = 0; i < COUNT; ++i) _mm_storeu_si128(dst + i, _mm256_castsi256_si128(r[i]));
+        for(int i = 0; i < COUNT; ++i) _mm_storeu_si128(dst + COUNT + i, _mm256_extracti128_si256(r[i], 1));
+    }
+
+    template<int COUNT> RS_TARGET("avx512bw") inline void store_lanes(__m128i * dst, const __m512i (&r)[COUNT])
+    {
+        for(int i = 0; i < COUNT; ++i) _mm_storeu_si128(dst + i, _mm512_castsi512_si128(r[i]));
+        for(int i = 0; i < COUNT; ++i) _mm_storeu_si128(dst + COUNT + i, _mm512_extracti32x4_epi32(r[i], 1));
+        for(int i = 0; i < COUNT; ++i) _mm_storeu_si128(dst + COUNT * 2 + i, _mm512_extracti32x4_epi32(r[i], 2));
+        for(int i = 0; i < COUNT; ++i) _mm_storeu_si128(dst + COUNT * 3 + i, _mm512_extracti32x4_epi32(r[i], 3));
+    }
+
+    template<rs_format FORMAT> RS_TARGET("avx2") int unpack_yuy2_avx2(byte * & d, const byte * & s, int n)
+    {
+        auto src = reinterpret_cast<const __m128i *>(s);
+        auto dst = reinterpret_cast<__m128i *>(d);
+        for(; n >= 32; n -= 32, src += 4)
         {
+            const __m256i zero = _mm256_set1_epi8(0);
+            const __m256i n100 = _mm256_set1_epi16(100 << 4);
+            const __m256i n208 = _mm256_set1_epi16(208 << 4);
+            const __m256i n298 = _mm256_set1_epi16(298 << 4);
+            const __m256i n409 = _mm256_set1_epi16(409 << 4);
+            const __m256i n516 = _mm256_set1_epi16(516 << 4);
+            const __m256i evens_odds = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15));
+
+            // Load pixels 0-7 and 16-23 into one register and pixels 8-15 and 24-31 into the other
+            __m256i s0 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(src + 0)), _mm_loadu_si128(src + 2), 1);
+            __m256i s1 = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(src + 1)), _mm_loadu_si128(src + 3), 1);
+
             if(FORMAT == RS_FORMAT_Y8)
             {
-                uint8_t out[16] = {
-                    src[ 0], src[ 2], src[ 4], src[ 6],
-                    src[ 8], src[10], src[12], src[14],
-                    src[16], src[18], src[20], src[22],
-                    src[24], src[26], src[28], src[30],
-                };
-                memcpy(dst, out, sizeof out);
-                dst += sizeof out;
+                __m256i y0 = _mm256_shuffle_epi8(s0, _mm256_broadcastsi128_si256(_mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15,   0, 2, 4, 6, 8, 10, 12, 14)));
+                __m256i y1 = _mm256_shuffle_epi8(s1, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,   1, 3, 5, 7, 9, 11, 13, 15)));
+                __m256i out[] = { _mm256_alignr_epi8(y0, y1, 8) };
+                store_lanes(dst, out);
+                dst += 2;
                 continue;
             }
 
+            const __m256i evens_odd1s_odd3s = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15));
+            __m256i yyyyyyyyuuuuvvvv0 = _mm256_shuffle_epi8(s0, evens_odd1s_odd3s);
+            __m256i yyyyyyyyuuuuvvvv8 = _mm256_shuffle_epi8(s1, evens_odd1s_odd3s);
+
+            __m256i y16__0_7 = _mm256_unpacklo_epi8(yyyyyyyyuuuuvvvv0, zero);
+            __m256i y16__8_F = _mm256_unpacklo_epi8(yyyyyyyyuuuuvvvv8, zero);
+
             if(FORMAT == RS_FORMAT_Y16)
             {
-                // Y16 is little-endian.  We output Y << 8.
-                uint8_t out[32] = {
-                    0, src[ 0], 0, src[ 2], 0, src[ 4], 0, src[ 6],
-                    0, src[ 8], 0, src[10], 0, src[12], 0, src[14],
-                    0, src[16], 0, src[18], 0, src[20], 0, src[22],
-                    0, src[24], 0, src[26], 0, src[28], 0, src[30],
-                };
-                memcpy(dst, out, sizeof out);
-                dst += sizeof out;
+                __m256i out[] = { _mm256_slli_epi16(y16__0_7, 8), _mm256_slli_epi16(y16__8_F, 8) };
+                store_lanes(dst, out);
+                dst += 4;
                 continue;
             }
 
-            int16_t y[16] = {
-                src[ 0], src[ 2], src[ 4], src[ 6],
-                src[ 8], src[10], src[12], src[14],
-                src[16], src[18], src[20], src[22],
-                src[24], src[26], src[28], src[30],
-            }, u[16] = {
-                src[ 1], src[ 1], src[ 5], src[ 5],
-                src[ 9], src[ 9], src[13], src[13],
-                src[17], src[17], src[21], src[21],
-                src[25], src[25], src[29], src[29],
-            }, v[16] = {
-                src[ 3], src[ 3], src[ 7], src[ 7],
-                src[11], src[11], src[15], src[15],
-                src[19], src[19], src[23], src[23],
-                src[27], src[27], src[31], src[31],
-            };
-
-            uint8_t r[16], g[16], b[16];
-            for(int i = 0; i < 16; i++)
+            __m256i uv = _mm256_unpackhi_epi32(yyyyyyyyuuuuvvvv0, yyyyyyyyuuuuvvvv8);
+            __m256i u = _mm256_unpacklo_epi8(uv, uv);
+            __m256i v = _mm256_unpackhi_epi8(uv, uv);
+            __m256i u16__0_7 = _mm256_unpacklo_epi8(u, zero);
+            __m256i u16__8_F = _mm256_unpackhi_epi8(u, zero);
+            __m256i v16__0_7 = _mm256_unpacklo_epi8(v, zero);
+            __m256i v16__8_F = _mm256_unpackhi_epi8(v, zero);
+
+            __m256i c16__0_7 = _mm256_slli_epi16(_mm256_subs_epi16(y16__0_7, _mm256_set1_epi16(16)), 4);
+            __m256i d16__0_7 = _mm256_slli_epi16(_mm256_subs_epi16(u16__0_7, _mm256_set1_epi16(128)), 4);
+            __m256i e16__0_7 = _mm256_slli_epi16(_mm256_subs_epi16(v16__0_7, _mm256_set1_epi16(128)), 4);
+            __m256i r16__0_7 = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__0_7, n298), _mm256_mulhi_epi16(e16__0_7, n409))));
+            __m256i g16__0_7 = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_sub_epi16(_mm256_sub_epi16(_mm256_mulhi_epi16(c16__0_7, n298), _mm256_mulhi_epi16(d16__0_7, n100)), _mm256_mulhi_epi16(e16__0_7, n208))));
+            __m256i b16__0_7 = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__0_7, n298), _mm256_mulhi_epi16(d16__0_7, n516))));
+
+            __m256i c16__8_F = _mm256_slli_epi16(_mm256_subs_epi16(y16__8_F, _mm256_set1_epi16(16)), 4);
+            __m256i d16__8_F = _mm256_slli_epi16(_mm256_subs_epi16(u16__8_F, _mm256_set1_epi16(128)), 4);
+            __m256i e16__8_F = _mm256_slli_epi16(_mm256_subs_epi16(v16__8_F, _mm256_set1_epi16(128)), 4);
+            __m256i r16__8_F = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__8_F, n298), _mm256_mulhi_epi16(e16__8_F, n409))));
+            __m256i g16__8_F = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_sub_epi16(_mm256_sub_epi16(_mm256_mulhi_epi16(c16__8_F, n298), _mm256_mulhi_epi16(d16__8_F, n100)), _mm256_mulhi_epi16(e16__8_F, n208))));
+            __m256i b16__8_F = _mm256_min_epi16(_mm256_set1_epi16(255), _mm256_max_epi16(zero, _mm256_add_epi16(_mm256_mulhi_epi16(c16__8_F, n298), _mm256_mulhi_epi16(d16__8_F, n516))));
+
+            // Order the components as (R, G, B, A) or (B, G, R, A)
+            const bool rgb = FORMAT == RS_FORMAT_RGB8 || FORMAT == RS_FORMAT_RGBA8;
+            __m256i xg8__0_7 = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(rgb ? r16__0_7 : b16__0_7, evens_odds), _mm256_shuffle_epi8(g16__0_7, evens_odds));
+            __m256i xa8__0_7 = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(rgb ? b16__0_7 : r16__0_7, evens_odds), _mm256_set1_epi8(-1));
+            __m256i xgxa_0_3 = _mm256_unpacklo_epi16(xg8__0_7, xa8__0_7);
+            __m256i xgxa_4_7 = _mm256_unpackhi_epi16(xg8__0_7, xa8__0_7);
+
+            __m256i xg8__8_F = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(rgb ? r16__8_F : b16__8_F, evens_odds), _mm256_shuffle_epi8(g16__8_F, evens_odds));
+            __m256i xa8__8_F = _mm256_unpacklo_epi8(_mm256_shuffle_epi8(rgb ? b16__8_F : r16__8_F, evens_odds), _mm256_set1_epi8(-1));
+            __m256i xgxa_8_B = _mm256_unpacklo_epi16(xg8__8_F, xa8__8_F);
+            __m256i xgxa_C_F = _mm256_unpackhi_epi16(xg8__8_F, xa8__8_F);
+
+            if(FORMAT == RS_FORMAT_RGBA8 || FORMAT == RS_FORMAT_BGRA8)
             {
-                int32_t c = y[i] - 16;
-                int32_t d = u[i] - 128;
-                int32_t e = v[i] - 128;
+                __m256i out[] = { xgxa_0_3, xgxa_4_7, xgxa_8_B, xgxa_C_F };
+                store_lanes(dst, out);
+                dst += 8;
+            }
 
-                int32_t t;
-                #define clamp(x)  ((t=(x)) > 255 ? 255 : t < 0 ? 0 : t)
-                r[i] = clamp((298 * c           + 409 * e + 128) >> 8);
-                g[i] = clamp((298 * c - 100 * d - 409 * e + 128) >> 8);
-                b[i] = clamp((298 * c + 516 * d           + 128) >> 8);
-                #undef clamp
+            if(FORMAT == RS_FORMAT_RGB8 || FORMAT == RS_FORMAT_BGR8)
+            {
+                __m256i xgx0 = _mm256_shuffle_epi8(xgxa_0_3, _mm256_broadcastsi128_si256(_mm_setr_epi8(  3, 7, 11, 15,   0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14)));
+                __m256i xgx1 = _mm256_shuffle_epi8(xgxa_4_7, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 2, 4,   3, 7, 11, 15,   5, 6, 8, 9, 10, 12, 13, 14)));
+                __m256i xgx2 = _mm256_shuffle_epi8(xgxa_8_B, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9,   3, 7, 11, 15,   10, 12, 13, 14)));
+                __m256i xgx3 = _mm256_shuffle_epi8(xgxa_C_F, _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,   3, 7, 11, 15  )));
+                __m256i out[] = { _mm256_alignr_epi8(xgx1, xgx0, 4), _mm256_alignr_epi8(xgx2, xgx1, 8), _mm256_alignr_epi8(xgx3, xgx2, 12) };
+                store_lanes(dst, out);
+                dst += 6;
             }
+        }
+        d = reinterpret_cast<byte *>(dst);
+        s = reinterpret_cast<const byte *>(src);
+        return n;
+    }
 
-            if(FORMAT == RS_FORMAT_RGB8)
+    RS_TARGET("avx512bw") inline __m512i load_lanes(const __m128i * src, int stride)
+    {
+        auto r = _mm512_inserti32x4(_mm512_setzero_si512(), _mm_loadu_si128(src), 0);
+        r = _mm512_inserti32x4(r, _mm_loadu_si128(src + stride), 1);
+        r = _mm512_inserti32x4(r, _mm_loadu_si128(src + stride * 2), 2);
+        return _mm512_inserti32x4(r, _mm_loadu_si128(src + stride * 3), 3);
+    }
+
+    template<rs_format FORMAT> RS_TARGET("avx512bw") int unpack_yuy2_avx512bw(byte * & d, const byte * & s, int n)
+    {
+        auto src = reinterpret_cast<const __m128i *>(s);
+        auto dst = reinterpret_cast<__m128i *>(d);
+        for(; n >= 64; n -= 64, src += 8)
+        {
+            const __m512i zero = _mm512_set1_epi8(0);
+            const __m512i n100 = _mm512_set1_epi16(100 << 4);
+            const __m512i n208 = _mm512_set1_epi16(208 << 4);
+            const __m512i n298 = _mm512_set1_epi16(298 << 4);
+            const __m512i n409 = _mm512_set1_epi16(409 << 4);
+            const __m512i n516 = _mm512_set1_epi16(516 << 4);
+            const __m512i evens_odds = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15));
+
+            // Load the first 8 pixels of each 16 pixel block into one register and the last 8 into the other
+            __m512i s0 = load_lanes(src, 2);
+            __m512i s1 = load_lanes(src + 1, 2);
+
+            if(FORMAT == RS_FORMAT_Y8)
             {
-                uint8_t out[16*3] = {
-                    r[ 0], g[ 0], b[ 0], r[ 1], g[ 1], b[ 1],
-                    r[ 2], g[ 2], b[ 2], r[ 3], g[ 3], b[ 3],
-                    r[ 4], g[ 4], b[ 4], r[ 5], g[ 5], b[ 5],
-                    r[ 6], g[ 6], b[ 6], r[ 7], g[ 7], b[ 7],
-                    r[ 8], g[ 8], b[ 8], r[ 9], g[ 9], b[ 9],
-                    r[10], g[10], b[10], r[11], g[11], b[11],
-                    r[12], g[12], b[12], r[13], g[13], b[13],
-                    r[14], g[14], b[14], r[15], g[15], b[15],
-                };
-                memcpy(dst, out, sizeof out);
-                dst += sizeof out;
+                __m512i y0 = _mm512_shuffle_epi8(s0, _mm512_broadcast_i32x4(_mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15,   0, 2, 4, 6, 8, 10, 12, 14)));
+                __m512i y1 = _mm512_shuffle_epi8(s1, _mm512_broadcast_i32x4(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14,   1, 3, 5, 7, 9, 11, 13, 15)));
+                __m512i out[] = { _mm512_alignr_epi8(y0, y1, 8) };
+                store_lanes(dst, out);
+                dst += 4;
                 continue;
             }
 
-            if(FORMAT == RS_FORMAT_BGR8)
+            const __m512i evens_odd1s_odd3s = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15));
+            __m512i yyyyyyyyuuuuvvvv0 = _mm512_shuffle_epi8(s0, evens_odd1s_odd3s);
+            __m512i yyyyyyyyuuuuvvvv8 = _mm512_shuffle_epi8(s1, evens_odd1s_odd3s);
+
+            __m512i y16__0_7 = _mm512_unpacklo_epi8(yyyyyyyyuuuuvvvv0, zero);
+            __m512i y16__8_F = _mm512_unpacklo_epi8(yyyyyyyyuuuuvvvv8, zero);
+
+            if(FORMAT == RS_FORMAT_Y16)
             {
-                uint8_t out[16*3] = {
-                    b[ 0], g[ 0], r[ 0], b[ 1], g[ 1], r[ 1],
-                    b[ 2], g[ 2], r[ 2], b[ 3], g[ 3], r[ 3],
-                    b[ 4], g[ 4], r[ 4], b[ 5], g[ 5], r[ 5],
-                    b[ 6], g[ 6], r[ 6], b[ 7], g[ 7], r[ 7],
-                    b[ 8], g[ 8], r[ 8], b[ 9], g[ 9], r[ 9],
-                    b[10], g[10], r[10], b[11], g[11], r[11],
-                    b[12], g[12], r[12], b[13], g[13], r[13],
-                    b[14], g[14], r[14], b[15], g[15], r[15],
-                };
-                memcpy(dst, out, sizeof out);
-                dst += sizeof out;
+                __m512i out[] = { _mm512_slli_epi16(y16__0_7, 8), _mm512_slli_epi16(y16__8_F, 8) };
+                store_lanes(dst, out);
+                dst += 8;
                 continue;
             }
 
-            if(FORMAT == RS_FORMAT_RGBA8)
+            __m512i uv = _mm512_unpackhi_epi32(yyyyyyyyuuuuvvvv0, yyyyyyyyuuuuvvvv8);
+            __m512i u = _mm512_unpacklo_epi8(uv, uv);
+            __m512i v = _mm512_unpackhi_epi8(uv, uv);
+            __m512i u16__0_7 = _mm512_unpacklo_epi8(u, zero);
+            __m512i u16__8_F = _mm512_unpackhi_epi8(u, zero);
+            __m512i v16__0_7 = _mm512_unpacklo_epi8(v, zero);
+            __m512i v16__8_F = _mm512_unpackhi_epi8(v, zero);
+
+            __m512i c16__0_7 = _mm512_slli_epi16(_mm512_subs_epi16(y16__0_7, _mm512_set1_epi16(16)), 4);
+            __m512i d16__0_7 = _mm512_slli_epi16(_mm512_subs_epi16(u16__0_7, _mm512_set1_epi16(128)), 4);
+            __m512i e16__0_7 = _mm512_slli_epi16(_mm512_subs_epi16(v16__0_7, _mm512_set1_epi16(128)), 4);
+            __m512i r16__0_7 = _mm512_min_epi16(_mm512_set1_epi16(255), _mm512_max_epi16(zero, _mm512_add_epi16(_mm512_mulhi_epi16(c16__0_7, n298), _mm512_mulhi_epi16(e16__0_7, n409))));
+            __m512i g16__0_7 = _mm512_min_epi16(_mm512_set1_epi16(255), _mm512_max_epi16(zero, _mm512_sub_epi16(_mm512_sub_epi16(_mm512_mulhi_epi16(c16__0_7, n298), _mm512_mulhi_epi16(d16__0_7, n100)), _mm512_mulhi_epi16(e16__0_7, n208))));
+            __m512i b16__0_7 = _mm512_min_epi16(_mm512_set1_epi16(255), _mm512_max_epi16(zero, _mm512_add_epi16(_mm512_mulhi_epi16(c16__0_7, n298), _mm512_mulhi_epi16(d16__0_7, n516))));
+
+            __m512i c16__8_F = _mm512_slli_epi16(_mm512_subs_epi16(y16__8_F, _mm512_set1_epi16(16)), 4);
+            __m512i d16__8_F = _mm512_slli_epi16(_mm512_subs_epi16(u16__8_F, _mm512_set1_epi16(128)), 4);
+            __m512i e16__8_F = _mm512_slli_epi16(_mm512_subs_epi16(v16__8_F, _mm512_set1_epi16(128)), 4);
+            __m512i r16__8_F = _mm512_min_epi16(_mm512_set1_epi16(255), _mm512_max_epi16(zero, _mm512_add_epi16(_mm512_mulhi_epi16(c16__8_F, n298), _mm512_mulhi_epi16(e16__8_F, n409))));
+            __m512i g16__8_F = _mm512_min_epi16(_mm512_set1_epi16(255), _mm512_max_epi16(zero, _mm512_sub_epi16(_mm512_sub_epi16(_mm512_mulhi_epi16(c16__8_F, n298), _mm512_mulhi_epi16(d16__8_F, n100)), _mm512_mulhi_epi16(e16__8_F, n208))));
+            __m512i b16__8_F = _mm512_min_epi16(_mm512_set1_epi16(255), _mm512_max_epi16(zero, _mm512_add_epi16(_mm512_mulhi_epi16(c16__8_F, n298), _mm512_mulhi_epi16(d16__8_F, n516))));
+
+            // Order the components as (R, G, B, A) or (B, G, R, A)
+            const bool rgb = FORMAT == RS_FORMAT_RGB8 || FORMAT == RS_FORMAT_RGBA8;
+            __m512i xg8__0_7 = _mm512_unpacklo_epi8(_mm512_shuffle_epi8(rgb ? r16__0_7 : b16__0_7, evens_odds), _mm512_shuffle_epi8(g16__0_7, evens_odds));
+            __m512i xa8__0_7 = _mm512_unpacklo_epi8(_mm512_shuffle_epi8(rgb ? b16__0_7 : r16__0_7, evens_odds), _mm512_set1_epi8(-1));
+            __m512i xgxa_0_3 = _mm512_unpacklo_epi16(xg8__0_7, xa8__0_7);
+            __m512i xgxa_4_7 = _mm512_unpackhi_epi16(xg8__0_7, xa8__0_7);
+
+            __m512i xg8__8_F = _mm512_unpacklo_epi8(_mm512_shuffle_epi8(rgb ? r16__8_F : b16__8_F, evens_odds), _mm512_shuffle_epi8(g16__8_F, evens_odds));
+            __m512i xa8__8_F = _mm512_unpacklo_epi8(_mm512_shuffle_epi8(rgb ? b16__8_F : r16__8_F, evens_odds), _mm512_set1_epi8(-1));
+            __m512i xgxa_8_B = _mm512_unpacklo_epi16(xg8__8_F, xa8__8_F);
+            __m512i xgxa_C_F = _mm512_unpackhi_epi16(xg8__8_F, xa8__8_F);
+
+            if(FORMAT == RS_FORMAT_RGBA8 || FORMAT == RS_FORMAT_BGRA8)
             {
-                uint8_t out[16*4] = {
-                    r[ 0], g[ 0], b[ 0], 255, r[ 1], g[ 1], b[ 1], 255,
-                    r[ 2], g[ 2], b[ 2], 255, r[ 3], g[ 3], b[ 3], 255,
-                    r[ 4], g[ 4], b[ 4], 255, r[ 5], g[ 5], b[ 5], 255,
-                    r[ 6], g[ 6], b[ 6], 255, r[ 7], g[ 7], b[ 7], 255,
-                    r[ 8], g[ 8], b[ 8], 255, r[ 9], g[ 9], b[ 9], 255,
-                    r[10], g[10], b[10], 255, r[11], g[11], b[11], 255,
-                    r[12], g[12], b[12], 255, r[13], g[13], b[13], 255,
-                    r[14], g[14], b[14], 255, r[15], g[15], b[15], 255,
-                };
-                memcpy(dst, out, sizeof out);
-                dst += sizeof out;
-                continue;
+                __m512i out[] = { xgxa_0_3, xgxa_4_7, xgxa_8_B, xgxa_C_F };
+                store_lanes(dst, out);
+                dst += 16;
             }
 
-            if(FORMAT == RS_FORMAT_BGRA8)
+            if(FORMAT == RS_FORMAT_RGB8 || FORMAT == RS_FORMAT_BGR8)
             {
-                uint8_t out[16*4] = {
-                    b[ 0], g[ 0], r[ 0], 255, b[ 1], g[ 1], r[ 1], 255,
-                    b[ 2], g[ 2], r[ 2], 255, b[ 3], g[ 3], r[ 3], 255,
-                    b[ 4], g[ 4], r[ 4], 255, b[ 5], g[ 5], r[ 5], 255,
-                    b[ 6], g[ 6], r[ 6], 255, b[ 7], g[ 7], r[ 7], 255,
-                    b[ 8], g[ 8], r[ 8], 255, b[ 9], g[ 9], r[ 9], 255,
-                    b[10], g[10], r[10], 255, b[11], g[11], r[11], 255,
-                    b[12], g[12], r[12], 255, b[13], g[13], r[13], 255,
-                    b[14], g[14], r[14], 255, b[15], g[15], r[15], 255,
-                };
-                memcpy(dst, out, sizeof out);
-                dst += sizeof out;
+                __m512i xgx0 = _mm512_shuffle_epi8(xgxa_0_3, _mm512_broadcast_i32x4(_mm_setr_epi8(  3, 7, 11, 15,   0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14)));
+                __m512i xgx1 = _mm512_shuffle_epi8(xgxa_4_7, _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, 4,   3, 7, 11, 15,   5, 6, 8, 9, 10, 12, 13, 14)));
+                __m512i xgx2 = _mm512_shuffle_epi8(xgxa_8_B, _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9,   3, 7, 11, 15,   10, 12, 13, 14)));
+                __m512i xgx3 = _mm512_shuffle_epi8(xgxa_C_F, _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,   3, 7, 11, 15  )));
+                __m512i out[] = { _mm512_alignr_epi8(xgx1, xgx0, 4), _mm512_alignr_epi8(xgx2, xgx1, 8), _mm512_alignr_epi8(xgx3, xgx2, 12) };
+                store_lanes(dst, out);
+                dst += 12;
+            }
+        }
+        d = reinterpret_cast<byte *>(dst);
+        s = reinterpret_cast<const byte *>(src);
+        return n;
+    }
+#endif
+
+#ifdef RS_SIMD_NEON
+    // Computes 8 R, G, B values. vqdmulhq_s16(x << 4, k << 3) is exactly (x * k) >> 8, the same per-term scaling as _mm_mulhi_epi16(x << 4, k << 4)
+    inline void yuy2_to_rgb_neon(uint8x8_t y, uint8x8_t u, uint8x8_t v, uint8x8_t & r, uint8x8_t & g, uint8x8_t & b)
+    {
+        int16x8_t c = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(16)), 4);
+        int16x8_t d = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128)), 4);
+        int16x8_t e = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128)), 4);
+        int16x8_t c298 = vqdmulhq_s16(c, vdupq_n_s16(298 << 3));
+        r = vqmovun_s16(vaddq_s16(c298, vqdmulhq_s16(e, vdupq_n_s16(409 << 3))));
+        g = vqmovun_s16(vsubq_s16(vsubq_s16(c298, vqdmulhq_s16(d, vdupq_n_s16(100 << 3))), vqdmulhq_s16(e, vdupq_n_s16(208 << 3))));
+        b = vqmovun_s16(vaddq_s16(c298, vqdmulhq_s16(d, vdupq_n_s16(516 << 3))));
+    }
+
+    template<rs_format FORMAT> int unpack_yuy2_neon(byte * & d, const byte * & s, int n)
+    {
+        for(; n >= 16; n -= 16, s += 32)
+        {
+            uint8x16x2_t yuyv = vld2q_u8(s); // 16 Y components, and 8 interleaved U/V pairs
+            if(FORMAT == RS_FORMAT_Y8)
+            {
+                vst1q_u8(d, yuyv.val[0]);
+                d += 16;
+                continue;
+            }
+            if(FORMAT == RS_FORMAT_Y16)
+            {
+                vst2q_u8(d, (uint8x16x2_t{{ vdupq_n_u8(0), yuyv.val[0] }}));
+                d += 32;
                 continue;
             }
+
+            uint8x8x2_t uv = vuzp_u8(vget_low_u8(yuyv.val[1]), vget_high_u8(yuyv.val[1]));
+            uint8x8x2_t u = vzip_u8(uv.val[0], uv.val[0]), v = vzip_u8(uv.val[1], uv.val[1]); // Each U/V is shared by two pixels
+            uint8x8_t r0, g0, b0, r1, g1, b1;
+            yuy2_to_rgb_neon(vget_low_u8(yuyv.val[0]), u.val[0], v.val[0], r0, g0, b0);
+            yuy2_to_rgb_neon(vget_high_u8(yuyv.val[0]), u.val[1], v.val[1], r1, g1, b1);
+            uint8x16_t r = vcombine_u8(r0, r1), g = vcombine_u8(g0, g1), b = vcombine_u8(b0, b1);
+
+            if(FORMAT == RS_FORMAT_RGB8) { vst3q_u8(d, (uint8x16x3_t{{ r, g, b }})); d += 48; }
+            if(FORMAT == RS_FORMAT_BGR8) { vst3q_u8(d, (uint8x16x3_t{{ b, g, r }})); d += 48; }
+            if(FORMAT == RS_FORMAT_RGBA8) { vst4q_u8(d, (uint8x16x4_t{{ r, g, b, vdupq_n_u8(255) }})); d += 64; }
+            if(FORMAT == RS_FORMAT_BGRA8) { vst4q_u8(d, (uint8x16x4_t{{ b, g, r, vdupq_n_u8(255) }})); d += 64; }
         }
+        return n;
+    }
+#endif
+
+    template<rs_format FORMAT> void unpack_yuy2(byte * const d [], const byte * s, int n)
+    {
+        auto dst = d[0];
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx512bw) n = unpack_yuy2_avx512bw<FORMAT>(dst, s, n);
+        if(level >= simd_level::avx2) n = unpack_yuy2_avx2<FORMAT>(dst, s, n);
+        if(level >= simd_level::ssse3) n = unpack_yuy2_ssse3<FORMAT>(dst, s, n);
+#endif
+#ifdef RS_SIMD_NEON
+        if(get_simd_level() == simd_level::neon) n = unpack_yuy2_neon<FORMAT>(dst, s, n);
 #endif
+        n = unpack_yuy2_generic<FORMAT>(dst, s, n);
+        if(n)
+        {
+            // Convert the final n<16 pixels of a row whose width is not a multiple of 16 through a zero-padded block
+            byte in[32] = {}, out[16*4];
+            memcpy(in, s, n*2);
+            byte * o = out;
+            const byte * i = in;
+            unpack_yuy2_generic<FORMAT>(o, i, 16);
+            memcpy(dst, out, n * get_image_bpp(FORMAT) / 8);
+        }
     }
     
     //////////////////////////////////////
@@ -401,51 +804,246 @@ namespace rsimpl
         }    
     }
 
-    struct y8i_pixel { uint8_t l, r; };
-    void unpack_y8_y8_from_y8i(byte * const dest[], const byte * source, int count)
+    // The vectorized splitters below treat the packed 3-byte formats as 8 pixel (24 byte) groups, gathered from two overlapping
+    // 16 byte loads at offsets 0 and 8. The AVX2 versions process one such group in each 128-bit lane.
+#ifdef RS_SIMD_X86
+    RS_TARGET("ssse3") inline __m128i gather_ssse3(const byte * s, __m128i lo_mask, __m128i hi_mask)
     {
-        split_frame(dest, count, reinterpret_cast<const y8i_pixel *>(source),
-            [](const y8i_pixel & p) -> uint8_t { return p.l; },
-            [](const y8i_pixel & p) -> uint8_t { return p.r; });
+        return _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s)), lo_mask), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s + 8)), hi_mask));
     }
 
-    struct y12i_pixel { uint8_t rl : 8, rh : 4, ll : 4, lh : 8; int l() const { return lh << 4 | ll; } int r() const { return rh << 8 | rl; } };
-    void unpack_y16_y16_from_y12i_10(byte * const dest[], const byte * source, int count)
+    RS_TARGET("avx2") inline __m256i load_lanes(const byte * s, int stride)
     {
-        split_frame(dest, count, reinterpret_cast<const y12i_pixel *>(source),
-            [](const y12i_pixel & p) -> uint16_t { return p.l() << 6 | p.l() >> 4; },  // We want to convert 10-bit data to 16-bit data
-            [](const y12i_pixel & p) -> uint16_t { return p.r() << 6 | p.r() >> 4; }); // Multiply by 64 1/16 to efficiently approximate 65535/1023
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s))), _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + stride)), 1);
     }
 
-    struct f200_inzi_pixel { uint16_t z16; uint8_t y8; };
-    void unpack_z16_y8_from_f200_inzi(byte * const dest[], const byte * source, int count)
+    RS_TARGET("avx2") inline __m256i gather_avx2(const byte * s, __m128i lo_mask, __m128i hi_mask)
     {
-        split_frame(dest, count, reinterpret_cast<const f200_inzi_pixel *>(source),
-            [](const f200_inzi_pixel & p) -> uint16_t { return p.z16; },
-            [](const f200_inzi_pixel & p) -> uint8_t { return p.y8; });
+        return _mm256_or_si256(_mm256_shuffle_epi8(load_lanes(s, 24), _mm256_broadcastsi128_si256(lo_mask)), _mm256_shuffle_epi8(load_lanes(s + 8, 24), _mm256_broadcastsi128_si256(hi_mask)));
     }
 
-    void unpack_z16_y16_from_f200_inzi(byte * const dest[], const byte * source, int count)
+    // Byte 3k, 3k+1 and 3k+2 of the eight pixels in a group, as masks for gather_ssse3()/gather_avx2()
+    #define RS_GROUP_BYTES_01_LO _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, 12, 13, -1, -1, -1, -1, -1, -1)
+    #define RS_GROUP_BYTES_01_HI _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 7, 8, 10, 11, 13, 14)
+    #define RS_GROUP_BYTES_12_LO _mm_setr_epi8(1, 2, 4, 5, 7, 8, 10, 11, 13, 14, -1, -1, -1, -1, -1, -1)
+    #define RS_GROUP_BYTES_12_HI _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 8, 9, 11, 12, 14, 15)
+    #define RS_GROUP_BYTES_22_LO _mm_setr_epi8(2, 2, 5, 5, 8, 8, 11, 11, 14, 14, -1, -1, -1, -1, -1, -1)
+    #define RS_GROUP_BYTES_22_HI _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 9, 9, 12, 12, 15, 15)
+    #define RS_GROUP_BYTES_2_LO  _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)
+    #define RS_GROUP_BYTES_2_HI  _mm_setr_epi8(-1, -1, -1, -1, -1, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1)
+#endif
+
+    struct y8i_pixel { uint8_t l, r; };
+    struct y8_y8_from_y8i
     {
-        split_frame(dest, count, reinterpret_cast<const f200_inzi_pixel *>(source),
-            [](const f200_inzi_pixel & p) -> uint16_t { return p.z16; },
-            [](const f200_inzi_pixel & p) -> uint16_t { return p.y8 | p.y8 << 8; });
-    }
+        static void generic(byte * const dest[], const byte * source, int count)
+        {
+            split_frame(dest, count, reinterpret_cast<const y8i_pixel *>(source),
+                [](const y8i_pixel & p) -> uint8_t { return p.l; },
+                [](const y8i_pixel & p) -> uint8_t { return p.r; });
+        }
+#ifdef RS_SIMD_X86
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[2], const byte * & s, int n)
+        {
+            const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+            for(; n >= 16; n -= 16, s += 32, d[0] += 16, d[1] += 16)
+            {
+                __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s)), split);      // llllllllrrrrrrrr for pixels 0-7
+                __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s) + 1), split);  // llllllllrrrrrrrr for pixels 8-15
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), _mm_unpacklo_epi64(s0, s1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[1]), _mm_unpackhi_epi64(s0, s1));
+            }
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[2], const byte * & s, int n)
+        {
+            const __m256i split = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15));
+            for(; n >= 32; n -= 32, s += 64, d[0] += 32, d[1] += 32)
+            {
+                __m256i s0 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s)), split);     // Pixels 0-7 and 8-15
+                __m256i s1 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s) + 1), split); // Pixels 16-23 and 24-31
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(s0, s1), 0xd8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[1]), _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(s0, s1), 0xd8));
+            }
+            return n;
+        }
+#endif
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 32, d[0] += 16, d[1] += 16)
+            {
+                uint8x16x2_t lr = vld2q_u8(s);
+                vst1q_u8(d[0], lr.val[0]);
+                vst1q_u8(d[1], lr.val[1]);
+            }
+            return n;
+        }
+#endif
+    };
+
+    struct y12i_pixel { uint8_t rl : 8, rh : 4, ll : 4, lh : 8; int l() const { return lh << 4 | ll; } int r() const { return rh << 8 | rl; } };
+    struct y16_y16_from_y12i_10
+    {
+        static void generic(byte * const dest[], const byte * source, int count)
+        {
+            split_frame(dest, count, reinterpret_cast<const y12i_pixel *>(source),
+                [](const y12i_pixel & p) -> uint16_t { return p.l() << 6 | p.l() >> 4; },  // We want to convert 10-bit data to 16-bit data
+                [](const y12i_pixel & p) -> uint16_t { return p.r() << 6 | p.r() >> 4; }); // Multiply by 64 1/16 to efficiently approximate 65535/1023
+        }
+#ifdef RS_SIMD_X86
+        // Each pixel is a 24-bit little-endian word, with the right image in the low 12 bits and the left image in the high 12 bits
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 24, d[0] += 16, d[1] += 16)
+            {
+                __m128i l = _mm_srli_epi16(gather_ssse3(s, RS_GROUP_BYTES_12_LO, RS_GROUP_BYTES_12_HI), 4);
+                __m128i r = _mm_and_si128(gather_ssse3(s, RS_GROUP_BYTES_01_LO, RS_GROUP_BYTES_01_HI), _mm_set1_epi16(0xfff));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), _mm_or_si128(_mm_slli_epi16(l, 6), _mm_srli_epi16(l, 4)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[1]), _mm_or_si128(_mm_slli_epi16(r, 6), _mm_srli_epi16(r, 4)));
+            }
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 48, d[0] += 32, d[1] += 32)
+            {
+                __m256i l = _mm256_srli_epi16(gather_avx2(s, RS_GROUP_BYTES_12_LO, RS_GROUP_BYTES_12_HI), 4);
+                __m256i r = _mm256_and_si256(gather_avx2(s, RS_GROUP_BYTES_01_LO, RS_GROUP_BYTES_01_HI), _mm256_set1_epi16(0xfff));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), _mm256_or_si256(_mm256_slli_epi16(l, 6), _mm256_srli_epi16(l, 4)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[1]), _mm256_or_si256(_mm256_slli_epi16(r, 6), _mm256_srli_epi16(r, 4)));
+            }
+            return n;
+        }
+#endif
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 24, d[0] += 16, d[1] += 16)
+            {
+                uint8x8x3_t p = vld3_u8(s);
+                uint16x8_t l = vorrq_u16(vshll_n_u8(p.val[2], 4), vmovl_u8(vshr_n_u8(p.val[1], 4)));
+                uint16x8_t r = vorrq_u16(vmovl_u8(p.val[0]), vshll_n_u8(vand_u8(p.val[1], vdup_n_u8(0xf)), 8));
+                vst1q_u16(reinterpret_cast<uint16_t *>(d[0]), vorrq_u16(vshlq_n_u16(l, 6), vshrq_n_u16(l, 4)));
+                vst1q_u16(reinterpret_cast<uint16_t *>(d[1]), vorrq_u16(vshlq_n_u16(r, 6), vshrq_n_u16(r, 4)));
+            }
+            return n;
+        }
+#endif
+    };
+
+    struct f200_inzi_pixel { uint16_t z16; uint8_t y8; };
+    struct z16_y8_from_f200_inzi
+    {
+        static void generic(byte * const dest[], const byte * source, int count)
+        {
+            split_frame(dest, count, reinterpret_cast<const f200_inzi_pixel *>(source),
+                [](const f200_inzi_pixel & p) -> uint16_t { return p.z16; },
+                [](const f200_inzi_pixel & p) -> uint8_t { return p.y8; });
+        }
+#ifdef RS_SIMD_X86
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 24, d[0] += 16, d[1] += 8)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), gather_ssse3(s, RS_GROUP_BYTES_01_LO, RS_GROUP_BYTES_01_HI));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(d[1]), gather_ssse3(s, RS_GROUP_BYTES_2_LO, RS_GROUP_BYTES_2_HI));
+            }
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 48, d[0] += 32, d[1] += 16)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), gather_avx2(s, RS_GROUP_BYTES_01_LO, RS_GROUP_BYTES_01_HI));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[1]), _mm256_castsi256_si128(_mm256_permute4x64_epi64(gather_avx2(s, RS_GROUP_BYTES_2_LO, RS_GROUP_BYTES_2_HI), 0x08)));
+            }
+            return n;
+        }
+#endif
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 48, d[0] += 32, d[1] += 16)
+            {
+                uint8x16x3_t p = vld3q_u8(s);
+                vst2q_u8(d[0], (uint8x16x2_t{{ p.val[0], p.val[1] }}));
+                vst1q_u8(d[1], p.val[2]);
+            }
+            return n;
+        }
+#endif
+    };
+
+    struct z16_y16_from_f200_inzi
+    {
+        static void generic(byte * const dest[], const byte * source, int count)
+        {
+            split_frame(dest, count, reinterpret_cast<const f200_inzi_pixel *>(source),
+                [](const f200_inzi_pixel & p) -> uint16_t { return p.z16; },
+                [](const f200_inzi_pixel & p) -> uint16_t { return p.y8 | p.y8 << 8; });
+        }
+#ifdef RS_SIMD_X86
+        static RS_TARGET("ssse3") int ssse3(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 8; n -= 8, s += 24, d[0] += 16, d[1] += 16)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[0]), gather_ssse3(s, RS_GROUP_BYTES_01_LO, RS_GROUP_BYTES_01_HI));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(d[1]), gather_ssse3(s, RS_GROUP_BYTES_22_LO, RS_GROUP_BYTES_22_HI));
+            }
+            return n;
+        }
+        static RS_TARGET("avx2") int avx2(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 48, d[0] += 32, d[1] += 32)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[0]), gather_avx2(s, RS_GROUP_BYTES_01_LO, RS_GROUP_BYTES_01_HI));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(d[1]), gather_avx2(s, RS_GROUP_BYTES_22_LO, RS_GROUP_BYTES_22_HI));
+            }
+            return n;
+        }
+#endif
+#ifdef RS_SIMD_NEON
+        static int neon(byte * (&d)[2], const byte * & s, int n)
+        {
+            for(; n >= 16; n -= 16, s += 48, d[0] += 32, d[1] += 32)
+            {
+                uint8x16x3_t p = vld3q_u8(s);
+                vst2q_u8(d[0], (uint8x16x2_t{{ p.val[0], p.val[1] }}));
+                vst2q_u8(d[1], (uint8x16x2_t{{ p.val[2], p.val[2] }}));
+            }
+            return n;
+        }
+#endif
+    };
+
+#ifdef RS_SIMD_X86
+    #undef RS_GROUP_BYTES_01_LO
+    #undef RS_GROUP_BYTES_01_HI
+    #undef RS_GROUP_BYTES_12_LO
+    #undef RS_GROUP_BYTES_12_HI
+    #undef RS_GROUP_BYTES_22_LO
+    #undef RS_GROUP_BYTES_22_HI
+    #undef RS_GROUP_BYTES_2_LO
+    #undef RS_GROUP_BYTES_2_HI
+#endif
+
+    void unpack_y8_y8_from_y8i(byte * const dest[], const byte * source, int count) { unpack_dispatch<y8_y8_from_y8i, 2>(dest, source, count); }
+    void unpack_y16_y16_from_y12i_10(byte * const dest[], const byte * source, int count) { unpack_dispatch<y16_y16_from_y12i_10, 2>(dest, source, count); }
+    void unpack_z16_y8_from_f200_inzi(byte * const dest[], const byte * source, int count) { unpack_dispatch<z16_y8_from_f200_inzi, 2>(dest, source, count); }
+    void unpack_z16_y16_from_f200_inzi(byte * const dest[], const byte * source, int count) { unpack_dispatch<z16_y16_from_f200_inzi, 2>(dest, source, count); }
 
+    // SR300 INZI frames hold a plane of 10-bit IR pixels followed by a plane of Z pixels
     void unpack_z16_y8_from_sr300_inzi(byte * const dest[], const byte * source, int count)
     {
-        auto in = reinterpret_cast<const uint16_t *>(source);
-        auto out_ir = reinterpret_cast<uint8_t *>(dest[1]);            
-        for(int i=0; i<count; ++i) *out_ir++ = *in++ >> 2;
-        memcpy(dest[0], in, count*2);
+        unpack_y8_from_y16_10(dest + 1, source, count);
+        memcpy(dest[0], source + count*2, count*2);
     }
 
     void unpack_z16_y16_from_sr300_inzi (byte * const dest[], const byte * source, int count)
     {
-        auto in = reinterpret_cast<const uint16_t *>(source);
-        auto out_ir = reinterpret_cast<uint16_t *>(dest[1]);
-        for(int i=0; i<count; ++i) *out_ir++ = *in++ << 6;
-        memcpy(dest[0], in, count*2);
+        unpack_y16_from_y16_10(dest + 1, source, count);
+        memcpy(dest[0], source + count*2, count*2);
     }
 
 #pragma GCC diagnostic push
@@ -485,154 +1083,828 @@ namespace rsimpl
     // Deprojection //
     //////////////////
 
-    template<class MAP_DEPTH> void deproject_depth(float * points, const rs_intrinsics & intrin, const uint16_t * depth, MAP_DEPTH map_depth)
+    // Each entry is the point a pixel deprojects to at a depth of one, so deprojecting at any other depth is a single multiply per coordinate
+    std::vector<float> compute_deprojection_table(const rs_intrinsics & intrin)
     {
+        std::vector<float> table(intrin.width * intrin.height * 3);
+        auto ray = table.data();
         for(int y=0; y<intrin.height; ++y)
         {
             for(int x=0; x<intrin.width; ++x)
             {
                 const float pixel[] = { (float) x, (float) y};
-                rs_deproject_pixel_to_point(points, &intrin, pixel, map_depth(*depth++));
-                points += 3;                
+                rs_deproject_pixel_to_point(ray, &intrin, pixel, 1.0f);
+                ray += 3;
             }
-        }    
+        }
+        return table;
+    }
+
+    // The kernels below deproject as many whole blocks of pixels as fit in n, advance their pointers past them, and return the number of
+    // pixels left over. DISPARITY selects depth = scale / pixel instead of depth = scale * pixel.
+    template<bool DISPARITY> void deproject_depth_generic(float * points, const float * ray, const uint16_t * depth, float scale, int n)
+    {
+        for(; n; --n, ray += 3, points += 3)
+        {
+            const float d = DISPARITY ? scale / *depth++ : scale * *depth++;
+            points[0] = ray[0] * d;
+            points[1] = ray[1] * d;
+            points[2] = ray[2] * d;
+        }
+    }
+
+#ifdef RS_SIMD_X86
+    template<bool DISPARITY> RS_TARGET("ssse3") int deproject_depth_ssse3(float * & points, const float * & ray, const uint16_t * & depth, float scale, int n)
+    {
+        const __m128 s = _mm_set1_ps(scale);
+        for(; n >= 4; n -= 4, depth += 4, ray += 12, points += 12)
+        {
+            __m128 z = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(depth)), _mm_setzero_si128()));
+            __m128 d = DISPARITY ? _mm_div_ps(s, z) : _mm_mul_ps(s, z);
+
+            // Spread the four depths over the twelve coordinates of the four points
+            _mm_storeu_ps(points + 0, _mm_mul_ps(_mm_loadu_ps(ray + 0), _mm_shuffle_ps(d, d, _MM_SHUFFLE(1, 0, 0, 0))));
+            _mm_storeu_ps(points + 4, _mm_mul_ps(_mm_loadu_ps(ray + 4), _mm_shuffle_ps(d, d, _MM_SHUFFLE(2, 2, 1, 1))));
+            _mm_storeu_ps(points + 8, _mm_mul_ps(_mm_loadu_ps(ray + 8), _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 3, 2))));
+        }
+        return n;
+    }
+
+    template<bool DISPARITY> RS_TARGET("avx2") int deproject_depth_avx2(float * & points, const float * & ray, const uint16_t * & depth, float scale, int n)
+    {
+        const __m256 s = _mm256_set1_ps(scale);
+        const __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2), spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5), spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+        for(; n >= 8; n -= 8, depth += 8, ray += 24, points += 24)
+        {
+            __m256 z = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(depth))));
+            __m256 d = DISPARITY ? _mm256_div_ps(s, z) : _mm256_mul_ps(s, z);
+            _mm256_storeu_ps(points +  0, _mm256_mul_ps(_mm256_loadu_ps(ray +  0), _mm256_permutevar8x32_ps(d, spread0)));
+            _mm256_storeu_ps(points +  8, _mm256_mul_ps(_mm256_loadu_ps(ray +  8), _mm256_permutevar8x32_ps(d, spread1)));
+            _mm256_storeu_ps(points + 16, _mm256_mul_ps(_mm256_loadu_ps(ray + 16), _mm256_permutevar8x32_ps(d, spread2)));
+        }
+        return n;
+    }
+#endif
+
+    template<bool DISPARITY> void deproject_depth(float * points, const std::vector<float> & rays, const uint16_t * depth, float scale)
+    {
+        auto ray = rays.data();
+        int n = (int)rays.size() / 3;
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx2) n = deproject_depth_avx2<DISPARITY>(points, ray, depth, scale, n);
+        if(level >= simd_level::ssse3) n = deproject_depth_ssse3<DISPARITY>(points, ray, depth, scale, n);
+#endif
+        deproject_depth_generic<DISPARITY>(points, ray, depth, scale, n);
+    }
+
+    void deproject_z(float * points, const std::vector<float> & rays, const uint16_t * z_pixels, float z_scale)
+    {
+        deproject_depth<false>(points, rays, z_pixels, z_scale);
+    }
+
+    void deproject_disparity(float * points, const std::vector<float> & rays, const uint16_t * disparity_pixels, float disparity_scale)
+    {
+        deproject_depth<true>(points, rays, disparity_pixels, disparity_scale);
+    }
+
+    // Compact deprojection writes only the points of pixels with depth, where count is the number of points written so far. Every point is
+    // written, but the next one overwrites it if its pixel had no depth, as branching on holes mispredicts too often on speckled images.
+    // Since count never exceeds the index of the pixel, no point is written past the end of the cloud.
+    template<bool DISPARITY> int deproject_depth_compact_generic(int i, int n, float * points, int & count, const float * rays, const uint16_t * depth, float scale)
+    {
+        for(; i < n; ++i)
+        {
+            const float d = DISPARITY ? scale / depth[i] : scale * depth[i];
+            float * point = points + count * 3;
+            point[0] = rays[i * 3 + 0] * d;
+            point[1] = rays[i * 3 + 1] * d;
+            point[2] = rays[i * 3 + 2] * d;
+            count += depth[i] != 0;
+        }
+        return i;
+    }
+
+#ifdef RS_SIMD_X86
+    template<bool DISPARITY> RS_TARGET("avx2") int deproject_depth_compact_avx2(int i, int n, float * points, int & count, const float * rays, const uint16_t * depth, float scale)
+    {
+        const __m256 s = _mm256_set1_ps(scale);
+        const __m256i spread0 = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2), spread1 = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5), spread2 = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7);
+        for(; i + 8 <= n; i += 8)
+        {
+            // Blocks of pixels without depth are skipped, and blocks with depth throughout are written in place
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(depth + i));
+            const int holes = _mm_movemask_epi8(_mm_cmpeq_epi16(pixels, _mm_setzero_si128()));
+            if(holes == 0xFFFF) continue;
+
+            __m256 z = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(pixels));
+            __m256 d = DISPARITY ? _mm256_div_ps(s, z) : _mm256_mul_ps(s, z);
+            const float * ray = rays + i * 3;
+            alignas(32) float block[24];
+            float * point = holes ? block : points + count * 3;
+            _mm256_storeu_ps(point +  0, _mm256_mul_ps(_mm256_loadu_ps(ray +  0), _mm256_permutevar8x32_ps(d, spread0)));
+            _mm256_storeu_ps(point +  8, _mm256_mul_ps(_mm256_loadu_ps(ray +  8), _mm256_permutevar8x32_ps(d, spread1)));
+            _mm256_storeu_ps(point + 16, _mm256_mul_ps(_mm256_loadu_ps(ray + 16), _mm256_permutevar8x32_ps(d, spread2)));
+            if(!holes)
+            {
+                count += 8;
+                continue;
+            }
+
+            // Mixed blocks are packed from the block one point at a time, the same way as above
+            for(int j = 0; j < 8; ++j)
+            {
+                memcpy(points + count * 3, block + j * 3, sizeof(float) * 3);
+                count += !(holes >> (j * 2) & 1);
+            }
+        }
+        return i;
+    }
+#endif
+
+    template<bool DISPARITY> int deproject_depth_compact(float * points, const std::vector<float> & rays, const uint16_t * depth, float scale)
+    {
+        int i = 0, n = (int)rays.size() / 3, count = 0;
+#ifdef RS_SIMD_X86
+        if(get_simd_level() >= simd_level::avx2) i = deproject_depth_compact_avx2<DISPARITY>(i, n, points, count, rays.data(), depth, scale);
+#endif
+        deproject_depth_compact_generic<DISPARITY>(i, n, points, count, rays.data(), depth, scale);
+        return count;
+    }
+
+    int deproject_z_compact(float * points, const std::vector<float> & rays, const uint16_t * z_pixels, float z_scale)
+    {
+        return deproject_depth_compact<false>(points, rays, z_pixels, z_scale);
+    }
+
+    int deproject_disparity_compact(float * points, const std::vector<float> & rays, const uint16_t * disparity_pixels, float disparity_scale)
+    {
+        return deproject_depth_compact<true>(points, rays, disparity_pixels, disparity_scale);
+    }
+
+    void find_valid_pixels(int * indices, const uint16_t * depth, int count)
+    {
+        for(int i = 0; i < count; ++i) if(depth[i]) *indices++ = i;
+    }
+
+    void compute_texture_coordinates(float * uv, const float * points, int count, const rs_extrinsics & points_to_texture, const rs_intrinsics & texture_intrin)
+    {
+        float x[projection_block_size], y[projection_block_size], z[projection_block_size];
+        for(int begin = 0; begin < count; begin += projection_block_size)
+        {
+            const int n = std::min<int>(count - begin, projection_block_size);
+            for(int i = 0; i < n; ++i)
+            {
+                x[i] = points[(begin + i) * 3 + 0];
+                y[i] = points[(begin + i) * 3 + 1];
+                z[i] = points[(begin + i) * 3 + 2];
+            }
+            transform_points(n, x, y, z, points_to_texture, x, y, z);
+            project_points(n, x, y, texture_intrin, x, y, z);
+            for(int i = 0; i < n; ++i)
+            {
+                uv[(begin + i) * 2 + 0] = x[i] / texture_intrin.width;
+                uv[(begin + i) * 2 + 1] = y[i] / texture_intrin.height;
+            }
+        }
+    }
+
+    // Colored deprojection finds each point, and the pixel of the color image nearest to where it lands, in one pass over blocks of the depth
+    // image. Pixels without depth, and points landing outside the color image, are black.
+    struct xyzrgb { float x, y, z; uint8_t r, g, b, pad; };
+
+    template<bool DISPARITY> void deproject_depth_colored(byte * colored_points, const std::vector<float> & rays, const uint16_t * depth, float scale, 
+        const rs_extrinsics & depth_to_color, const rs_intrinsics & color_intrin, const byte * color_pixels, rs_format color_format)
+    {
+        const int count = (int)rays.size() / 3;
+        auto out = reinterpret_cast<xyzrgb *>(colored_points);
+        float x[projection_block_size], y[projection_block_size], z[projection_block_size];
+        float color_x[projection_block_size], color_y[projection_block_size], color_z[projection_block_size];
+        for(int begin = 0; begin < count; begin += projection_block_size)
+        {
+            const int n = std::min<int>(count - begin, projection_block_size);
+            for(int i = 0; i < n; ++i)
+            {
+                const float d = DISPARITY ? scale / depth[begin + i] : scale * depth[begin + i];
+                x[i] = rays[(begin + i) * 3 + 0] * d;
+                y[i] = rays[(begin + i) * 3 + 1] * d;
+                z[i] = rays[(begin + i) * 3 + 2] * d;
+            }
+            transform_points(n, color_x, color_y, color_z, depth_to_color, x, y, z);
+            project_points(n, color_x, color_y, color_intrin, color_x, color_y, color_z);
+
+            for(int i = 0; i < n; ++i)
+            {
+                auto & p = out[begin + i];
+                p = { x[i], y[i], z[i], 0, 0, 0, 0 };
+                const int cx = (int)std::floor(color_x[i] + 0.5f), cy = (int)std::floor(color_y[i] + 0.5f);
+                if(!depth[begin + i] || cx < 0 || cy < 0 || cx >= color_intrin.width || cy >= color_intrin.height) continue;
+                const int c = cy * color_intrin.width + cx;
+                switch(color_format)
+                {
+                case RS_FORMAT_RGB8: p.r = color_pixels[c * 3 + 0]; p.g = color_pixels[c * 3 + 1]; p.b = color_pixels[c * 3 + 2]; break;
+                case RS_FORMAT_BGR8: p.r = color_pixels[c * 3 + 2]; p.g = color_pixels[c * 3 + 1]; p.b = color_pixels[c * 3 + 0]; break;
+                case RS_FORMAT_RGBA8: p.r = color_pixels[c * 4 + 0]; p.g = color_pixels[c * 4 + 1]; p.b = color_pixels[c * 4 + 2]; break;
+                case RS_FORMAT_BGRA8: p.r = color_pixels[c * 4 + 2]; p.g = color_pixels[c * 4 + 1]; p.b = color_pixels[c * 4 + 0]; break;
+                case RS_FORMAT_Y8: p.r = p.g = p.b = color_pixels[c]; break;
+                default: assert(false && "Cannot color points from this format");
+                }
+            }
+        }
+    }
+
+    void deproject_z_colored(byte * colored_points, const std::vector<float> & rays, const uint16_t * z_pixels, float z_scale, 
+        const rs_extrinsics & z_to_color, const rs_intrinsics & color_intrin, const byte * color_pixels, rs_format color_format)
+    {
+        deproject_depth_colored<false>(colored_points, rays, z_pixels, z_scale, z_to_color, color_intrin, color_pixels, color_format);
+    }
+
+    void deproject_disparity_colored(byte * colored_points, const std::vector<float> & rays, const uint16_t * disparity_pixels, float disparity_scale, 
+        const rs_extrinsics & disparity_to_color, const rs_intrinsics & color_intrin, const byte * color_pixels, rs_format color_format)
+    {
+        deproject_depth_colored<true>(colored_points, rays, disparity_pixels, disparity_scale, disparity_to_color, color_intrin, color_pixels, color_format);
+    }
+
+    // Rounds to the nearest half, ties to even, as F16C does, after "float_to_half_fast3_rtne" by Fabian Giesen
+    static uint16_t float_to_half(float f)
+    {
+        uint32_t x;
+        memcpy(&x, &f, sizeof(x));
+        const uint16_t sign = (x >> 16) & 0x8000;
+        x &= 0x7FFFFFFF;
+        if(x >= 0x7F800000) return sign | 0x7C00 | (x > 0x7F800000 ? 0x200 | ((x >> 13) & 0x3FF) : 0); // Infinity, or a quiet NaN
+        if(x >= 0x477FF000) return sign | 0x7C00; // Rounds above the largest half, 65504
+        if(x < 0x38800000) // Rounds to a subnormal half, which adding 0.5 lines up with the low bits of a float, rounding as it does
+        {
+            float magic = 0.5f, sum;
+            memcpy(&sum, &x, sizeof(sum));
+            sum += magic;
+            memcpy(&x, &sum, sizeof(x));
+            return sign | static_cast<uint16_t>(x - 0x3F000000);
+        }
+        const uint32_t odd = (x >> 13) & 1;
+        x += 0xC8000FFF + odd; // Rebias the exponent from 127 to 15, and round the 13 bits shifted out
+        return sign | static_cast<uint16_t>(x >> 13);
+    }
+
+    // Saturates to the range of int16_t, and also maps NaN to -32768 as the conversion instructions do
+    static int16_t meters_to_millimeters(float f)
+    {
+        f *= 1000;
+        f = f > -32768.0f ? f : -32768.0f;
+        f = f < 32767.0f ? f : 32767.0f;
+        return static_cast<int16_t>(std::lrint(f));
+    }
+
+#ifdef RS_SIMD_X86
+    static RS_TARGET("avx2,f16c") int convert_points_to_xyz16f_avx2(int i, int n, uint16_t * dest, const float * points)
+    {
+        for(; i + 8 <= n; i += 8)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dest + i), _mm256_cvtps_ph(_mm256_loadu_ps(points + i), _MM_FROUND_TO_NEAREST_INT));
+        }
+        return i;
+    }
+
+    static RS_TARGET("avx2") int convert_points_to_xyz16_avx2(int i, int n, int16_t * dest, const float * points)
+    {
+        const __m256 scale = _mm256_set1_ps(1000), lo = _mm256_set1_ps(-32768.0f), hi = _mm256_set1_ps(32767.0f);
+        for(; i + 16 <= n; i += 16)
+        {
+            // _mm256_max_ps() returns its second argument when the first is NaN
+            __m256i a = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(points + i + 0), scale), lo), hi));
+            __m256i b = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(points + i + 8), scale), lo), hi));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dest + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        return i;
+    }
+#endif
+
+    void convert_points_to_xyz16f(uint16_t * dest, const float * points, int count)
+    {
+        int i = 0;
+#ifdef RS_SIMD_X86
+        if(get_simd_level() >= simd_level::avx2) i = convert_points_to_xyz16f_avx2(i, count, dest, points);
+#endif
+        for(; i < count; ++i) dest[i] = float_to_half(points[i]);
+    }
+
+    void convert_points_to_xyz16(int16_t * dest, const float * points, int count)
+    {
+        int i = 0;
+#ifdef RS_SIMD_X86
+        if(get_simd_level() >= simd_level::avx2) i = convert_points_to_xyz16_avx2(i, count, dest, points);
+#endif
+        for(; i < count; ++i) dest[i] = meters_to_millimeters(points[i]);
     }
 
     void deproject_z(float * points, const rs_intrinsics & z_intrin, const uint16_t * z_pixels, float z_scale)
     {
-        deproject_depth(points, z_intrin, z_pixels, [z_scale](uint16_t z) { return z_scale * z; });
+        deproject_z(points, compute_deprojection_table(z_intrin), z_pixels, z_scale);
     }
 
     void deproject_disparity(float * points, const rs_intrinsics & disparity_intrin, const uint16_t * disparity_pixels, float disparity_scale)
     {
-        deproject_depth(points, disparity_intrin, disparity_pixels, [disparity_scale](uint16_t disparity) { return disparity_scale / disparity; });
+        deproject_disparity(points, compute_deprojection_table(disparity_intrin), disparity_pixels, disparity_scale);
     }
 
     /////////////////////
     // Image alignment //
     /////////////////////
 
-    template<class GET_DEPTH, class TRANSFER_PIXEL> void align_images(const rs_intrinsics & depth_intrin, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin, GET_DEPTH get_depth, TRANSFER_PIXEL transfer_pixel)
+    // Pixel (x, y) of the depth image spans from corner (x, y) at its top-left to corner (x + 1, y + 1) at its bottom-right, so the grid of
+    // corners has one more row and column than the image. The rays through them only change with the depth intrinsics.
+    static void update_corner_rays(alignment_workspace & workspace, const rs_intrinsics & depth_intrin)
     {
-        // Iterate over the pixels of the depth image    
-#pragma omp parallel for schedule(dynamic)
-        for(int depth_y = 0; depth_y < depth_intrin.height; ++depth_y)
+        if(!workspace.corner_x.empty() && workspace.depth_intrin == depth_intrin) return;
+
+        const int columns = depth_intrin.width + 1, rows = depth_intrin.height + 1;
+        workspace.corner_x.resize(columns * rows);
+        workspace.corner_y.resize(columns * rows);
+        for(int y=0; y<rows; ++y)
         {
-            int depth_pixel_index = depth_y * depth_intrin.width;
-            for(int depth_x = 0; depth_x < depth_intrin.width; ++depth_x, ++depth_pixel_index)
+            for(int x=0; x<columns; ++x)
             {
-                // Skip over depth pixels with the value of zero, we have no depth data so we will not write anything into our aligned images
-                if(float depth = get_depth(depth_pixel_index))
+                const float pixel[] = { x - 0.5f, y - 0.5f };
+                float point[3];
+                rs_deproject_pixel_to_point(point, &depth_intrin, pixel, 1.0f);
+                workspace.corner_x[y * columns + x] = point[0];
+                workspace.corner_y[y * columns + x] = point[1];
+            }
+        }
+        workspace.depth_intrin = depth_intrin;
+    }
+
+    // The kernels below project corners [i, n) at the given depths onto the other image, rounding to the nearest pixel, and return the index
+    // of the first corner they left over. The vectorized kernels evaluate the expressions of rsutil.h in the same order, so all levels agree.
+    static int project_corners_generic(int i, int n, int32_t * out_x, int32_t * out_y, const float * ray_x, const float * ray_y, const float * depth, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin)
+    {
+        for(; i < n; ++i)
+        {
+            const float depth_point[] = { depth[i] * ray_x[i], depth[i] * ray_y[i], depth[i] };
+            float other_point[3], other_pixel[2];
+            rs_transform_point_to_point(other_point, &depth_to_other, depth_point);
+            rs_project_point_to_pixel(other_pixel, &other_intrin, other_point);
+            out_x[i] = static_cast<int>(other_pixel[0] + 0.5f);
+            out_y[i] = static_cast<int>(other_pixel[1] + 0.5f);
+        }
+        return i;
+    }
+
+#ifdef RS_SIMD_X86
+    static RS_TARGET("ssse3") int project_corners_ssse3(int i, int n, int32_t * out_x, int32_t * out_y, const float * ray_x, const float * ray_y, const float * depth, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin)
+    {
+        const float * r = depth_to_other.rotation, * t = depth_to_other.translation, * k = other_intrin.coeffs;
+        const bool distort = other_intrin.model == RS_DISTORTION_MODIFIED_BROWN_CONRADY;
+        const __m128 one = _mm_set1_ps(1), two = _mm_set1_ps(2), half = _mm_set1_ps(0.5f);
+        for(; i + 4 <= n; i += 4)
+        {
+            __m128 d = _mm_loadu_ps(depth + i), p0 = _mm_mul_ps(d, _mm_loadu_ps(ray_x + i)), p1 = _mm_mul_ps(d, _mm_loadu_ps(ray_y + i));
+            __m128 o0 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[0]), p0), _mm_mul_ps(_mm_set1_ps(r[3]), p1)), _mm_mul_ps(_mm_set1_ps(r[6]), d)), _mm_set1_ps(t[0]));
+            __m128 o1 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[1]), p0), _mm_mul_ps(_mm_set1_ps(r[4]), p1)), _mm_mul_ps(_mm_set1_ps(r[7]), d)), _mm_set1_ps(t[1]));
+            __m128 o2 = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(r[2]), p0), _mm_mul_ps(_mm_set1_ps(r[5]), p1)), _mm_mul_ps(_mm_set1_ps(r[8]), d)), _mm_set1_ps(t[2]));
+            __m128 x = _mm_div_ps(o0, o2), y = _mm_div_ps(o1, o2);
+            if(distort)
+            {
+                __m128 r2 = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+                __m128 f = _mm_add_ps(_mm_add_ps(_mm_add_ps(one, _mm_mul_ps(_mm_set1_ps(k[0]), r2)), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(k[1]), r2), r2)), _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(k[4]), r2), r2), r2));
+                x = _mm_mul_ps(x, f);
+                y = _mm_mul_ps(y, f);
+                __m128 dx = _mm_add_ps(_mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2 * k[2]), x), y)), _mm_mul_ps(_mm_set1_ps(k[3]), _mm_add_ps(r2, _mm_mul_ps(_mm_mul_ps(two, x), x))));
+                __m128 dy = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2 * k[3]), x), y)), _mm_mul_ps(_mm_set1_ps(k[2]), _mm_add_ps(r2, _mm_mul_ps(_mm_mul_ps(two, y), y))));
+                x = dx;
+                y = dy;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out_x + i), _mm_cvttps_epi32(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(other_intrin.fx)), _mm_set1_ps(other_intrin.ppx)), half)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out_y + i), _mm_cvttps_epi32(_mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(other_intrin.fy)), _mm_set1_ps(other_intrin.ppy)), half)));
+        }
+        return i;
+    }
+
+    static RS_TARGET("avx2") int project_corners_avx2(int i, int n, int32_t * out_x, int32_t * out_y, const float * ray_x, const float * ray_y, const float * depth, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin)
+    {
+        const float * r = depth_to_other.rotation, * t = depth_to_other.translation, * k = other_intrin.coeffs;
+        const bool distort = other_intrin.model == RS_DISTORTION_MODIFIED_BROWN_CONRADY;
+        const __m256 one = _mm256_set1_ps(1), two = _mm256_set1_ps(2), half = _mm256_set1_ps(0.5f);
+        for(; i + 8 <= n; i += 8)
+        {
+            __m256 d = _mm256_loadu_ps(depth + i), p0 = _mm256_mul_ps(d, _mm256_loadu_ps(ray_x + i)), p1 = _mm256_mul_ps(d, _mm256_loadu_ps(ray_y + i));
+            __m256 o0 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(r[0]), p0), _mm256_mul_ps(_mm256_set1_ps(r[3]), p1)), _mm256_mul_ps(_mm256_set1_ps(r[6]), d)), _mm256_set1_ps(t[0]));
+            __m256 o1 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(r[1]), p0), _mm256_mul_ps(_mm256_set1_ps(r[4]), p1)), _mm256_mul_ps(_mm256_set1_ps(r[7]), d)), _mm256_set1_ps(t[1]));
+            __m256 o2 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(r[2]), p0), _mm256_mul_ps(_mm256_set1_ps(r[5]), p1)), _mm256_mul_ps(_mm256_set1_ps(r[8]), d)), _mm256_set1_ps(t[2]));
+            __m256 x = _mm256_div_ps(o0, o2), y = _mm256_div_ps(o1, o2);
+            if(distort)
+            {
+                __m256 r2 = _mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y));
+                __m256 f = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(one, _mm256_mul_ps(_mm256_set1_ps(k[0]), r2)), _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(k[1]), r2), r2)), _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(k[4]), r2), r2), r2));
+                x = _mm256_mul_ps(x, f);
+                y = _mm256_mul_ps(y, f);
+                __m256 dx = _mm256_add_ps(_mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(2 * k[2]), x), y)), _mm256_mul_ps(_mm256_set1_ps(k[3]), _mm256_add_ps(r2, _mm256_mul_ps(_mm256_mul_ps(two, x), x))));
+                __m256 dy = _mm256_add_ps(_mm256_add_ps(y, _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(2 * k[3]), x), y)), _mm256_mul_ps(_mm256_set1_ps(k[2]), _mm256_add_ps(r2, _mm256_mul_ps(_mm256_mul_ps(two, y), y))));
+                x = dx;
+                y = dy;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_x + i), _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(other_intrin.fx)), _mm256_set1_ps(other_intrin.ppx)), half)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_y + i), _mm256_cvttps_epi32(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, _mm256_set1_ps(other_intrin.fy)), _mm256_set1_ps(other_intrin.ppy)), half)));
+        }
+        return i;
+    }
+#endif
+
+    static void project_corners(int n, int32_t * out_x, int32_t * out_y, const float * ray_x, const float * ray_y, const float * depth, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin)
+    {
+        int i = 0;
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx2) i = project_corners_avx2(i, n, out_x, out_y, ray_x, ray_y, depth, depth_to_other, other_intrin);
+        if(level >= simd_level::ssse3) i = project_corners_ssse3(i, n, out_x, out_y, ray_x, ray_y, depth, depth_to_other, other_intrin);
+#endif
+        project_corners_generic(i, n, out_x, out_y, ray_x, ray_y, depth, depth_to_other, other_intrin);
+    }
+
+    // Maps every depth pixel with a nonzero depth onto the rectangle of other pixels it covers, and calls transfer_pixel for each pair.
+    // Projection is split into bands of depth rows. If TO_OTHER, transfer_pixel writes to the other pixel, and transfers are split into bands
+    // of other rows so that no two threads ever write the same pixel. Otherwise it writes to the depth pixel, and they follow the depth rows.
+    // Within each pixel, transfers happen in the same order as on a single thread, so the result never depends on the thread count.
+    // depth_pixels and depth_units (negated for disparity) identify the depth image for incremental alignment, depth_pixels may be null.
+    template<bool TO_OTHER, class GET_DEPTH, class TRANSFER_PIXEL> void align_images(alignment_workspace & workspace, const rs_intrinsics & depth_intrin, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin, 
+        const uint16_t * depth_pixels, float depth_units, GET_DEPTH get_depth, TRANSFER_PIXEL transfer_pixel)
+    {
+        const int width = depth_intrin.width, height = depth_intrin.height, columns = width + 1;
+        auto & rects = workspace.rects;
+        auto & previous_depth = workspace.previous_depth;
+
+        // The rectangles of the previous frame remain valid for unchanged depth pixels, as long as nothing else about the mapping changed
+        const bool incremental = workspace.incremental && depth_pixels;
+        const bool reuse = incremental && previous_depth.size() == rects.size() / 4 && workspace.depth_intrin == depth_intrin && workspace.depth_to_other == depth_to_other 
+            && workspace.other_intrin == other_intrin && workspace.depth_units == depth_units;
+        update_corner_rays(workspace, depth_intrin);
+        workspace.depth_to_other = depth_to_other;
+        workspace.other_intrin = other_intrin;
+        workspace.depth_units = depth_units;
+        rects.resize(width * height * 4);
+        previous_depth.resize(incremental ? width * height : 0);
+
+        // Find the rectangle each depth pixel covers in the other image, leaving an empty one for pixels without depth or outside the image.
+        // Incremental alignment compares the depth image with the previous one in blocks of a row, and only projects the blocks that changed.
+        const int block_width = incremental ? alignment_workspace::block_width : width;
+        auto project_rows = [&](int begin, int end)
+        {
+            std::vector<float> depth(block_width);
+            std::vector<int32_t> x0(block_width), y0(block_width), x1(block_width), y1(block_width);
+            for(int depth_y = begin; depth_y < end; ++depth_y)
+            {
+                for(int block_x = 0; block_x < width; block_x += block_width)
                 {
-                    // Map the top-left corner of the depth pixel onto the other image
-                    float depth_pixel[2] = {depth_x-0.5f, depth_y-0.5f}, depth_point[3], other_point[3], other_pixel[2];
-                    rs_deproject_pixel_to_point(depth_point, &depth_intrin, depth_pixel, depth);
-                    rs_transform_point_to_point(other_point, &depth_to_other, depth_point);
-                    rs_project_point_to_pixel(other_pixel, &other_intrin, other_point);
-                    const int other_x0 = static_cast<int>(other_pixel[0] + 0.5f);
-                    const int other_y0 = static_cast<int>(other_pixel[1] + 0.5f);
-
-                    // Map the bottom-right corner of the depth pixel onto the other image
-                    depth_pixel[0] = depth_x+0.5f; depth_pixel[1] = depth_y+0.5f;
-                    rs_deproject_pixel_to_point(depth_point, &depth_intrin, depth_pixel, depth);
-                    rs_transform_point_to_point(other_point, &depth_to_other, depth_point);
-                    rs_project_point_to_pixel(other_pixel, &other_intrin, other_point);
-                    const int other_x1 = static_cast<int>(other_pixel[0] + 0.5f);
-                    const int other_y1 = static_cast<int>(other_pixel[1] + 0.5f);
-
-                    if(other_x0 < 0 || other_y0 < 0 || other_x1 >= other_intrin.width || other_y1 >= other_intrin.height) continue;
-
-                    // Transfer between the depth pixels and the pixels inside the rectangle on the other image
-                    for(int y=other_y0; y<=other_y1; ++y) for(int x=other_x0; x<=other_x1; ++x) transfer_pixel(depth_pixel_index, y * other_intrin.width + x);
+                    const int block = depth_y * width + block_x, n = std::min(block_width, width - block_x);
+                    if(incremental)
+                    {
+                        if(reuse && std::equal(depth_pixels + block, depth_pixels + block + n, &previous_depth[block])) continue;
+                        std::copy_n(depth_pixels + block, n, &previous_depth[block]);
+                    }
+
+                    for(int i = 0; i < n; ++i) depth[i] = get_depth(block + i);
+                    const int top_left = depth_y * columns + block_x, bottom_right = (depth_y + 1) * columns + block_x + 1;
+                    project_corners(n, x0.data(), y0.data(), &workspace.corner_x[top_left], &workspace.corner_y[top_left], depth.data(), depth_to_other, other_intrin);
+                    project_corners(n, x1.data(), y1.data(), &workspace.corner_x[bottom_right], &workspace.corner_y[bottom_right], depth.data(), depth_to_other, other_intrin);
+
+                    auto rect = &rects[block * 4];
+                    for(int i = 0; i < n; ++i, rect += 4)
+                    {
+                        const bool valid = depth[i] != 0 && x0[i] >= 0 && y0[i] >= 0 && x1[i] < other_intrin.width && y1[i] < other_intrin.height;
+                        rect[0] = valid ? x0[i] : 1;
+                        rect[1] = valid ? y0[i] : 1;
+                        rect[2] = valid ? x1[i] : 0;
+                        rect[3] = valid ? y1[i] : 0;
+                    }
                 }
             }
-        }    
+        };
+
+        // Transfer between the depth pixels and the pixels inside their rectangles, restricted to other rows [other_begin, other_end)
+        auto transfer_rows = [&](int depth_begin, int depth_end, int other_begin, int other_end)
+        {
+            for(int depth_pixel_index = depth_begin * width; depth_pixel_index < depth_end * width; ++depth_pixel_index)
+            {
+                auto rect = &rects[depth_pixel_index * 4];
+                const int y_begin = std::max<int>(rect[1], other_begin), y_end = std::min<int>(rect[3] + 1, other_end);
+                for(int y = y_begin; y < y_end; ++y) for(int x = rect[0]; x <= rect[2]; ++x) transfer_pixel(depth_pixel_index, y * other_intrin.width + x);
+            }
+        };
+
+        if(workspace.pool)
+        {
+            workspace.pool->parallel_for(height, project_rows);
+            if(TO_OTHER) workspace.pool->parallel_for(other_intrin.height, [&](int begin, int end) { transfer_rows(0, height, begin, end); });
+            else workspace.pool->parallel_for(height, [&](int begin, int end) { transfer_rows(begin, end, 0, other_intrin.height); });
+        }
+        else
+        {
+            project_rows(0, height);
+            transfer_rows(0, height, 0, other_intrin.height);
+        }
     }
 
-    void align_z_to_other(byte * z_aligned_to_other, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin)
+    void align_z_to_other(byte * z_aligned_to_other, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin, alignment_workspace & workspace)
     {
         auto out_z = (uint16_t *)(z_aligned_to_other);
-        align_images(z_intrin, z_to_other, other_intrin, 
+        align_images<true>(workspace, z_intrin, z_to_other, other_intrin, z_pixels, z_scale,
             [z_pixels, z_scale](int z_pixel_index) { return z_scale * z_pixels[z_pixel_index]; },
             [out_z, z_pixels](int z_pixel_index, int other_pixel_index) { out_z[other_pixel_index] = out_z[other_pixel_index] ? std::min(out_z[other_pixel_index],z_pixels[z_pixel_index]) : z_pixels[z_pixel_index]; });
     }
 
-    void align_disparity_to_other(byte * disparity_aligned_to_other, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin)
+    void align_disparity_to_other(byte * disparity_aligned_to_other, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin, alignment_workspace & workspace)
     {
         auto out_disparity = (uint16_t *)(disparity_aligned_to_other);
-        align_images(disparity_intrin, disparity_to_other, other_intrin, 
+        align_images<true>(workspace, disparity_intrin, disparity_to_other, other_intrin, disparity_pixels, -disparity_scale,
             [disparity_pixels, disparity_scale](int disparity_pixel_index) { return disparity_scale / disparity_pixels[disparity_pixel_index]; },
             [out_disparity, disparity_pixels](int disparity_pixel_index, int other_pixel_index) { out_disparity[other_pixel_index] = disparity_pixels[disparity_pixel_index]; });
     }
 
+    void align_z_to_other(byte * z_aligned_to_other, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin)
+    {
+        alignment_workspace workspace;
+        align_z_to_other(z_aligned_to_other, z_pixels, z_scale, z_intrin, z_to_other, other_intrin, workspace);
+    }
+
+    void align_disparity_to_other(byte * disparity_aligned_to_other, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin)
+    {
+        alignment_workspace workspace;
+        align_disparity_to_other(disparity_aligned_to_other, disparity_pixels, disparity_scale, disparity_intrin, disparity_to_other, other_intrin, workspace);
+    }
+
     template<int N> struct bytes { char b[N]; };
-    template<int N, class GET_DEPTH> void align_other_to_depth_bytes(byte * other_aligned_to_depth, GET_DEPTH get_depth, const rs_intrinsics & depth_intrin, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels)
+    template<int N, class GET_DEPTH> void align_other_to_depth_bytes(byte * other_aligned_to_depth, const uint16_t * depth_pixels, float depth_units, GET_DEPTH get_depth, const rs_intrinsics & depth_intrin, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, alignment_workspace & workspace)
     {
         auto in_other = (const bytes<N> *)(other_pixels);
         auto out_other = (bytes<N> *)(other_aligned_to_depth);
-        align_images(depth_intrin, depth_to_other, other_intrin, get_depth,
+        align_images<false>(workspace, depth_intrin, depth_to_other, other_intrin, depth_pixels, depth_units, get_depth,
             [out_other, in_other](int depth_pixel_index, int other_pixel_index) { out_other[depth_pixel_index] = in_other[other_pixel_index]; });
     }
 
-    template<class GET_DEPTH> void align_other_to_depth(byte * other_aligned_to_depth, GET_DEPTH get_depth, const rs_intrinsics & depth_intrin, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format)
+    template<class GET_DEPTH> void align_other_to_depth(byte * other_aligned_to_depth, const uint16_t * depth_pixels, float depth_units, GET_DEPTH get_depth, const rs_intrinsics & depth_intrin, const rs_extrinsics & depth_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format, alignment_workspace & workspace)
     {
         switch(other_format)
         {
         case RS_FORMAT_Y8: 
-            align_other_to_depth_bytes<1>(other_aligned_to_depth, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels); break;
+            align_other_to_depth_bytes<1>(other_aligned_to_depth, depth_pixels, depth_units, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels, workspace); break;
         case RS_FORMAT_Y16: case RS_FORMAT_Z16: 
-            align_other_to_depth_bytes<2>(other_aligned_to_depth, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels); break;
+            align_other_to_depth_bytes<2>(other_aligned_to_depth, depth_pixels, depth_units, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels, workspace); break;
         case RS_FORMAT_RGB8: case RS_FORMAT_BGR8: 
-            align_other_to_depth_bytes<3>(other_aligned_to_depth, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels); break;
+            align_other_to_depth_bytes<3>(other_aligned_to_depth, depth_pixels, depth_units, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels, workspace); break;
         case RS_FORMAT_RGBA8: case RS_FORMAT_BGRA8: 
-            align_other_to_depth_bytes<4>(other_aligned_to_depth, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels); break;
+            align_other_to_depth_bytes<4>(other_aligned_to_depth, depth_pixels, depth_units, get_depth, depth_intrin, depth_to_other, other_intrin, other_pixels, workspace); break;
         default: 
             assert(false); // NOTE: rs_align_other_to_depth_bytes<2>(...) is not appropriate for RS_FORMAT_YUYV/RS_FORMAT_RAW10 images, no logic prevents U/V channels from being written to one another
         }
     }
 
+    void align_other_to_z(byte * other_aligned_to_z, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format, alignment_workspace & workspace)
+    {
+        align_other_to_depth(other_aligned_to_z, z_pixels, z_scale, [z_pixels, z_scale](int z_pixel_index) { return z_scale * z_pixels[z_pixel_index]; }, z_intrin, z_to_other, other_intrin, other_pixels, other_format, workspace);
+    }
+
+    void align_other_to_disparity(byte * other_aligned_to_disparity, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format, alignment_workspace & workspace)
+    {
+        align_other_to_depth(other_aligned_to_disparity, disparity_pixels, -disparity_scale, [disparity_pixels, disparity_scale](int disparity_pixel_index) { return disparity_scale / disparity_pixels[disparity_pixel_index]; }, disparity_intrin, disparity_to_other, other_intrin, other_pixels, other_format, workspace);
+    }
+
     void align_other_to_z(byte * other_aligned_to_z, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format)
     {
-        align_other_to_depth(other_aligned_to_z, [z_pixels, z_scale](int z_pixel_index) { return z_scale * z_pixels[z_pixel_index]; }, z_intrin, z_to_other, other_intrin, other_pixels, other_format);
+        alignment_workspace workspace;
+        align_other_to_z(other_aligned_to_z, z_pixels, z_scale, z_intrin, z_to_other, other_intrin, other_pixels, other_format, workspace);
     }
 
     void align_other_to_disparity(byte * other_aligned_to_disparity, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format)
     {
-        align_other_to_depth(other_aligned_to_disparity, [disparity_pixels, disparity_scale](int disparity_pixel_index) { return disparity_scale / disparity_pixels[disparity_pixel_index]; }, disparity_intrin, disparity_to_other, other_intrin, other_pixels, other_format);
+        alignment_workspace workspace;
+        align_other_to_disparity(other_aligned_to_disparity, disparity_pixels, disparity_scale, disparity_intrin, disparity_to_other, other_intrin, other_pixels, other_format, workspace);
     }
 
     /////////////////////////
     // Image rectification //
     /////////////////////////
 
-    std::vector<int> compute_rectification_table(const rs_intrinsics & rect_intrin, const rs_extrinsics & rect_to_unrect, const rs_intrinsics & unrect_intrin)
-    {   
-        std::vector<int> rectification_table;
-        rectification_table.resize(rect_intrin.width * rect_intrin.height);
-        align_images(rect_intrin, rect_to_unrect, unrect_intrin, [](int) { return 1.0f; },
-            [&rectification_table](int rect_pixel_index, int unrect_pixel_index) { rectification_table[rect_pixel_index] = unrect_pixel_index; });
-        return rectification_table;
+    rectification_table compute_rectification_table(const rs_intrinsics & rect_intrin, const rs_extrinsics & rect_to_unrect, const rs_intrinsics & unrect_intrin, bool bilinear)
+    {
+        rectification_table table;
+        table.rect_intrin = rect_intrin;
+        table.rect_to_unrect = rect_to_unrect;
+        table.unrect_intrin = unrect_intrin;
+        table.bilinear = bilinear;
+        table.index.resize(rect_intrin.width * rect_intrin.height);
+        if(bilinear) table.fraction.resize(rect_intrin.width * rect_intrin.height);
+
+        auto index = table.index.data();
+        auto fraction = table.fraction.data();
+        for(int y = 0; y < rect_intrin.height; ++y)
+        {
+            for(int x = 0; x < rect_intrin.width; ++x, ++index, fraction += bilinear)
+            {
+                const float rect_pixel[] = { (float)x, (float)y };
+                float rect_point[3], unrect_point[3], unrect_pixel[2];
+                rs_deproject_pixel_to_point(rect_point, &rect_intrin, rect_pixel, 1);
+                rs_transform_point_to_point(unrect_point, &rect_to_unrect, rect_point);
+                rs_project_point_to_pixel(unrect_pixel, &unrect_intrin, unrect_point);
+
+                // Centers within half a pixel of the border sample the border pixels, as nearest neighbour sampling would
+                if(!(unrect_pixel[0] >= -0.5f && unrect_pixel[0] < unrect_intrin.width - 0.5f && unrect_pixel[1] >= -0.5f && unrect_pixel[1] < unrect_intrin.height - 0.5f))
+                {
+                    *index = -1;
+                    if(bilinear) *fraction = 0;
+                    continue;
+                }
+                const float unrect_x = std::min(std::max(unrect_pixel[0], 0.0f), unrect_intrin.width - 1.0f), unrect_y = std::min(std::max(unrect_pixel[1], 0.0f), unrect_intrin.height - 1.0f);
+                if(!bilinear)
+                {
+                    *index = static_cast<int>(unrect_y + 0.5f) * unrect_intrin.width + static_cast<int>(unrect_x + 0.5f);
+                    continue;
+                }
+                const int x0 = std::min(static_cast<int>(unrect_x), unrect_intrin.width - 2), y0 = std::min(static_cast<int>(unrect_y), unrect_intrin.height - 2);
+                const int fraction_x = static_cast<int>((unrect_x - x0) * rectification_table::fraction_one + 0.5f), fraction_y = static_cast<int>((unrect_y - y0) * rectification_table::fraction_one + 0.5f);
+                *index = y0 * unrect_intrin.width + x0;
+                *fraction = static_cast<uint16_t>(fraction_x | fraction_y << 8);
+            }
+        }
+        return table;
     }
 
-    template<class T> void rectify_image_pixels(T * rect_pixels, const std::vector<int> & rectification_table, const T * unrect_pixels)
+    // The kernels below rectify pixels [i, n) and return the index of the first pixel they left over. Each channel is interpolated in
+    // fixed point as (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11 + 2^13) >> 14, with weights summing to 2^14, so all kernels agree.
+    template<class T, int C> int rectify_pixels_bilinear(int i, int n, T * rect_pixels, const rectification_table & table, const T * unrect_pixels)
     {
-        for(auto entry : rectification_table) *rect_pixels++ = unrect_pixels[entry];
+        const int one = rectification_table::fraction_one, stride = table.unrect_intrin.width * C;
+        for(; i < n; ++i)
+        {
+            auto out = rect_pixels + i * C;
+            if(table.index[i] < 0)
+            {
+                std::fill_n(out, C, 0);
+                continue;
+            }
+            auto top = unrect_pixels + table.index[i] * C, bottom = top + stride;
+            const int fx = table.fraction[i] & 0xFF, fy = table.fraction[i] >> 8;
+            const int w00 = (one - fx) * (one - fy), w01 = fx * (one - fy), w10 = (one - fx) * fy, w11 = fx * fy;
+            for(int c = 0; c < C; ++c) out[c] = static_cast<T>((top[c] * w00 + top[C + c] * w01 + bottom[c] * w10 + bottom[C + c] * w11 + 8192) >> 14);
+        }
+        return i;
     }
 
-    void rectify_image(uint8_t * rect_pixels, const std::vector<int> & rectification_table, const uint8_t * unrect_pixels, rs_format format)
+#ifdef RS_SIMD_X86
+    // Computes the weights of 8 pixels, packed as w00 | w01 << 16 and w10 | w11 << 16, so that _mm256_madd_epi16 blends a pair in one step
+    static RS_TARGET("avx2") void bilinear_weights_avx2(const uint16_t * fraction, __m256i & top_weights, __m256i & bottom_weights)
     {
-        switch(format)
+        const __m256i one = _mm256_set1_epi32(rectification_table::fraction_one);
+        const __m256i f = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(fraction)));
+        const __m256i fx = _mm256_and_si256(f, _mm256_set1_epi32(0xFF)), fy = _mm256_srli_epi32(f, 8);
+        const __m256i ifx = _mm256_sub_epi32(one, fx), ify = _mm256_sub_epi32(one, fy);
+        top_weights = _mm256_or_si256(_mm256_mullo_epi16(ifx, ify), _mm256_slli_epi32(_mm256_mullo_epi16(fx, ify), 16));
+        bottom_weights = _mm256_or_si256(_mm256_mullo_epi16(ifx, fy), _mm256_slli_epi32(_mm256_mullo_epi16(fx, fy), 16));
+    }
+
+    // Gathers both pixels of each row pair of C channels with one 64-bit read, the bottom one starting 8 - 2 * C bytes early so as not to
+    // read past the image. Each 64-bit gather covers pixels { 0, 1, 4, 5 } or { 2, 3, 6, 7 }, so that every 128-bit lane of the result
+    // holds 4 consecutive pixels.
+    template<int C> static RS_TARGET("avx2") int rectify_bytes_bilinear_avx2(int i, int n, uint8_t * rect_pixels, const rectification_table & table, const uint8_t * unrect_pixels)
+    {
+        const auto base = reinterpret_cast<const long long *>(unrect_pixels);
+        const int bias = 8 - 2 * C;
+        const __m128i down = _mm_set1_epi32(table.unrect_intrin.width * C - bias);
+        const __m256i round = _mm256_set1_epi32(8192), zero = _mm256_setzero_si256();
+
+        // Spread channels { 0, 1 } or { 2, 3 } of both pixels in each 128-bit lane into 16-bit pairs of the left and right pixel
+        int8_t pairs[2][2][32];
+        for(int row = 0; row < 2; ++row) for(int half = 0; half < 2; ++half) for(int b = 0; b < 32; ++b)
+        {
+            const int pixel = b / 4 % 2, channel = half * 2 + b / 8 % 2, source = pixel * 8 + row * bias + channel + (b % 4 == 2 ? C : 0);
+            pairs[row][half][b] = channel < C && b % 2 == 0 ? static_cast<int8_t>(source) : -1;
+        }
+        const __m256i top01 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pairs[0][0])), top23 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pairs[0][1]));
+        const __m256i bottom01 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pairs[1][0])), bottom23 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pairs[1][1]));
+
+        // After packing, each lane holds channels in the order { c0 c0' c1 c1' c2 c2' c3 c3' } for two pairs of pixels
+        const __m256i pack = C == 4 ? _mm256_setr_epi8(0,2,4,6, 1,3,5,7, 8,10,12,14, 9,11,13,15, 0,2,4,6, 1,3,5,7, 8,10,12,14, 9,11,13,15)
+                                    : _mm256_setr_epi8(0,2,4, 1,3,5, 8,10,12, 9,11,13, -1,-1,-1,-1, 0,2,4, 1,3,5, 8,10,12, 9,11,13, -1,-1,-1,-1);
+        for(; i + 8 <= n; i += 8)
+        {
+            const __m256i index = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(&table.index[i])), _mm256_setr_epi32(0,1,4,5,2,3,6,7));
+            const __m256i valid = _mm256_cmpgt_epi32(index, _mm256_set1_epi32(-1));
+            const __m256i offset = C == 3 ? _mm256_add_epi32(index, _mm256_slli_epi32(index, 1)) : _mm256_slli_epi32(index, 2);
+
+            __m256i top_weights, bottom_weights;
+            bilinear_weights_avx2(&table.fraction[i], top_weights, bottom_weights);
+
+            __m256i sums[2];
+            for(int g = 0; g < 2; ++g)
+            {
+                const __m128i group_offset = g ? _mm256_extracti128_si256(offset, 1) : _mm256_castsi256_si128(offset);
+                const __m256i group_valid = _mm256_cvtepi32_epi64(g ? _mm256_extracti128_si256(valid, 1) : _mm256_castsi256_si128(valid));
+                const __m256i top = _mm256_mask_i32gather_epi64(zero, base, group_offset, group_valid, 1);
+                const __m256i bottom = _mm256_mask_i32gather_epi64(zero, base, _mm_add_epi32(group_offset, down), group_valid, 1);
+                const __m256i select = g ? _mm256_setr_epi32(2,3,2,3,6,7,6,7) : _mm256_setr_epi32(0,1,0,1,4,5,4,5);
+                const __m256i tw = _mm256_permutevar8x32_epi32(top_weights, select), bw = _mm256_permutevar8x32_epi32(bottom_weights, select);
+                const __m256i sum01 = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(top, top01), tw), _mm256_madd_epi16(_mm256_shuffle_epi8(bottom, bottom01), bw)), round);
+                const __m256i sum23 = _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(top, top23), tw), _mm256_madd_epi16(_mm256_shuffle_epi8(bottom, bottom23), bw)), round);
+                sums[g] = _mm256_packus_epi32(_mm256_srli_epi32(sum01, 14), _mm256_srli_epi32(sum23, 14));
+            }
+            const __m256i packed = _mm256_shuffle_epi8(_mm256_packus_epi16(sums[0], sums[1]), pack);
+
+            auto out = rect_pixels + i * C;
+            if(C == 4) _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), packed);
+            else
+            {
+                const __m256i contiguous = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0,1,2,4,5,6,3,7));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(contiguous));
+                _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 16), _mm256_extracti128_si256(contiguous, 1));
+            }
+        }
+        return i;
+    }
+
+    // A single channel gathers both pixels of each row pair with one 32-bit read, the bottom one starting two bytes early so as not to read past the image
+    template<> RS_TARGET("avx2") int rectify_bytes_bilinear_avx2<1>(int i, int n, uint8_t * rect_pixels, const rectification_table & table, const uint8_t * unrect_pixels)
+    {
+        const auto base = reinterpret_cast<const int *>(unrect_pixels);
+        const __m256i down = _mm256_set1_epi32(table.unrect_intrin.width - 2), round = _mm256_set1_epi32(8192), zero = _mm256_setzero_si256();
+        const __m256i top_pair = _mm256_setr_epi8(0,-1,1,-1, 4,-1,5,-1, 8,-1,9,-1, 12,-1,13,-1, 0,-1,1,-1, 4,-1,5,-1, 8,-1,9,-1, 12,-1,13,-1);
+        const __m256i bottom_pair = _mm256_setr_epi8(2,-1,3,-1, 6,-1,7,-1, 10,-1,11,-1, 14,-1,15,-1, 2,-1,3,-1, 6,-1,7,-1, 10,-1,11,-1, 14,-1,15,-1);
+        const __m256i pack = _mm256_setr_epi8(0,4,8,12,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, 0,4,8,12,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1);
+        for(; i + 8 <= n; i += 8)
+        {
+            const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&table.index[i]));
+            const __m256i valid = _mm256_cmpgt_epi32(index, _mm256_set1_epi32(-1));
+            const __m256i top = _mm256_mask_i32gather_epi32(zero, base, index, valid, 1);
+            const __m256i bottom = _mm256_mask_i32gather_epi32(zero, base, _mm256_add_epi32(index, down), valid, 1);
+
+            __m256i top_weights, bottom_weights;
+            bilinear_weights_avx2(&table.fraction[i], top_weights, bottom_weights);
+            __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(top, top_pair), top_weights), _mm256_madd_epi16(_mm256_shuffle_epi8(bottom, bottom_pair), bottom_weights));
+            sum = _mm256_srli_epi32(_mm256_add_epi32(sum, round), 14);
+
+            const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(sum, pack), _mm256_setr_epi32(0,4,1,5,2,6,3,7));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(rect_pixels + i), _mm256_castsi256_si128(packed));
+        }
+        return i;
+    }
+#endif
+
+    template<int C> void rectify_bytes_bilinear(uint8_t * rect_pixels, const rectification_table & table, const uint8_t * unrect_pixels)
+    {
+        const int n = static_cast<int>(table.index.size());
+        int i = 0;
+#ifdef RS_SIMD_X86
+        if(get_simd_level() >= simd_level::avx2) i = rectify_bytes_bilinear_avx2<C>(i, n, rect_pixels, table, unrect_pixels);
+#endif
+        rectify_pixels_bilinear<uint8_t, C>(i, n, rect_pixels, table, unrect_pixels);
+    }
+
+    template<class T> void rectify_pixels_nearest(T * rect_pixels, const rectification_table & table, const T * unrect_pixels)
+    {
+        for(auto entry : table.index) *rect_pixels++ = entry < 0 ? T() : unrect_pixels[entry];
+    }
+
+    // Depth is not interpolated, as blending across an edge would invent points between the foreground and the background
+    void rectify_depth_nearest(uint16_t * rect_pixels, const rectification_table & table, const uint16_t * unrect_pixels)
+    {
+        const int half = rectification_table::fraction_one / 2, stride = table.unrect_intrin.width;
+        for(size_t i = 0; i < table.index.size(); ++i)
+        {
+            if(table.index[i] < 0) rect_pixels[i] = 0;
+            else rect_pixels[i] = unrect_pixels[table.index[i] + ((table.fraction[i] & 0xFF) >= half) + ((table.fraction[i] >> 8) >= half) * stride];
+        }
+    }
+
+    void rectify_image(uint8_t * rect_pixels, const rectification_table & table, const uint8_t * unrect_pixels, rs_format format)
+    {
+        if(!table.bilinear) switch(format)
         {
         case RS_FORMAT_Y8: 
-            return rectify_image_pixels((bytes<1> *)rect_pixels, rectification_table, (const bytes<1> *)unrect_pixels);
+            return rectify_pixels_nearest((bytes<1> *)rect_pixels, table, (const bytes<1> *)unrect_pixels);
         case RS_FORMAT_Y16: case RS_FORMAT_Z16: 
-            return rectify_image_pixels((bytes<2> *)rect_pixels, rectification_table, (const bytes<2> *)unrect_pixels);
+            return rectify_pixels_nearest((bytes<2> *)rect_pixels, table, (const bytes<2> *)unrect_pixels);
+        case RS_FORMAT_RGB8: case RS_FORMAT_BGR8: 
+            return rectify_pixels_nearest((bytes<3> *)rect_pixels, table, (const bytes<3> *)unrect_pixels);
+        case RS_FORMAT_RGBA8: case RS_FORMAT_BGRA8: 
+            return rectify_pixels_nearest((bytes<4> *)rect_pixels, table, (const bytes<4> *)unrect_pixels);
+        default: 
+            assert(false); // NOTE: rectify_image(...) is not appropriate for RS_FORMAT_YUYV images, no logic prevents U/V channels from being written to one another
+            return;
+        }
+
+        switch(format)
+        {
+        case RS_FORMAT_Y8: 
+            return rectify_bytes_bilinear<1>(rect_pixels, table, unrect_pixels);
+        case RS_FORMAT_Y16: 
+            rectify_pixels_bilinear<uint16_t, 1>(0, static_cast<int>(table.index.size()), (uint16_t *)rect_pixels, table, (const uint16_t *)unrect_pixels); return;
+        case RS_FORMAT_Z16: 
+            return rectify_depth_nearest((uint16_t *)rect_pixels, table, (const uint16_t *)unrect_pixels);
         case RS_FORMAT_RGB8: case RS_FORMAT_BGR8: 
-            return rectify_image_pixels((bytes<3> *)rect_pixels, rectification_table, (const bytes<3> *)unrect_pixels);
+            return rectify_bytes_bilinear<3>(rect_pixels, table, unrect_pixels);
         case RS_FORMAT_RGBA8: case RS_FORMAT_BGRA8: 
-            return rectify_image_pixels((bytes<4> *)rect_pixels, rectification_table, (const bytes<4> *)unrect_pixels);
+            return rectify_bytes_bilinear<4>(rect_pixels, table, unrect_pixels);
         default: 
-            assert(false); // NOTE: rectify_image_pixels(...) is not appropriate for RS_FORMAT_YUYV images, no logic prevents U/V channels from being written to one another
+            assert(false); // NOTE: rectify_image(...) is not appropriate for RS_FORMAT_YUYV images, interpolation would blend the U and V channels into one another
         }
     }
 }
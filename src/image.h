@@ -15,6 +15,68 @@ namespace rsimpl
     void             deproject_z                    (float * points, const rs_intrinsics & z_intrin, const uint16_t * z_pixels, float z_scale);
     void             deproject_disparity            (float * points, const rs_intrinsics & disparity_intrin, const uint16_t * disparity_pixels, float disparity_scale);
 
+    // Batched versions of rs_project_point_to_pixel(), rs_deproject_pixel_to_point() and rs_transform_point_to_point(), which support every
+    // distortion model in both directions. Consecutive coordinates of each array are stride floats apart.
+    void             project_points_to_pixels       (float * pixel_x, float * pixel_y, int pixel_stride, const rs_intrinsics & intrin, 
+                                                     const float * point_x, const float * point_y, const float * point_z, int point_stride, int count);
+    void             deproject_pixels_to_points     (float * point_x, float * point_y, float * point_z, int point_stride, const rs_intrinsics & intrin, 
+                                                     const float * pixel_x, const float * pixel_y, int pixel_stride, const float * depth, int count);
+    void             transform_points_to_points     (float * to_x, float * to_y, float * to_z, int to_stride, const rs_extrinsics & extrin, 
+                                                     const float * from_x, const float * from_y, const float * from_z, int from_stride, int count);
+
+    // The same on n contiguous coordinates, which other processing feeds through blocks of projection_block_size. The output may alias the input.
+    // These are built in projection.cpp, with the floating point flags that keep every instruction set bit-identical.
+    enum { projection_block_size = 256 };
+    void             project_points                 (int n, float * pixel_x, float * pixel_y, const rs_intrinsics & intrin, const float * point_x, const float * point_y, const float * point_z);
+    void             deproject_pixels               (int n, float * point_x, float * point_y, float * point_z, const rs_intrinsics & intrin, const float * pixel_x, const float * pixel_y, const float * depth);
+    void             transform_points               (int n, float * to_x, float * to_y, float * to_z, const rs_extrinsics & extrin, const float * from_x, const float * from_y, const float * from_z);
+
+    std::vector<float> compute_deprojection_table   (const rs_intrinsics & intrin);
+    void             deproject_z                    (float * points, const std::vector<float> & deprojection_table, const uint16_t * z_pixels, float z_scale);
+    void             deproject_disparity            (float * points, const std::vector<float> & deprojection_table, const uint16_t * disparity_pixels, float disparity_scale);
+
+    // Compact point clouds hold only the points of pixels with depth, in the order of the pixels. The deprojection returns how many there were,
+    // find_valid_pixels() lists their indices into the image, and compute_texture_coordinates() finds where each lands in a texture, from 0 to 1.
+    int              deproject_z_compact            (float * points, const std::vector<float> & deprojection_table, const uint16_t * z_pixels, float z_scale);
+    int              deproject_disparity_compact    (float * points, const std::vector<float> & deprojection_table, const uint16_t * disparity_pixels, float disparity_scale);
+    void             find_valid_pixels              (int * indices, const uint16_t * depth_pixels, int count);
+    void             compute_texture_coordinates    (float * uv, const float * points, int count, const rs_extrinsics & points_to_texture, const rs_intrinsics & texture_intrin);
+
+    // Deprojects every pixel to an RS_FORMAT_XYZRGB point, colored from an RS_FORMAT_RGB8, BGR8, RGBA8, BGRA8 or Y8 image
+    void             deproject_z_colored            (byte * colored_points, const std::vector<float> & deprojection_table, const uint16_t * z_pixels, float z_scale, 
+                                                     const rs_extrinsics & z_to_color, const rs_intrinsics & color_intrin, const byte * color_pixels, rs_format color_format);
+    void             deproject_disparity_colored    (byte * colored_points, const std::vector<float> & deprojection_table, const uint16_t * disparity_pixels, float disparity_scale, 
+                                                     const rs_extrinsics & disparity_to_color, const rs_intrinsics & color_intrin, const byte * color_pixels, rs_format color_format);
+
+    // Converts count coordinates of a point cloud in meters to the RS_FORMAT_XYZ16F and RS_FORMAT_XYZ16 formats
+    void             convert_points_to_xyz16f       (uint16_t * dest, const float * points, int count);
+    void             convert_points_to_xyz16        (int16_t * dest, const float * points, int count);
+
+    // State kept by the alignment functions from one frame to the next: the rays through the corners of every depth pixel, which are
+    // recomputed only when the depth intrinsics change, and the rectangle of other pixels each depth pixel covers. If pool is set, the
+    // work is split across its threads, without changing the result. If incremental is set, the rectangles are only recomputed for
+    // blocks of block_width depth pixels which differ from the previous depth image, which suits cameras looking at static scenes.
+    struct alignment_workspace
+    {
+        enum { block_width = 32 };
+        rs_intrinsics depth_intrin = {}, other_intrin = {};
+        rs_extrinsics depth_to_other = {};
+        float depth_units = 0;
+        std::vector<float> corner_x, corner_y;
+        std::vector<int16_t> rects;
+        std::vector<uint16_t> previous_depth;
+        worker_pool * pool = nullptr;
+        bool incremental = false;
+    };
+
+    void             align_z_to_other               (byte * z_aligned_to_other, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, 
+                                                     const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin, alignment_workspace & workspace);
+    void             align_disparity_to_other       (byte * disparity_aligned_to_other, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, 
+                                                     const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin, alignment_workspace & workspace);
+    void             align_other_to_z               (byte * other_aligned_to_z, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, 
+                                                     const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format, alignment_workspace & workspace);
+    void             align_other_to_disparity       (byte * other_aligned_to_disparity, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, 
+                                                     const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format, alignment_workspace & workspace);
     void             align_z_to_other               (byte * z_aligned_to_other, const uint16_t * z_pixels, float z_scale, const rs_intrinsics & z_intrin, 
                                                      const rs_extrinsics & z_to_other, const rs_intrinsics & other_intrin);
     void             align_disparity_to_other       (byte * disparity_aligned_to_other, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, 
@@ -24,8 +86,21 @@ namespace rsimpl
     void             align_other_to_disparity       (byte * other_aligned_to_disparity, const uint16_t * disparity_pixels, float disparity_scale, const rs_intrinsics & disparity_intrin, 
                                                      const rs_extrinsics & disparity_to_other, const rs_intrinsics & other_intrin, const byte * other_pixels, rs_format other_format);
 
-    std::vector<int> compute_rectification_table    (const rs_intrinsics & rect_intrin, const rs_extrinsics & rect_to_unrect, const rs_intrinsics & unrect_intrin);
-    void             rectify_image                  (uint8_t * rect_pixels, const std::vector<int> & rectification_table, const uint8_t * unrect_pixels, rs_format format);
+    // Maps each rectified pixel to the unrectified pixel nearest to the point it sees, or to -1 if that point lies outside the unrectified image.
+    // Bilinear tables map it to the top-left of the 2x2 unrectified pixels around the point instead, and keep the position of the point between
+    // them in fraction, in 1/128ths of a pixel, x in the low byte. Depth is sampled at the nearest pixel either way.
+    struct rectification_table
+    {
+        enum { fraction_one = 128 };
+        rs_intrinsics rect_intrin, unrect_intrin;
+        rs_extrinsics rect_to_unrect;
+        bool bilinear;
+        std::vector<int32_t> index;
+        std::vector<uint16_t> fraction; // Empty unless bilinear
+    };
+
+    rectification_table compute_rectification_table (const rs_intrinsics & rect_intrin, const rs_extrinsics & rect_to_unrect, const rs_intrinsics & unrect_intrin, bool bilinear);
+    void             rectify_image                  (uint8_t * rect_pixels, const rectification_table & table, const uint8_t * unrect_pixels, rs_format format);
 
     extern const native_pixel_format pf_raw8;       // Four 8 bit luminance
     extern const native_pixel_format pf_rw10;       // Four 10 bit luminance values in one 40 bit macropixel
@@ -0,0 +1,333 @@
+// License: Apache 2.0. See LICENSE file in root directory.
+// Copyright(c) 2015 Intel Corporation. All Rights Reserved.
+
+#include "image.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#ifdef RS_SIMD_X86
+#include <immintrin.h> // For the SSSE3 and AVX2 intrinsics used by the projection kernels
+#endif
+
+namespace rsimpl
+{
+    // Lanes of floats, so that the projection math below is written once for scalar code and for each instruction set. Comparisons produce
+    // masks for select(). Every operation rounds like its scalar counterpart, so all instruction sets produce identical results, as long as
+    // the compiler neither reassociates, estimates nor contracts into fused multiply-adds. CMakeLists.txt builds this file to that effect.
+    struct f32x1
+    {
+        enum { size = 1 };
+        float v;
+        f32x1(float v) : v(v) {}
+        static f32x1 load(const float * p) { return *p; }
+        void store(float * p) const { *p = v; }
+    };
+    inline f32x1 operator + (f32x1 a, f32x1 b) { return a.v + b.v; }
+    inline f32x1 operator - (f32x1 a, f32x1 b) { return a.v - b.v; }
+    inline f32x1 operator * (f32x1 a, f32x1 b) { return a.v * b.v; }
+    inline f32x1 operator / (f32x1 a, f32x1 b) { return a.v / b.v; }
+    inline bool operator > (f32x1 a, f32x1 b) { return a.v > b.v; }
+    inline f32x1 select(bool mask, f32x1 a, f32x1 b) { return mask ? a : b; }
+    inline f32x1 sqrt(f32x1 a) { return std::sqrt(a.v); }
+    inline f32x1 max(f32x1 a, f32x1 b) { return a.v > b.v ? a : b; }
+
+#ifdef RS_SIMD_X86
+    struct f32x4
+    {
+        enum { size = 4 };
+        __m128 v;
+        RS_TARGET("ssse3") f32x4(__m128 v) : v(v) {}
+        RS_TARGET("ssse3") f32x4(float v) : v(_mm_set1_ps(v)) {}
+        static RS_TARGET("ssse3") f32x4 load(const float * p) { return _mm_loadu_ps(p); }
+        RS_TARGET("ssse3") void store(float * p) const { _mm_storeu_ps(p, v); }
+    };
+    inline RS_TARGET("ssse3") f32x4 operator + (f32x4 a, f32x4 b) { return _mm_add_ps(a.v, b.v); }
+    inline RS_TARGET("ssse3") f32x4 operator - (f32x4 a, f32x4 b) { return _mm_sub_ps(a.v, b.v); }
+    inline RS_TARGET("ssse3") f32x4 operator * (f32x4 a, f32x4 b) { return _mm_mul_ps(a.v, b.v); }
+    inline RS_TARGET("ssse3") f32x4 operator / (f32x4 a, f32x4 b) { return _mm_div_ps(a.v, b.v); }
+    inline RS_TARGET("ssse3") f32x4 operator > (f32x4 a, f32x4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+    inline RS_TARGET("ssse3") f32x4 select(f32x4 mask, f32x4 a, f32x4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+    inline RS_TARGET("ssse3") f32x4 sqrt(f32x4 a) { return _mm_sqrt_ps(a.v); }
+    inline RS_TARGET("ssse3") f32x4 max(f32x4 a, f32x4 b) { return _mm_max_ps(a.v, b.v); }
+
+    struct f32x8
+    {
+        enum { size = 8 };
+        __m256 v;
+        RS_TARGET("avx2") f32x8(__m256 v) : v(v) {}
+        RS_TARGET("avx2") f32x8(float v) : v(_mm256_set1_ps(v)) {}
+        static RS_TARGET("avx2") f32x8 load(const float * p) { return _mm256_loadu_ps(p); }
+        RS_TARGET("avx2") void store(float * p) const { _mm256_storeu_ps(p, v); }
+    };
+    inline RS_TARGET("avx2") f32x8 operator + (f32x8 a, f32x8 b) { return _mm256_add_ps(a.v, b.v); }
+    inline RS_TARGET("avx2") f32x8 operator - (f32x8 a, f32x8 b) { return _mm256_sub_ps(a.v, b.v); }
+    inline RS_TARGET("avx2") f32x8 operator * (f32x8 a, f32x8 b) { return _mm256_mul_ps(a.v, b.v); }
+    inline RS_TARGET("avx2") f32x8 operator / (f32x8 a, f32x8 b) { return _mm256_div_ps(a.v, b.v); }
+    inline RS_TARGET("avx2") f32x8 operator > (f32x8 a, f32x8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+    inline RS_TARGET("avx2") f32x8 select(f32x8 mask, f32x8 a, f32x8 b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+    inline RS_TARGET("avx2") f32x8 sqrt(f32x8 a) { return _mm256_sqrt_ps(a.v); }
+    inline RS_TARGET("avx2") f32x8 max(f32x8 a, f32x8 b) { return _mm256_max_ps(a.v, b.v); }
+#endif
+
+    // Single precision arctangent of x >= 0 and tangent of 0 <= x < pi/2, after the Cephes library's atanf() and tanf()
+    template<class V> RS_ALWAYS_INLINE V atan_lanes(V x)
+    {
+        const auto above = x > 2.414213562373095f, middle = x > 0.4142135623730950f;
+        const V offset = select(above, V(1.570796326794897f), select(middle, V(0.7853981633974483f), V(0.0f)));
+        x = select(above, 0.0f - 1.0f / x, select(middle, (x - 1.0f) / (x + 1.0f), x));
+        const V z = x * x;
+        return offset + (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * x + x;
+    }
+
+    template<class V> RS_ALWAYS_INLINE V tan_lanes(V x)
+    {
+        const auto reflect = x > 0.7853981633974483f; // tan(x) = -1 / tan(x - pi/2), pi/2 being subtracted in three parts to keep precision
+        const V z = select(reflect, ((x - 2 * 0.78515625f) - 2 * 2.4187564849853515625e-4f) - 2 * 3.77489497744594108e-8f, x), zz = z * z;
+        const V y = ((((((9.38540185543e-3f * zz + 3.11992232697e-3f) * zz + 2.44301354525e-2f) * zz + 5.34112807005e-2f) * zz + 1.33387994085e-1f) * zz + 3.33331568548e-1f) * zz * z) + z;
+        return select(reflect, 0.0f - 1.0f / y, y);
+    }
+
+    // The distortion models in the direction rsutil.h supports them, written exactly as there so that the results are identical
+    template<class V> RS_ALWAYS_INLINE void distort_modified_brown_conrady(V & x, V & y, const float * k)
+    {
+        V r2 = x*x + y*y;
+        V f = 1 + k[0]*r2 + k[1]*r2*r2 + k[4]*r2*r2*r2;
+        x = x * f;
+        y = y * f;
+        V dx = x + 2*k[2]*x*y + k[3]*(r2 + 2*x*x);
+        V dy = y + 2*k[3]*x*y + k[2]*(r2 + 2*y*y);
+        x = dx;
+        y = dy;
+    }
+
+    template<class V> RS_ALWAYS_INLINE void undistort_inverse_brown_conrady(V & x, V & y, const float * k)
+    {
+        V r2 = x*x + y*y;
+        V f = 1 + k[0]*r2 + k[1]*r2*r2 + k[4]*r2*r2*r2;
+        V ux = x*f + 2*k[2]*x*y + k[3]*(r2 + 2*x*x);
+        V uy = y*f + 2*k[3]*x*y + k[2]*(r2 + 2*y*y);
+        x = ux;
+        y = uy;
+    }
+
+    // The opposite directions have no closed form, and are solved by fixed-point iteration from the point itself
+    enum { brown_conrady_iterations = 10 };
+
+    template<class V> RS_ALWAYS_INLINE void undistort_modified_brown_conrady(V & x, V & y, const float * k)
+    {
+        V ux = x, uy = y;
+        for(int i = 0; i < brown_conrady_iterations; ++i)
+        {
+            V r2 = ux*ux + uy*uy;
+            V f = 1 + k[0]*r2 + k[1]*r2*r2 + k[4]*r2*r2*r2;
+            V sx = ux*f, sy = uy*f;
+            ux = (x - (2*k[2]*sx*sy + k[3]*(r2 + 2*sx*sx))) / f;
+            uy = (y - (2*k[3]*sx*sy + k[2]*(r2 + 2*sy*sy))) / f;
+        }
+        x = ux;
+        y = uy;
+    }
+
+    template<class V> RS_ALWAYS_INLINE void distort_inverse_brown_conrady(V & x, V & y, const float * k)
+    {
+        V dx = x, dy = y;
+        for(int i = 0; i < brown_conrady_iterations; ++i)
+        {
+            V r2 = dx*dx + dy*dy;
+            V f = 1 + k[0]*r2 + k[1]*r2*r2 + k[4]*r2*r2*r2;
+            V tx = 2*k[2]*dx*dy + k[3]*(r2 + 2*dx*dx), ty = 2*k[3]*dx*dy + k[2]*(r2 + 2*dy*dy);
+            dx = (x - tx) / f;
+            dy = (y - ty) / f;
+        }
+        x = dx;
+        y = dy;
+    }
+
+    // The field of view model, where a ray at angle theta from the axis lands at a distance of atan(2 r tan(w / 2)) / w from the center
+    template<class V> RS_ALWAYS_INLINE void distort_ftheta(V & x, V & y, float w)
+    {
+        V r = max(sqrt(x*x + y*y), std::numeric_limits<float>::epsilon());
+        V scale = atan_lanes(r * (2 * std::tan(w / 2))) / (w * r);
+        x = x * scale;
+        y = y * scale;
+    }
+
+    template<class V> RS_ALWAYS_INLINE void undistort_ftheta(V & x, V & y, float w)
+    {
+        V rd = max(sqrt(x*x + y*y), std::numeric_limits<float>::epsilon());
+        V scale = tan_lanes(rd * w) / ((2 * std::tan(w / 2)) * rd);
+        x = x * scale;
+        y = y * scale;
+    }
+
+    // The kernels below process points [i, n) and return the index of the first point they left over
+    template<class V> RS_ALWAYS_INLINE int project_points_lanes(int i, int n, float * pixel_x, float * pixel_y, const rs_intrinsics & intrin, const float * point_x, const float * point_y, const float * point_z)
+    {
+        for(; i + V::size <= n; i += V::size)
+        {
+            V z = V::load(point_z + i), x = V::load(point_x + i) / z, y = V::load(point_y + i) / z;
+            switch(intrin.model)
+            {
+            case RS_DISTORTION_MODIFIED_BROWN_CONRADY: distort_modified_brown_conrady(x, y, intrin.coeffs); break;
+            case RS_DISTORTION_INVERSE_BROWN_CONRADY: distort_inverse_brown_conrady(x, y, intrin.coeffs); break;
+            case RS_DISTORTION_FTHETA: distort_ftheta(x, y, intrin.coeffs[0]); break;
+            default: break;
+            }
+            (x * intrin.fx + intrin.ppx).store(pixel_x + i);
+            (y * intrin.fy + intrin.ppy).store(pixel_y + i);
+        }
+        return i;
+    }
+
+    template<class V> RS_ALWAYS_INLINE int deproject_pixels_lanes(int i, int n, float * point_x, float * point_y, float * point_z, const rs_intrinsics & intrin, const float * pixel_x, const float * pixel_y, const float * depth)
+    {
+        for(; i + V::size <= n; i += V::size)
+        {
+            V x = (V::load(pixel_x + i) - intrin.ppx) / intrin.fx, y = (V::load(pixel_y + i) - intrin.ppy) / intrin.fy, d = V::load(depth + i);
+            switch(intrin.model)
+            {
+            case RS_DISTORTION_MODIFIED_BROWN_CONRADY: undistort_modified_brown_conrady(x, y, intrin.coeffs); break;
+            case RS_DISTORTION_INVERSE_BROWN_CONRADY: undistort_inverse_brown_conrady(x, y, intrin.coeffs); break;
+            case RS_DISTORTION_FTHETA: undistort_ftheta(x, y, intrin.coeffs[0]); break;
+            default: break;
+            }
+            (d * x).store(point_x + i);
+            (d * y).store(point_y + i);
+            d.store(point_z + i);
+        }
+        return i;
+    }
+
+    template<class V> RS_ALWAYS_INLINE int transform_points_lanes(int i, int n, float * to_x, float * to_y, float * to_z, const rs_extrinsics & extrin, const float * from_x, const float * from_y, const float * from_z)
+    {
+        const float * r = extrin.rotation, * t = extrin.translation;
+        for(; i + V::size <= n; i += V::size)
+        {
+            V x = V::load(from_x + i), y = V::load(from_y + i), z = V::load(from_z + i);
+            (r[0] * x + r[3] * y + r[6] * z + t[0]).store(to_x + i);
+            (r[1] * x + r[4] * y + r[7] * z + t[1]).store(to_y + i);
+            (r[2] * x + r[5] * y + r[8] * z + t[2]).store(to_z + i);
+        }
+        return i;
+    }
+
+#ifdef RS_SIMD_X86
+    static RS_TARGET("ssse3") int project_points_ssse3(int i, int n, float * pixel_x, float * pixel_y, const rs_intrinsics & intrin, const float * point_x, const float * point_y, const float * point_z) { return project_points_lanes<f32x4>(i, n, pixel_x, pixel_y, intrin, point_x, point_y, point_z); }
+    static RS_TARGET("avx2") int project_points_avx2(int i, int n, float * pixel_x, float * pixel_y, const rs_intrinsics & intrin, const float * point_x, const float * point_y, const float * point_z) { return project_points_lanes<f32x8>(i, n, pixel_x, pixel_y, intrin, point_x, point_y, point_z); }
+    static RS_TARGET("ssse3") int deproject_pixels_ssse3(int i, int n, float * point_x, float * point_y, float * point_z, const rs_intrinsics & intrin, const float * pixel_x, const float * pixel_y, const float * depth) { return deproject_pixels_lanes<f32x4>(i, n, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depth); }
+    static RS_TARGET("avx2") int deproject_pixels_avx2(int i, int n, float * point_x, float * point_y, float * point_z, const rs_intrinsics & intrin, const float * pixel_x, const float * pixel_y, const float * depth) { return deproject_pixels_lanes<f32x8>(i, n, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depth); }
+    static RS_TARGET("ssse3") int transform_points_ssse3(int i, int n, float * to_x, float * to_y, float * to_z, const rs_extrinsics & extrin, const float * from_x, const float * from_y, const float * from_z) { return transform_points_lanes<f32x4>(i, n, to_x, to_y, to_z, extrin, from_x, from_y, from_z); }
+    static RS_TARGET("avx2") int transform_points_avx2(int i, int n, float * to_x, float * to_y, float * to_z, const rs_extrinsics & extrin, const float * from_x, const float * from_y, const float * from_z) { return transform_points_lanes<f32x8>(i, n, to_x, to_y, to_z, extrin, from_x, from_y, from_z); }
+#endif
+
+    void project_points(int n, float * pixel_x, float * pixel_y, const rs_intrinsics & intrin, const float * point_x, const float * point_y, const float * point_z)
+    {
+        int i = 0;
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx2) i = project_points_avx2(i, n, pixel_x, pixel_y, intrin, point_x, point_y, point_z);
+        if(level >= simd_level::ssse3) i = project_points_ssse3(i, n, pixel_x, pixel_y, intrin, point_x, point_y, point_z);
+#endif
+        project_points_lanes<f32x1>(i, n, pixel_x, pixel_y, intrin, point_x, point_y, point_z);
+    }
+
+    void deproject_pixels(int n, float * point_x, float * point_y, float * point_z, const rs_intrinsics & intrin, const float * pixel_x, const float * pixel_y, const float * depth)
+    {
+        int i = 0;
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx2) i = deproject_pixels_avx2(i, n, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depth);
+        if(level >= simd_level::ssse3) i = deproject_pixels_ssse3(i, n, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depth);
+#endif
+        deproject_pixels_lanes<f32x1>(i, n, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depth);
+    }
+
+    void transform_points(int n, float * to_x, float * to_y, float * to_z, const rs_extrinsics & extrin, const float * from_x, const float * from_y, const float * from_z)
+    {
+        int i = 0;
+#ifdef RS_SIMD_X86
+        auto level = get_simd_level();
+        if(level >= simd_level::avx2) i = transform_points_avx2(i, n, to_x, to_y, to_z, extrin, from_x, from_y, from_z);
+        if(level >= simd_level::ssse3) i = transform_points_ssse3(i, n, to_x, to_y, to_z, extrin, from_x, from_y, from_z);
+#endif
+        transform_points_lanes<f32x1>(i, n, to_x, to_y, to_z, extrin, from_x, from_y, from_z);
+    }
+
+    // Coordinates which are not stored contiguously are copied through blocks of contiguous ones
+    void project_points_to_pixels(float * pixel_x, float * pixel_y, int pixel_stride, const rs_intrinsics & intrin, const float * point_x, const float * point_y, const float * point_z, int point_stride, int count)
+    {
+        if(pixel_stride == 1 && point_stride == 1) return project_points(count, pixel_x, pixel_y, intrin, point_x, point_y, point_z);
+
+        float in[3][projection_block_size], out[2][projection_block_size];
+        for(int begin = 0; begin < count; begin += projection_block_size)
+        {
+            const int n = std::min<int>(count - begin, projection_block_size);
+            for(int i = 0; i < n; ++i)
+            {
+                const size_t j = size_t(begin + i) * point_stride;
+                in[0][i] = point_x[j];
+                in[1][i] = point_y[j];
+                in[2][i] = point_z[j];
+            }
+            project_points(n, out[0], out[1], intrin, in[0], in[1], in[2]);
+            for(int i = 0; i < n; ++i)
+            {
+                const size_t j = size_t(begin + i) * pixel_stride;
+                pixel_x[j] = out[0][i];
+                pixel_y[j] = out[1][i];
+            }
+        }
+    }
+
+    void deproject_pixels_to_points(float * point_x, float * point_y, float * point_z, int point_stride, const rs_intrinsics & intrin, const float * pixel_x, const float * pixel_y, int pixel_stride, const float * depth, int count)
+    {
+        if(point_stride == 1 && pixel_stride == 1) return deproject_pixels(count, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depth);
+
+        float in[2][projection_block_size], out[3][projection_block_size];
+        for(int begin = 0; begin < count; begin += projection_block_size)
+        {
+            const int n = std::min<int>(count - begin, projection_block_size);
+            for(int i = 0; i < n; ++i)
+            {
+                const size_t j = size_t(begin + i) * pixel_stride;
+                in[0][i] = pixel_x[j];
+                in[1][i] = pixel_y[j];
+            }
+            deproject_pixels(n, out[0], out[1], out[2], intrin, in[0], in[1], depth + begin);
+            for(int i = 0; i < n; ++i)
+            {
+                const size_t j = size_t(begin + i) * point_stride;
+                point_x[j] = out[0][i];
+                point_y[j] = out[1][i];
+                point_z[j] = out[2][i];
+            }
+        }
+    }
+
+    void transform_points_to_points(float * to_x, float * to_y, float * to_z, int to_stride, const rs_extrinsics & extrin, const float * from_x, const float * from_y, const float * from_z, int from_stride, int count)
+    {
+        if(to_stride == 1 && from_stride == 1) return transform_points(count, to_x, to_y, to_z, extrin, from_x, from_y, from_z);
+
+        float in[3][projection_block_size], out[3][projection_block_size];
+        for(int begin = 0; begin < count; begin += projection_block_size)
+        {
+            const int n = std::min<int>(count - begin, projection_block_size);
+            for(int i = 0; i < n; ++i)
+            {
+                const size_t j = size_t(begin + i) * from_stride;
+                in[0][i] = from_x[j];
+                in[1][i] = from_y[j];
+                in[2][i] = from_z[j];
+            }
+            transform_points(n, out[0], out[1], out[2], extrin, in[0], in[1], in[2]);
+            for(int i = 0; i < n; ++i)
+            {
+                const size_t j = size_t(begin + i) * to_stride;
+                to_x[j] = out[0][i];
+                to_y[j] = out[1][i];
+                to_z[j] = out[2][i];
+            }
+        }
+    }
+}
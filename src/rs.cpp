@@ -179,6 +179,82 @@ void rs_get_motion_extrinsics_from(const rs_device * device, rs_stream from, rs_
 }
 HANDLE_EXCEPTIONS_AND_RETURN(, device, from, extrin)
 
+void rs_project_points_to_pixels(float * pixels, const rs_intrinsics * intrin, const float * points, int count, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(pixels);
+    VALIDATE_NOT_NULL(intrin);
+    VALIDATE_ENUM(intrin->model);
+    VALIDATE_NOT_NULL(points);
+    VALIDATE_RANGE(count, 0, INT_MAX);
+    rsimpl::project_points_to_pixels(pixels, pixels + 1, 2, *intrin, points, points + 1, points + 2, 3, count);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, pixels, intrin, points, count)
+
+void rs_project_points_to_pixels_soa(float * pixel_x, float * pixel_y, const rs_intrinsics * intrin, const float * point_x, const float * point_y, const float * point_z, int count, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(pixel_x);
+    VALIDATE_NOT_NULL(pixel_y);
+    VALIDATE_NOT_NULL(intrin);
+    VALIDATE_ENUM(intrin->model);
+    VALIDATE_NOT_NULL(point_x);
+    VALIDATE_NOT_NULL(point_y);
+    VALIDATE_NOT_NULL(point_z);
+    VALIDATE_RANGE(count, 0, INT_MAX);
+    rsimpl::project_points_to_pixels(pixel_x, pixel_y, 1, *intrin, point_x, point_y, point_z, 1, count);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, pixel_x, pixel_y, intrin, point_x, point_y, point_z, count)
+
+void rs_deproject_pixels_to_points(float * points, const rs_intrinsics * intrin, const float * pixels, const float * depths, int count, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(points);
+    VALIDATE_NOT_NULL(intrin);
+    VALIDATE_ENUM(intrin->model);
+    VALIDATE_NOT_NULL(pixels);
+    VALIDATE_NOT_NULL(depths);
+    VALIDATE_RANGE(count, 0, INT_MAX);
+    rsimpl::deproject_pixels_to_points(points, points + 1, points + 2, 3, *intrin, pixels, pixels + 1, 2, depths, count);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, points, intrin, pixels, depths, count)
+
+void rs_deproject_pixels_to_points_soa(float * point_x, float * point_y, float * point_z, const rs_intrinsics * intrin, const float * pixel_x, const float * pixel_y, const float * depths, int count, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(point_x);
+    VALIDATE_NOT_NULL(point_y);
+    VALIDATE_NOT_NULL(point_z);
+    VALIDATE_NOT_NULL(intrin);
+    VALIDATE_ENUM(intrin->model);
+    VALIDATE_NOT_NULL(pixel_x);
+    VALIDATE_NOT_NULL(pixel_y);
+    VALIDATE_NOT_NULL(depths);
+    VALIDATE_RANGE(count, 0, INT_MAX);
+    rsimpl::deproject_pixels_to_points(point_x, point_y, point_z, 1, *intrin, pixel_x, pixel_y, 1, depths, count);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, point_x, point_y, point_z, intrin, pixel_x, pixel_y, depths, count)
+
+void rs_transform_points_to_points(float * to_points, const rs_extrinsics * extrin, const float * from_points, int count, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(to_points);
+    VALIDATE_NOT_NULL(extrin);
+    VALIDATE_NOT_NULL(from_points);
+    VALIDATE_RANGE(count, 0, INT_MAX);
+    rsimpl::transform_points_to_points(to_points, to_points + 1, to_points + 2, 3, *extrin, from_points, from_points + 1, from_points + 2, 3, count);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, to_points, extrin, from_points, count)
+
+void rs_transform_points_to_points_soa(float * to_x, float * to_y, float * to_z, const rs_extrinsics * extrin, const float * from_x, const float * from_y, const float * from_z, int count, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(to_x);
+    VALIDATE_NOT_NULL(to_y);
+    VALIDATE_NOT_NULL(to_z);
+    VALIDATE_NOT_NULL(extrin);
+    VALIDATE_NOT_NULL(from_x);
+    VALIDATE_NOT_NULL(from_y);
+    VALIDATE_NOT_NULL(from_z);
+    VALIDATE_RANGE(count, 0, INT_MAX);
+    rsimpl::transform_points_to_points(to_x, to_y, to_z, 1, *extrin, from_x, from_y, from_z, 1, count);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, to_x, to_y, to_z, extrin, from_x, from_y, from_z, count)
+
 int rs_device_supports_option(const rs_device * device, rs_option option, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(device);
@@ -207,7 +283,7 @@ HANDLE_EXCEPTIONS_AND_RETURN(, device, stream, index, width, height, format, fra
 void rs_enable_stream_ex(rs_device * device, rs_stream stream, int width, int height, rs_format format, int framerate, rs_output_buffer_format output, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(device);
-    VALIDATE_NATIVE_STREAM(stream);
+    if(stream != RS_STREAM_POINTS) { VALIDATE_NATIVE_STREAM(stream); }
     VALIDATE_RANGE(width, 0, INT_MAX);
     VALIDATE_RANGE(height, 0, INT_MAX);
     VALIDATE_ENUM(format);
@@ -220,7 +296,7 @@ HANDLE_EXCEPTIONS_AND_RETURN(, device, stream, width, height, format, framerate)
 void rs_enable_stream(rs_device * device, rs_stream stream, int width, int height, rs_format format, int framerate, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(device);
-    VALIDATE_NATIVE_STREAM(stream);
+    if(stream != RS_STREAM_POINTS) { VALIDATE_NATIVE_STREAM(stream); }
     VALIDATE_RANGE(width, 0, INT_MAX);
     VALIDATE_RANGE(height, 0, INT_MAX);
     VALIDATE_ENUM(format);
@@ -321,6 +397,42 @@ void rs_set_frame_callback_cpp(rs_device * device, rs_stream stream, rs_frame_ca
 }
 HANDLE_EXCEPTIONS_AND_RETURN(, device, stream, callback)
 
+void rs_set_frame_allocator(rs_device * device, rs_frame_alloc_ptr on_alloc, rs_frame_free_ptr on_free, void * user, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_NOT_NULL(on_alloc);
+    VALIDATE_NOT_NULL(on_free);
+    device->set_frame_allocator(on_alloc, on_free, user);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, device, on_alloc, on_free, user)
+
+void rs_set_frame_allocator_cpp(rs_device * device, rs_frame_allocator * allocator, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_NOT_NULL(allocator);
+    device->set_frame_allocator(allocator);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, device, allocator)
+
+void rs_set_stream_capture_buffers(rs_device * device, rs_stream stream, int count, rs_capture_memory memory, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_NATIVE_STREAM(stream);
+    VALIDATE_RANGE(count, 0, RS_MAX_CAPTURE_BUFFERS);
+    VALIDATE_ENUM(memory);
+    device->set_stream_capture_buffers(stream, count, memory);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, device, stream, count, memory)
+
+void rs_set_stream_sync_queue_size(rs_device * device, rs_stream stream, int size, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_NATIVE_STREAM(stream);
+    VALIDATE_RANGE(size, 0, RS_MAX_SYNC_QUEUE_SIZE);
+    device->set_stream_sync_queue_size(stream, size);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(, device, stream, size)
+
 void rs_log_to_callback(rs_log_severity min_severity, rs_log_callback_ptr on_log, void * user, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(on_log);
@@ -432,6 +544,13 @@ void rs_wait_for_frames(rs_device * device, rs_error ** error) try
 }
 HANDLE_EXCEPTIONS_AND_RETURN(, device)
 
+int rs_wait_for_frames_timeout(rs_device * device, unsigned int timeout_ms, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    return device->wait_all_streams(timeout_ms);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(0, device, timeout_ms)
+
 int rs_poll_for_frames(rs_device * device, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(device);
@@ -439,6 +558,13 @@ int rs_poll_for_frames(rs_device * device, rs_error ** error) try
 }
 HANDLE_EXCEPTIONS_AND_RETURN(0, device)
 
+int rs_get_frames_ready_fd(const rs_device * device, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    return device->get_frames_ready_fd();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(-1, device)
+
 int rs_supports(rs_device * device, rs_capabilities capability, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(device);
@@ -495,6 +621,36 @@ const void * rs_get_frame_data(const rs_device * device, rs_stream stream, rs_er
 }
 HANDLE_EXCEPTIONS_AND_RETURN(nullptr, device, stream)
 
+int rs_get_point_count(const rs_device * device, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    return device->get_point_count();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(0, device)
+
+const int * rs_get_point_pixel_indices(const rs_device * device, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    return device->get_point_pixel_indices();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, device)
+
+const float * rs_get_point_texture_coordinates(const rs_device * device, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    return device->get_point_texture_coordinates();
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, device)
+
+rs_frame_ref * rs_compute_detached_frame(rs_device * device, rs_stream stream, const rs_frame_ref * frame, const rs_frame_ref * other, rs_error ** error) try
+{
+    VALIDATE_NOT_NULL(device);
+    VALIDATE_ENUM(stream);
+    VALIDATE_NOT_NULL(frame);
+    return device->compute_frame(stream, frame, other);
+}
+HANDLE_EXCEPTIONS_AND_RETURN(nullptr, device, stream, frame, other)
+
 double rs_get_detached_frame_timestamp(const rs_frame_ref * frame_ref, rs_error ** error) try
 {
     VALIDATE_NOT_NULL(frame_ref);
@@ -765,6 +921,8 @@ const char * rs_camera_info_to_string(rs_camera_info info) { return rsimpl::get_
 const char * rs_timestamp_domain_to_string(rs_timestamp_domain info){ return rsimpl::get_string(info); }
 
 const char * rs_frame_metadata_to_string(rs_frame_metadata md) { return rsimpl::get_string(md); }
+const char * rs_capture_memory_to_string(rs_capture_memory memory) { return rsimpl::get_string(memory); }
+const char * rs_sync_policy_to_string(rs_sync_policy policy) { return rsimpl::get_string(policy); }
 
 void rs_log_to_console(rs_log_severity min_severity, rs_error ** error) try
 {
@@ -155,66 +155,224 @@ int native_stream::get_frame_bpp() const
     return archive->get_frame_bpp(stream);
 }
 
+// Checks that a detached frame is one of the stream a derived stream is computed from, and returns its pixels
+static const uint8_t * get_source_pixels(const rs_frame_ref * frame, const stream_interface & source)
+{
+    if(!frame) throw std::runtime_error(to_string() << "a frame of " << source.get_stream_type() << " is required");
+    if(frame->get_stream_type() != source.get_stream_type()) throw std::runtime_error(to_string() << "expected a frame of " << source.get_stream_type() << ", got " << frame->get_stream_type());
+    if(frame->get_frame_width() != source.get_intrinsics().width || frame->get_frame_height() != source.get_intrinsics().height) throw std::runtime_error(to_string() << "frame of " << source.get_stream_type() << " does not match the streaming mode");
+    return frame->get_frame_data();
+}
+
+int point_stream::deproject(float * points, const uint8_t * depth, bool compact) const
+{
+    std::lock_guard<std::mutex> lock(table_mutex);
+
+    // Intrinsics only change with the streaming mode, so the rays through each pixel are computed once per mode
+    auto intrin = get_intrinsics();
+    if(table.empty() || !(table_intrin == intrin))
+    {
+        table = compute_deprojection_table(intrin);
+        table_intrin = intrin;
+    }
+
+    // A compact cloud is written to the start of a buffer with room for every pixel, so that it is never reallocated
+    if(source.get_format() == RS_FORMAT_Z16)
+    {
+        if(compact) return deproject_z_compact(points, table, reinterpret_cast<const uint16_t *>(depth), get_depth_scale());
+        deproject_z(points, table, reinterpret_cast<const uint16_t *>(depth), get_depth_scale());
+    }
+    else if(source.get_format() == RS_FORMAT_DISPARITY16)
+    {
+        if(compact) return deproject_disparity_compact(points, table, reinterpret_cast<const uint16_t *>(depth), get_depth_scale());
+        deproject_disparity(points, table, reinterpret_cast<const uint16_t *>(depth), get_depth_scale());
+    }
+    else assert(false && "Cannot deproject image from a non-depth format");
+    return intrin.width * intrin.height;
+}
+
+derived_frame<point_stream::cloud>::reference point_stream::get_cloud() const
+{
+    return frame.get([this]() { return std::make_pair(get_frame_number(), 0ULL); }, [this](cloud & c)
+    {
+        auto intrin = get_intrinsics();
+        c.image.resize(get_image_size(intrin.width, intrin.height, get_format()));
+
+        // Points are deprojected as floats, into a separate buffer if they are to be converted to a smaller format
+        if(format != RS_FORMAT_XYZ32F) c.points.resize(intrin.width * intrin.height * 3);
+        auto points = format == RS_FORMAT_XYZ32F ? reinterpret_cast<float *>(c.image.data()) : c.points.data();
+        c.count = deproject(points, source.get_frame_data(), compact);
+
+        if(format == RS_FORMAT_XYZ16F) convert_points_to_xyz16f(reinterpret_cast<uint16_t *>(c.image.data()), points, c.count * 3);
+        if(format == RS_FORMAT_XYZ16) convert_points_to_xyz16(reinterpret_cast<int16_t *>(c.image.data()), points, c.count * 3);
+    });
+}
+
 const uint8_t * point_stream::get_frame_data() const
 {
-    if(image.empty() || number != get_frame_number())
+    return get_cloud()->image.data();
+}
+
+// Detached frames have no room for a point count, so they hold a point for every pixel even when the stream is compact
+void point_stream::compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref *) const
+{
+    auto depth = get_source_pixels(frame, source);
+    if(format == RS_FORMAT_XYZ32F)
+    {
+        deproject(reinterpret_cast<float *>(dest), depth, false);
+        return;
+    }
+
+    std::vector<float> points(get_intrinsics().width * get_intrinsics().height * 3);
+    deproject(points.data(), depth, false);
+    if(format == RS_FORMAT_XYZ16F) convert_points_to_xyz16f(reinterpret_cast<uint16_t *>(dest), points.data(), (int)points.size());
+    if(format == RS_FORMAT_XYZ16) convert_points_to_xyz16(reinterpret_cast<int16_t *>(dest), points.data(), (int)points.size());
+}
+
+int point_stream::get_point_count() const
+{
+    return get_cloud()->count;
+}
+
+const int * point_stream::get_point_pixel_indices() const
+{
+    return indices.get([this]() { return std::make_pair(get_frame_number(), 0ULL); }, [this](std::vector<int> & indices)
+    {
+        const int pixels = get_intrinsics().width * get_intrinsics().height;
+        indices.resize(pixels);
+        if(compact) find_valid_pixels(indices.data(), reinterpret_cast<const uint16_t *>(source.get_frame_data()), pixels);
+        else for(int i = 0; i < pixels; ++i) indices[i] = i;
+    })->data();
+}
+
+const float * point_stream::get_point_texture_coordinates() const
+{
+    if(!texture.is_enabled()) throw std::runtime_error(to_string() << "stream not enabled: " << texture.get_stream_type());
+    return texture_coordinates.get([this]() { return std::make_pair(get_frame_number(), 0ULL); }, [this](std::vector<float> & uv)
+    {
+        auto c = get_cloud();
+        uv.resize(get_intrinsics().width * get_intrinsics().height * 2);
+        compute_texture_coordinates(uv.data(), format == RS_FORMAT_XYZ32F ? reinterpret_cast<const float *>(c->image.data()) : c->points.data(), c->count, 
+            source.get_extrinsics_to(texture), texture.get_intrinsics());
+    })->data();
+}
+
+void colored_point_stream::deproject(uint8_t * dest, const uint8_t * depth, const uint8_t * color) const
+{
+    const auto texture_format = texture.get_format();
+    if(texture_format != RS_FORMAT_RGB8 && texture_format != RS_FORMAT_BGR8 && texture_format != RS_FORMAT_RGBA8 && texture_format != RS_FORMAT_BGRA8 && texture_format != RS_FORMAT_Y8)
+    {
+        throw std::runtime_error(to_string() << "cannot color points from format " << texture_format);
+    }
+
+    std::lock_guard<std::mutex> lock(table_mutex);
+    auto intrin = get_intrinsics();
+    if(table.empty() || !(table_intrin == intrin))
+    {
+        table = compute_deprojection_table(intrin);
+        table_intrin = intrin;
+    }
+    if(source.get_format() == RS_FORMAT_Z16)
+    {
+        deproject_z_colored(dest, table, reinterpret_cast<const uint16_t *>(depth), get_depth_scale(), 
+            source.get_extrinsics_to(texture), texture.get_intrinsics(), color, texture_format);
+    }
+    else if(source.get_format() == RS_FORMAT_DISPARITY16)
+    {
+        deproject_disparity_colored(dest, table, reinterpret_cast<const uint16_t *>(depth), get_depth_scale(), 
+            source.get_extrinsics_to(texture), texture.get_intrinsics(), color, texture_format);
+    }
+    else assert(false && "Cannot deproject image from a non-depth format");
+}
+
+const uint8_t * colored_point_stream::get_frame_data() const
+{
+    // The color frame may be newer than the depth frame it is mapped onto
+    return frame.get([this]() { return std::make_pair(get_frame_number(), texture.get_frame_number()); }, [this](std::vector<uint8_t> & image)
     {
         image.resize(get_image_size(get_intrinsics().width, get_intrinsics().height, get_format()));
+        deproject(image.data(), source.get_frame_data(), texture.get_frame_data());
+    })->data();
+}
 
-        if(source.get_format() == RS_FORMAT_Z16)
-        {
-            deproject_z(reinterpret_cast<float *>(image.data()), get_intrinsics(), reinterpret_cast<const uint16_t *>(source.get_frame_data()), get_depth_scale());
-        }
-        else if(source.get_format() == RS_FORMAT_DISPARITY16)
-        {
-            deproject_disparity(reinterpret_cast<float *>(image.data()), get_intrinsics(), reinterpret_cast<const uint16_t *>(source.get_frame_data()), get_depth_scale());
-        }
-        else assert(false && "Cannot deproject image from a non-depth format");
+void colored_point_stream::compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref * other) const
+{
+    deproject(dest, get_source_pixels(frame, source), get_source_pixels(other, texture));
+}
 
-        number = get_frame_number();
+void rectified_stream::rectify(uint8_t * dest, const uint8_t * source_pixels) const
+{
+    std::lock_guard<std::mutex> lock(table_mutex);
+    const auto rect_intrin = get_intrinsics(), unrect_intrin = source.get_intrinsics();
+    const auto rect_to_unrect = get_extrinsics_to(source);
+    if(table.index.empty() || table.bilinear != bilinear || !(table.rect_intrin == rect_intrin && table.rect_to_unrect == rect_to_unrect && table.unrect_intrin == unrect_intrin))
+    {
+        table = compute_rectification_table(rect_intrin, rect_to_unrect, unrect_intrin, bilinear);
     }
-    return image.data();
+    rectify_image(dest, table, source_pixels, get_format());
 }
 
 const uint8_t * rectified_stream::get_frame_data() const
 {
     // If source image is already rectified, just return it without doing any work
-    if(get_pose() == source.get_pose() && get_intrinsics() == source.get_intrinsics()) return source.get_frame_data();
+    if(is_passthrough()) return source.get_frame_data();
 
-    if(image.empty() || number != get_frame_number())
+    return frame.get([this]() { return std::make_pair(get_frame_number(), 0ULL); }, [this](std::vector<uint8_t> & image)
     {
-        if(table.empty()) table = compute_rectification_table(get_intrinsics(), get_extrinsics_to(source), source.get_intrinsics());
         image.resize(get_image_size(get_intrinsics().width, get_intrinsics().height, get_format()));
-        rectify_image(image.data(), table, source.get_frame_data(), get_format());
-        number = get_frame_number();
+        rectify(image.data(), source.get_frame_data());
+    })->data();
+}
+
+void rectified_stream::compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref *) const
+{
+    auto pixels = get_source_pixels(frame, source);
+    if(!is_passthrough()) rectify(dest, pixels);
+    else for(int y = 0; y < get_intrinsics().height; ++y)
+    {
+        // The source frame may be padded, the rectified frame is not
+        const int row = get_intrinsics().width * get_frame_bpp() / 8;
+        memcpy(dest + y * row, pixels + y * frame->get_frame_stride(), row);
+    }
+}
+
+void aligned_stream::align(uint8_t * dest, const uint8_t * from_pixels, const uint8_t * to_pixels) const
+{
+    memset(dest, from.get_format() == RS_FORMAT_DISPARITY16 ? 0xFF : 0x00, get_image_size(get_intrinsics().width, get_intrinsics().height, get_format()));
+    std::lock_guard<std::mutex> lock(workspace_mutex);
+    auto pool = std::atomic_load(&this->pool); // Hold the pool until alignment completes, even if streaming stops meanwhile
+    workspace.pool = pool.get();
+    if(from.get_format() == RS_FORMAT_Z16)
+    {
+        align_z_to_other(dest, (const uint16_t *)from_pixels, from.get_depth_scale(), from.get_intrinsics(), from.get_extrinsics_to(to), to.get_intrinsics(), workspace);
+    }
+    else if(from.get_format() == RS_FORMAT_DISPARITY16)
+    {
+        align_disparity_to_other(dest, (const uint16_t *)from_pixels, from.get_depth_scale(), from.get_intrinsics(), from.get_extrinsics_to(to), to.get_intrinsics(), workspace);
     }
-    return image.data();
+    else if(to.get_format() == RS_FORMAT_Z16)
+    {
+        align_other_to_z(dest, (const uint16_t *)to_pixels, to.get_depth_scale(), to.get_intrinsics(), to.get_extrinsics_to(from), from.get_intrinsics(), from_pixels, from.get_format(), workspace);
+    }
+    else if(to.get_format() == RS_FORMAT_DISPARITY16)
+    {
+        align_other_to_disparity(dest, (const uint16_t *)to_pixels, to.get_depth_scale(), to.get_intrinsics(), to.get_extrinsics_to(from), from.get_intrinsics(), from_pixels, from.get_format(), workspace);
+    }
+    else assert(false && "Cannot align two images if neither have depth data");
 }
 
 const uint8_t * aligned_stream::get_frame_data() const
 {
-    if(image.empty() || number != get_frame_number())
+    // Other images are aligned to a depth image that may be newer than them, depth images only need their own frame
+    const bool from_depth = is_from_depth();
+    return frame.get([this, from_depth]() { return std::make_pair(get_frame_number(), from_depth ? 0ULL : to.get_frame_number()); }, [this, from_depth](std::vector<uint8_t> & image)
     {
         image.resize(get_image_size(get_intrinsics().width, get_intrinsics().height, get_format()));
-        memset(image.data(), from.get_format() == RS_FORMAT_DISPARITY16 ? 0xFF : 0x00, image.size());
-        if(from.get_format() == RS_FORMAT_Z16)
-        {
-            align_z_to_other(image.data(), (const uint16_t *)from.get_frame_data(), from.get_depth_scale(), from.get_intrinsics(), from.get_extrinsics_to(to), to.get_intrinsics());
-        }
-        else if(from.get_format() == RS_FORMAT_DISPARITY16)
-        {
-            align_disparity_to_other(image.data(), (const uint16_t *)from.get_frame_data(), from.get_depth_scale(), from.get_intrinsics(), from.get_extrinsics_to(to), to.get_intrinsics());
-        }
-        else if(to.get_format() == RS_FORMAT_Z16)
-        {
-            align_other_to_z(image.data(), (const uint16_t *)to.get_frame_data(), to.get_depth_scale(), to.get_intrinsics(), to.get_extrinsics_to(from), from.get_intrinsics(), from.get_frame_data(), from.get_format());
-        }
-        else if(to.get_format() == RS_FORMAT_DISPARITY16)
-        {
-            align_other_to_disparity(image.data(), (const uint16_t *)to.get_frame_data(), to.get_depth_scale(), to.get_intrinsics(), to.get_extrinsics_to(from), from.get_intrinsics(), from.get_frame_data(), from.get_format());
-        }
-        else assert(false && "Cannot align two images if neither have depth data");
-        number = get_frame_number();
-    }
-    return image.data();
+        align(image.data(), from.get_frame_data(), from_depth ? nullptr : to.get_frame_data());
+    })->data();
+}
+
+void aligned_stream::compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref * other) const
+{
+    align(dest, get_source_pixels(frame, from), is_from_depth() ? nullptr : get_source_pixels(other, to));
 }
@@ -6,8 +6,10 @@
 #define LIBREALSENSE_STREAM_H
 
 #include "types.h"
+#include "image.h"
 
-#include <memory> // For shared_ptr
+#include <memory> // For unique_ptr
+#include <mutex>  // For mutex
 
 namespace rsimpl
 {
@@ -21,6 +23,9 @@ namespace rsimpl
         virtual void                            get_mode(int /*mode*/, int * /*w*/, int * /*h*/, rs_format * /*f*/, int * /*fps*/) const override { throw std::logic_error("no modes"); }
         virtual rs_stream                       get_stream_type()const override { return stream; }
 
+        // Computes the frame of a derived stream from detached frames of the streams it is derived from, as a tightly packed image
+        virtual void                            compute_frame(uint8_t * /*dest*/, const rs_frame_ref * /*frame*/, const rs_frame_ref * /*other*/) const { throw std::runtime_error(to_string() << get_stream_type() << " is not derived from other streams"); }
+
         const rs_stream   stream;
 
     protected:
@@ -29,6 +34,7 @@ namespace rsimpl
     
     class frame_archive;
     class syncronizing_archive;
+    class frameset_event;
 
     struct native_stream final : public stream_interface
     {
@@ -62,13 +68,130 @@ namespace rsimpl
         int                                     get_frame_bpp() const override;
     };
 
+    // The frame a derived stream computed last, identified by the frame numbers of its sources. Readers of the published frame take it with an
+    // atomic load and a compare-exchange on its reader count, without locking. The first thread to ask for a frame that is not published computes
+    // it under a mutex, which other threads asking meanwhile block on rather than computing it again. Frames are computed into slots that are
+    // reused once no reader holds them, so a frame stays intact for as long as a reader holds it. Raw pointers into a frame, as returned through
+    // the C API, stay valid until the one after the next is computed, as native frames stay until the next one. Slots are only freed along with
+    // the derived_frame, which holds at most two more slots than the most frames readers held at once while another frame was computed.
+    template<class T> class derived_frame
+    {
+        typedef std::pair<unsigned long long, unsigned long long> key_type;
+        enum { computing = -1 };                    // Reader count of a slot while a frame is computed into it
+        struct slot
+        {
+            T data;
+            key_type key;
+            std::atomic<int> readers;               // References held to the frame, or computing
+
+            slot() : data(), key(), readers(0) {}
+            bool acquire() { int n = readers.load(std::memory_order_relaxed); while(n >= 0) if(readers.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed)) return true; return false; }
+            bool claim() { int n = 0; return readers.compare_exchange_strong(n, computing, std::memory_order_acquire, std::memory_order_relaxed); }
+        };
+        std::atomic<slot *> published;              // Null until a frame is published
+        slot * previous;                            // The frame published before, guarded by mutex
+        std::vector<std::unique_ptr<slot>> slots;   // Every slot computed into, guarded by mutex
+        std::mutex mutex;                           // Held while a frame is computed
+    public:
+        // A counted reference to a frame, which keeps its slot from being computed into until released. It must not outlive the derived_frame.
+        class reference
+        {
+            friend class derived_frame;
+            slot * s;
+            explicit reference(slot * s) : s(s) {} // Adopts a count the caller acquired
+        public:
+            reference() : s() {}
+            reference(const reference & r) : s(r.s) { if(s) s->readers.fetch_add(1, std::memory_order_relaxed); }
+            reference(reference && r) : s(r.s) { r.s = nullptr; }
+            reference & operator = (reference r) { std::swap(s, r.s); return *this; }
+            ~reference() { if(s) s->readers.fetch_sub(1, std::memory_order_release); }
+
+            const T * get() const { return s ? &s->data : nullptr; }
+            const T & operator * () const { return s->data; }
+            const T * operator -> () const { return &s->data; }
+            explicit operator bool () const { return s != nullptr; }
+            bool operator == (const reference & r) const { return s == r.s; }
+        };
+
+        derived_frame() : published(nullptr), previous() {}
+
+        // Discards the published frames. Readers still holding one keep it, and the slots are kept for the frames computed next.
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            published.store(nullptr, std::memory_order_release);
+            previous = nullptr;
+        }
+
+        // KEY returns the frame numbers of the current source frames, and COMPUTE(T &) computes the frame from them
+        template<class KEY, class COMPUTE> reference get(KEY key, COMPUTE compute)
+        {
+            const key_type wanted = key();
+            if(auto last = find(wanted)) return last;
+
+            // The frame may have been published while this thread waited for the mutex
+            std::lock_guard<std::mutex> lock(mutex);
+            if(auto last = find(wanted)) return last;
+
+            // The published frame and the one before it stay reachable through raw pointers, any other slot no reader holds is reused
+            auto last = published.load(std::memory_order_relaxed);
+            slot * next = nullptr;
+            for(auto & s : slots) if(s.get() != last && s.get() != previous && s->claim()) { next = s.get(); break; }
+            if(!next)
+            {
+                slots.push_back(std::unique_ptr<slot>(new slot));
+                next = slots.back().get();
+                next->claim();
+            }
+
+            try { compute(next->data); }
+            catch(...) { next->readers.store(0, std::memory_order_release); throw; }
+            next->key = wanted;
+            next->readers.store(1, std::memory_order_release); // Held by the reference returned below
+            previous = last;
+            published.store(next, std::memory_order_release);
+            return reference(next);
+        }
+    private:
+        // Returns the published frame if it is the wanted one. A slot that is claimed after it was loaded is left to the slow path.
+        reference find(const key_type & wanted)
+        {
+            auto s = published.load(std::memory_order_acquire);
+            if(!s || !s->acquire()) return reference();
+            reference r(s);
+            return s->key == wanted ? r : reference();
+        }
+    };
+
     class point_stream final : public stream_interface
     {
-        const stream_interface &                source;
-        mutable std::vector<uint8_t>            image;
-        mutable unsigned long long              number;
+        struct cloud
+        {
+            std::vector<uint8_t>                image;
+            std::vector<float>                  points;     // The points as floats, when image holds another format
+            int                                 count;
+        };
+
+        const stream_interface &                source, & texture;
+        mutable derived_frame<cloud>            frame;
+        mutable derived_frame<std::vector<int>> indices;
+        mutable derived_frame<std::vector<float>> texture_coordinates;
+        mutable std::mutex                      table_mutex;
+        mutable std::vector<float>              table;      // Guarded by table_mutex
+        mutable rs_intrinsics                   table_intrin;
+        bool                                    compact;
+        rs_format                               format;
+
+        derived_frame<cloud>::reference         get_cloud() const;
+        int                                     deproject(float * points, const uint8_t * depth, bool compact) const;
     public:
-        point_stream(const stream_interface & source) :stream_interface(calibration_validator(), RS_STREAM_POINTS), source(source), number() {}
+        point_stream(const stream_interface & source, const stream_interface & texture) :stream_interface(calibration_validator(), RS_STREAM_POINTS), source(source), texture(texture), table_intrin(), compact(), format(RS_FORMAT_XYZ32F) {}
+
+        void                                    set_compact(bool compact) { this->compact = compact; frame.reset(); indices.reset(); texture_coordinates.reset(); }
+        void                                    set_format(rs_format format) { this->format = format; frame.reset(); texture_coordinates.reset(); }
+        int                                     get_point_count() const;
+        const int *                             get_point_pixel_indices() const;
+        const float *                           get_point_texture_coordinates() const;
 
         pose                                    get_pose() const override { return {{{1,0,0},{0,1,0},{0,0,1}}, source.get_pose().position}; }
         float                                   get_depth_scale() const override { return source.get_depth_scale(); }
@@ -76,7 +199,7 @@ namespace rsimpl
         bool                                    is_enabled() const override { return source.is_enabled(); }
         rs_intrinsics                           get_intrinsics() const override { return source.get_intrinsics(); }
         rs_intrinsics                           get_rectified_intrinsics() const override { return source.get_rectified_intrinsics(); }
-        rs_format                               get_format() const override { return RS_FORMAT_XYZ32F; }
+        rs_format                               get_format() const override { return format; }
         int                                     get_framerate() const override { return source.get_framerate(); }
 
         double                                  get_frame_metadata(rs_frame_metadata frame_metadata) const override { return source.get_frame_metadata(frame_metadata); }
@@ -85,19 +208,59 @@ namespace rsimpl
         double                                  get_frame_timestamp() const override{ return source.get_frame_timestamp(); }
         long long                               get_frame_system_time() const override { return source.get_frame_system_time(); }
         const uint8_t *                         get_frame_data() const override;
+        void                                    compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref * other) const override;
 
-        int                                     get_frame_stride() const override { return source.get_frame_stride(); }
-        int                                     get_frame_bpp() const override { return source.get_frame_bpp(); }
+        int                                     get_frame_stride() const override { return get_intrinsics().width * get_frame_bpp() / 8; }
+        int                                     get_frame_bpp() const override { return get_image_bpp(format); }
+    };
+
+    class colored_point_stream final : public stream_interface
+    {
+        const stream_interface &                source, & texture;
+        mutable derived_frame<std::vector<uint8_t>> frame;
+        mutable std::mutex                      table_mutex;
+        mutable std::vector<float>              table;      // Guarded by table_mutex
+        mutable rs_intrinsics                   table_intrin;
+
+        void                                    deproject(uint8_t * dest, const uint8_t * depth, const uint8_t * color) const;
+    public:
+        colored_point_stream(const stream_interface & source, const stream_interface & texture) : stream_interface(calibration_validator(), RS_STREAM_COLORED_POINTS), source(source), texture(texture), table_intrin() {}
+
+        pose                                    get_pose() const override { return {{{1,0,0},{0,1,0},{0,0,1}}, source.get_pose().position}; }
+        float                                   get_depth_scale() const override { return source.get_depth_scale(); }
+
+        bool                                    is_enabled() const override { return source.is_enabled() && texture.is_enabled(); }
+        rs_intrinsics                           get_intrinsics() const override { return source.get_intrinsics(); }
+        rs_intrinsics                           get_rectified_intrinsics() const override { return source.get_rectified_intrinsics(); }
+        rs_format                               get_format() const override { return RS_FORMAT_XYZRGB; }
+        int                                     get_framerate() const override { return source.get_framerate(); }
+
+        double                                  get_frame_metadata(rs_frame_metadata frame_metadata) const override { return source.get_frame_metadata(frame_metadata); }
+        bool                                    supports_frame_metadata(rs_frame_metadata frame_metadata) const override { return source.supports_frame_metadata(frame_metadata); }
+        unsigned long long                      get_frame_number() const override { return source.get_frame_number(); }
+        double                                  get_frame_timestamp() const override{ return source.get_frame_timestamp(); }
+        long long                               get_frame_system_time() const override { return source.get_frame_system_time(); }
+        const uint8_t *                         get_frame_data() const override;
+        void                                    compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref * other) const override;
+
+        int                                     get_frame_stride() const override { return get_intrinsics().width * get_frame_bpp() / 8; }
+        int                                     get_frame_bpp() const override { return get_image_bpp(RS_FORMAT_XYZRGB); }
     };
 
     class rectified_stream final : public stream_interface
     {
         const stream_interface &                source;
-        mutable std::vector<int>                table;
-        mutable std::vector<uint8_t>            image;
-        mutable unsigned long long              number;
+        mutable derived_frame<std::vector<uint8_t>> frame;
+        mutable std::mutex                      table_mutex;
+        mutable rectification_table             table;      // Guarded by table_mutex
+        bool                                    bilinear;
+
+        bool                                    is_passthrough() const { return get_pose() == source.get_pose() && get_intrinsics() == source.get_intrinsics(); }
+        void                                    rectify(uint8_t * dest, const uint8_t * source_pixels) const;
     public:
-        rectified_stream(const stream_interface & source) : stream_interface(calibration_validator(), RS_STREAM_RECTIFIED_COLOR), source(source), number() {}
+        rectified_stream(const stream_interface & source) : stream_interface(calibration_validator(), RS_STREAM_RECTIFIED_COLOR), source(source), bilinear() {}
+
+        void                                    set_bilinear(bool bilinear) { this->bilinear = bilinear; frame.reset(); }
 
         pose                                    get_pose() const override { return {{{1,0,0},{0,1,0},{0,0,1}}, source.get_pose().position}; }
         float                                   get_depth_scale() const override { return source.get_depth_scale(); }
@@ -114,6 +277,7 @@ namespace rsimpl
         double                                  get_frame_timestamp() const override { return source.get_frame_timestamp(); }
         long long                               get_frame_system_time() const override { return source.get_frame_system_time(); }
         const uint8_t *                         get_frame_data() const override;
+        void                                    compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref * other) const override;
 
         int                                     get_frame_stride() const override { return source.get_frame_stride(); }
         int                                     get_frame_bpp() const override { return source.get_frame_bpp(); }
@@ -122,10 +286,18 @@ namespace rsimpl
     class aligned_stream final : public stream_interface
     {
         const stream_interface &                from, & to;
-        mutable std::vector<uint8_t>            image;
-        mutable unsigned long long              number;
+        mutable derived_frame<std::vector<uint8_t>> frame;
+        mutable std::mutex                      workspace_mutex;
+        mutable alignment_workspace             workspace;  // Guarded by workspace_mutex
+        std::shared_ptr<worker_pool>            pool;       // Accessed atomically, as streaming may stop while a frame is computed
+
+        bool                                    is_from_depth() const { return from.get_format() == RS_FORMAT_Z16 || from.get_format() == RS_FORMAT_DISPARITY16; }
+        void                                    align(uint8_t * dest, const uint8_t * from_pixels, const uint8_t * to_pixels) const;
     public:
-        aligned_stream(const stream_interface & from, const stream_interface & to) :stream_interface(calibration_validator(), RS_STREAM_COLOR_ALIGNED_TO_DEPTH), from(from), to(to), number() {}
+        aligned_stream(const stream_interface & from, const stream_interface & to) :stream_interface(calibration_validator(), RS_STREAM_COLOR_ALIGNED_TO_DEPTH), from(from), to(to) {}
+
+        void                                    set_pool(std::shared_ptr<worker_pool> pool) { std::atomic_store(&this->pool, std::move(pool)); }
+        void                                    set_incremental(bool incremental) { std::lock_guard<std::mutex> lock(workspace_mutex); workspace.incremental = incremental; }
 
         pose                                    get_pose() const override { return to.get_pose(); }
         float                                   get_depth_scale() const override { return to.get_depth_scale(); }
@@ -142,6 +314,7 @@ namespace rsimpl
         double                                  get_frame_timestamp() const override { return from.get_frame_timestamp(); }
         long long                               get_frame_system_time() const override { return from.get_frame_system_time(); }
         const unsigned char *                   get_frame_data() const override;
+        void                                    compute_frame(uint8_t * dest, const rs_frame_ref * frame, const rs_frame_ref * other) const override;
 
         int                                     get_frame_stride() const override { return from.get_frame_stride(); }
         int                                     get_frame_bpp() const override { return from.get_frame_bpp(); }
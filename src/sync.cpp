@@ -1,21 +1,43 @@
 #include <cmath>
+#include <algorithm>
 #include "sync.h"
 
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
 using namespace rsimpl;
 
 syncronizing_archive::syncronizing_archive(const std::vector<subdevice_mode_selection> & selection,
     rs_stream key_stream,
+    const int (&queue_sizes)[RS_STREAM_NATIVE_COUNT],
+    const sync_settings & settings,
+    sync_counters * counters,
+    frameset_event * ready_event,
     std::atomic<uint32_t>* max_size,
     std::atomic<uint32_t>* event_queue_size,
     std::atomic<uint32_t>* events_timeout,
+    frame_pool_counters* pool_counters,
+    frame_allocator_ptr allocator,
     std::chrono::high_resolution_clock::time_point capture_started)
-    : frame_archive(selection, max_size, capture_started), key_stream(key_stream),
-    ts_corrector(event_queue_size, events_timeout)
+    : frame_archive(selection, max_size, pool_counters, allocator, capture_started), key_stream(key_stream),
+    policy(settings.policy), counters(counters), ready_event(ready_event), ts_corrector(event_queue_size, events_timeout)
 {
+    // A tolerance or latency of zero selects one based on the key stream frame period
+    const int fps = get_mode(key_stream).get_framerate();
+    const double period = fps > 0 ? 1000.0 / fps : 1000.0 / 30;
+    tolerance = settings.tolerance > 0 ? settings.tolerance : period / 2;
+    max_latency = std::chrono::microseconds(static_cast<long long>((settings.max_latency > 0 ? settings.max_latency : period) * 1000));
+
     // Enumerate all streams we need to keep synchronized with the key stream
     for(auto s : {RS_STREAM_DEPTH, RS_STREAM_INFRARED, RS_STREAM_INFRARED2, RS_STREAM_COLOR, RS_STREAM_FISHEYE})
     {
         if(is_stream_enabled(s) && s != key_stream) other_streams.push_back(s);
+        if(is_stream_enabled(s)) frames[s].reset(std::max(queue_sizes[s], 1));
     }
 
     // Allocate an empty image for each stream, and move it to the frontbuffer
@@ -71,21 +93,25 @@ long long syncronizing_archive::get_frame_system_time(rs_stream stream) const
 
 // Block until the next coherent frameset is available
 void syncronizing_archive::wait_for_frames()
+{
+    if(!wait_for_frames(std::chrono::seconds(5))) throw std::runtime_error("Timeout waiting for frames.");
+}
+
+// Block until the next coherent frameset is available or the timeout expires, returning false in the latter case
+bool syncronizing_archive::wait_for_frames(std::chrono::high_resolution_clock::duration timeout)
 {
     std::unique_lock<std::recursive_mutex> lock(mutex);
-    const auto ready = [this]() { return !frames[key_stream].empty(); };
-    if(!ready() && !cv.wait_for(lock, std::chrono::seconds(5), ready)) throw std::runtime_error("Timeout waiting for frames.");
-    get_next_frames();
+    return wait_for_frameset(lock, timeout);
 }
 
 // If a coherent frameset is available, obtain it and return true, otherwise return false immediately
 bool syncronizing_archive::poll_for_frames()
 {
-    // TODO: Implement a user-specifiable timeout for how long to wait before returning false?
     std::unique_lock<std::recursive_mutex> lock(mutex);
-    if(frames[key_stream].empty()) return false;
-    get_next_frames();
-    return true;
+    std::chrono::high_resolution_clock::time_point deadline;
+    while(is_frameset_ready(deadline)) if(get_next_frames()) return true;
+    update_ready_event();
+    return false;
 }
 
 frame_archive::frameset* syncronizing_archive::wait_for_frames_safe()
@@ -94,9 +120,7 @@ frame_archive::frameset* syncronizing_archive::wait_for_frames_safe()
     do
     {
         std::unique_lock<std::recursive_mutex> lock(mutex);
-        const auto ready = [this]() { return !frames[key_stream].empty(); };
-        if (!ready() && !cv.wait_for(lock, std::chrono::seconds(5), ready)) throw std::runtime_error("Timeout waiting for frames.");
-        get_next_frames();
+        if(!wait_for_frameset(lock, std::chrono::seconds(5))) throw std::runtime_error("Timeout waiting for frames.");
         result = clone_frontbuffer();
     } 
     while (!result);
@@ -105,10 +129,15 @@ frame_archive::frameset* syncronizing_archive::wait_for_frames_safe()
 
 bool syncronizing_archive::poll_for_frames_safe(frameset** frameset)
 {
-    // TODO: Implement a user-specifiable timeout for how long to wait before returning false?
     std::unique_lock<std::recursive_mutex> lock(mutex);
-    if (frames[key_stream].empty()) return false;
-    get_next_frames();
+    std::chrono::high_resolution_clock::time_point deadline;
+    bool delivered = false;
+    while(!delivered && is_frameset_ready(deadline)) delivered = get_next_frames();
+    if (!delivered)
+    {
+        update_ready_event();
+        return false;
+    }
     auto result = clone_frontbuffer();
     if (result)
     {
@@ -118,17 +147,91 @@ bool syncronizing_archive::poll_for_frames_safe(frameset** frameset)
     return false;
 }
 
-// Move frames from the queues to the frontbuffers to form the next coherent frameset
-void syncronizing_archive::get_next_frames()
+// Block, with the mutex held by lock, until a frameset has been moved to the frontbuffer or the timeout expires
+bool syncronizing_archive::wait_for_frameset(std::unique_lock<std::recursive_mutex> & lock, std::chrono::high_resolution_clock::duration timeout)
 {
+    const auto expiry = std::chrono::high_resolution_clock::now() + timeout;
+    while(true)
+    {
+        std::chrono::high_resolution_clock::time_point deadline = expiry;
+        if(is_frameset_ready(deadline))
+        {
+            if(get_next_frames()) return true;
+            continue;
+        }
+        if(std::chrono::high_resolution_clock::now() >= expiry)
+        {
+            update_ready_event();
+            return false;
+        }
+        cv.wait_until(lock, deadline);
+    }
+}
+
+// Keep the ready event readable exactly while a frameset can be formed. Frames which only become ready
+// by outliving the latency bound of the matching policies are signaled once the next frame arrives.
+void syncronizing_archive::update_ready_event()
+{
+    if(!ready_event) return;
+    auto deadline = std::chrono::high_resolution_clock::time_point::max();
+    if(is_frameset_ready(deadline)) ready_event->signal();
+    else ready_event->clear();
+}
+
+// Frame numbers must be equal under RS_SYNC_POLICY_FRAME_NUMBER, timestamps must be within the tolerance otherwise
+bool syncronizing_archive::is_match(frame & key, frame & other) const
+{
+    if(policy == RS_SYNC_POLICY_FRAME_NUMBER) return other.additional_data.frame_number == key.additional_data.frame_number;
+    return std::fabs(other.additional_data.timestamp - key.additional_data.timestamp) <= tolerance;
+}
+
+bool syncronizing_archive::is_at_or_after(frame & key, frame & other) const
+{
+    if(policy == RS_SYNC_POLICY_FRAME_NUMBER) return other.additional_data.frame_number >= key.additional_data.frame_number;
+    return other.additional_data.timestamp >= key.additional_data.timestamp;
+}
+
+// A frameset can be formed once every stream has a frame at or past the oldest key frame, or once that key frame has waited for max_latency.
+// If it cannot be formed yet, deadline is moved up to the moment the key frame times out.
+bool syncronizing_archive::is_frameset_ready(std::chrono::high_resolution_clock::time_point & deadline)
+{
+    if(frames[key_stream].empty()) return false;
+    if(policy == RS_SYNC_POLICY_NEAREST) return true;
+
+    const auto expiry = frames[key_stream].queued_at(0) + max_latency;
+    if(std::chrono::high_resolution_clock::now() >= expiry) return true;
+
+    auto & key = frames[key_stream].front();
+    bool ready = true;
+    for(auto s : other_streams) if(frames[s].empty() || !is_at_or_after(key, frames[s].back())) ready = false;
+    if(!ready) deadline = std::min(deadline, expiry);
+    return ready;
+}
+
+// Move frames from the queues to the frontbuffers to form the next coherent frameset. Returns false if the key frame was dropped instead.
+bool syncronizing_archive::get_next_frames()
+{
+    const bool delivered = policy == RS_SYNC_POLICY_NEAREST ? get_nearest_frames() : get_matching_frames();
+    update_ready_event();
+    return delivered;
+}
+
+bool syncronizing_archive::get_nearest_frames()
+{
+    const auto latency = std::chrono::high_resolution_clock::now() - frames[key_stream].queued_at(0);
+
     // Always dequeue a frame from the key stream
     dequeue_frame(key_stream);
 
     // Dequeue from other streams if the new frame is closer to the timestamp of the key stream than the old frame
+    bool complete = true;
     for(auto s : other_streams)
     {
         if (frames[s].empty())
+        {
+            complete = false;
             continue;
+        }
 
         auto timestamp_of_new_frame = frames[s].front().additional_data.timestamp;
         auto timestamp_of_old_frame = frontbuffer.get_frame_timestamp(s);
@@ -138,23 +241,78 @@ void syncronizing_archive::get_next_frames()
         {
             dequeue_frame(s);
         }
+        else complete = false;
     }
+    count_frameset(complete, latency);
+    return true;
+}
+
+bool syncronizing_archive::get_matching_frames()
+{
+    auto & key = frames[key_stream].front();
+    const auto latency = std::chrono::high_resolution_clock::now() - frames[key_stream].queued_at(0);
+
+    // Find the best match for the key frame in every other stream, discarding frames that are too old to match this or any later key frame
+    int matches[RS_STREAM_NATIVE_COUNT];
+    bool complete = true;
+    for(auto s : other_streams)
+    {
+        while(!frames[s].empty() && !is_match(key, frames[s].front()) && !is_at_or_after(key, frames[s].front())) discard_frame(s);
+
+        matches[s] = -1;
+        for(int i = 0; i < (int)frames[s].size() && is_match(key, frames[s][i]); ++i)
+        {
+            if(matches[s] < 0 || std::fabs(frames[s][i].additional_data.timestamp - key.additional_data.timestamp) <
+                                 std::fabs(frames[s][matches[s]].additional_data.timestamp - key.additional_data.timestamp)) matches[s] = i;
+        }
+        if(matches[s] < 0) complete = false;
+    }
+
+    if(!complete && policy == RS_SYNC_POLICY_COMPLETE)
+    {
+        discard_frame(key_stream);
+        if(counters) ++counters->dropped;
+        return false;
+    }
+
+    dequeue_frame(key_stream);
+    for(auto s : other_streams)
+    {
+        if(matches[s] < 0) continue;
+        for(int i = 0; i < matches[s]; ++i) discard_frame(s);
+        dequeue_frame(s);
+    }
+
+    count_frameset(complete, latency);
+    return true;
+}
+
+void syncronizing_archive::count_frameset(bool complete, std::chrono::high_resolution_clock::duration latency)
+{
+    if(!counters) return;
+    ++counters->framesets;
+    if(!complete) ++counters->incomplete;
+    counters->total_latency += std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
 }
 
 // Move a frame from the backbuffer to the back of the queue
 void syncronizing_archive::commit_frame(rs_stream stream)
 {
     std::unique_lock<std::recursive_mutex> lock(mutex);
+    if(frames[stream].full()) discard_frame(stream); // Never keep more than the queue size of the stream, regardless of timestamps
     frames[stream].push_back(std::move(backbuffer[stream]));
     cull_frames();
+    update_ready_event();
+    const bool notify = !frames[key_stream].empty();
     lock.unlock();
-    if(!frames[key_stream].empty()) cv.notify_one();
+    if(notify) cv.notify_one();
 }
 
 void syncronizing_archive::flush()
 {
     frontbuffer.cleanup(); // frontbuffer also holds frame references, since its content is publicly available through get_frame_data
     frame_archive::flush();
+    if(ready_event) ready_event->clear();
 }
 
 void syncronizing_archive::correct_timestamp(rs_stream stream)
@@ -178,14 +336,8 @@ int syncronizing_archive::get_frame_stride(rs_stream stream) const
 // Discard all frames which are older than the most recent coherent frameset
 void syncronizing_archive::cull_frames()
 {
-    // Never keep more than four frames around in any given stream, regardless of timestamps
-    for(auto s : {RS_STREAM_DEPTH, RS_STREAM_COLOR, RS_STREAM_INFRARED, RS_STREAM_INFRARED2, RS_STREAM_FISHEYE})
-    {
-        while(frames[s].size() > 4)
-        {
-            discard_frame(s);
-        }
-    }
+    // The matching policies discard frames themselves when a frameset is formed
+    if(policy != RS_SYNC_POLICY_NEAREST) return;
 
     // Cannot do any culling unless at least one frame is enqueued for each enabled stream    
     if(frames[key_stream].empty()) return;
@@ -225,7 +377,7 @@ void syncronizing_archive::cull_frames()
     }
 }
 
-// Move a single frame from the head of the queue to the front buffer, while recycling the front buffer into the freelist
+// Move a single frame from the head of the queue to the front buffer, while recycling the front buffer into its pool
 void syncronizing_archive::dequeue_frame(rs_stream stream)
 {
     auto & frame = frames[stream].front();
@@ -237,13 +389,67 @@ void syncronizing_archive::dequeue_frame(rs_stream stream)
     LOG_DEBUG("CallbackStarted," << rsimpl::get_string(frame.get_stream_type()) << "," << frame.get_frame_number() << ",DispatchedAt," << ts);
 
     frontbuffer.place_frame(stream, std::move(frames[stream].front())); // the frame will move to free list once there are no external references to it
-    frames[stream].erase(begin(frames[stream]));
+    frames[stream].pop_front();
 }
 
-// Move a single frame from the head of the queue directly to the freelist
+// Drop a single frame from the head of the queue, recycling its buffer
 void syncronizing_archive::discard_frame(rs_stream stream)
 {
     std::lock_guard<std::recursive_mutex> guard(mutex);
-    freelist.push_back(std::move(frames[stream].front()));
-    frames[stream].erase(begin(frames[stream]));
+    recycle_frame(frames[stream].front());
+    frames[stream].pop_front();
+}
+
+#ifdef _WIN32
+frameset_event::frameset_event() : read_fd(-1), write_fd(-1), signaled(false) {}
+frameset_event::~frameset_event() {}
+#else
+frameset_event::frameset_event() : read_fd(-1), write_fd(-1), signaled(false)
+{
+#ifdef __linux__
+    read_fd = write_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(read_fd < 0) throw std::runtime_error("eventfd(...) failed");
+#else
+    int fds[2];
+    if(pipe(fds) < 0) throw std::runtime_error("pipe(...) failed");
+    for(auto fd : fds)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd = fds[0];
+    write_fd = fds[1];
+#endif
+}
+
+frameset_event::~frameset_event()
+{
+    close(read_fd);
+    if(write_fd != read_fd) close(write_fd);
+}
+#endif
+
+int frameset_event::get_fd() const
+{
+    if(read_fd < 0) throw std::runtime_error("frame notification descriptors are not supported on this platform");
+    return read_fd;
+}
+
+// Write to and read from the descriptor only on transitions, so that it holds at most one pending event
+void frameset_event::signal()
+{
+    if(read_fd < 0 || signaled.exchange(true)) return;
+#ifndef _WIN32
+    uint64_t one = 1;
+    if(write(write_fd, &one, write_fd == read_fd ? sizeof(one) : 1) < 0) LOG_WARNING("Failed to signal frameset event");
+#endif
+}
+
+void frameset_event::clear()
+{
+    if(read_fd < 0 || !signaled.exchange(false)) return;
+#ifndef _WIN32
+    uint64_t value;
+    if(read(read_fd, &value, write_fd == read_fd ? sizeof(value) : 1) < 0) LOG_WARNING("Failed to clear frameset event");
+#endif
 }
@@ -48,6 +48,47 @@ namespace rsimpl
         std::vector<std::chrono::time_point<std::chrono::system_clock>> _time_samples;
     };
 
+    // Fixed-capacity FIFO of frames waiting to be matched into a frameset. Frames are moved in and out of their slots, never shifted.
+    class frame_queue
+    {
+        std::vector<frame_archive::frame> slots;
+        std::vector<std::chrono::high_resolution_clock::time_point> times; // When the frame in each slot was queued
+        size_t head, count;
+    public:
+        frame_queue() : head(0), count(0) {}
+
+        // Not thread safe, must be called before frames are queued
+        void reset(size_t capacity) { slots.resize(capacity); times.resize(capacity); head = count = 0; }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        bool full() const { return count == slots.size(); }
+
+        frame_archive::frame & operator[](size_t i) { return slots[(head + i) % slots.size()]; }
+        frame_archive::frame & front() { return (*this)[0]; }
+        frame_archive::frame & back() { return (*this)[count - 1]; }
+
+        std::chrono::high_resolution_clock::time_point queued_at(size_t i) const { return times[(head + i) % slots.size()]; }
+
+        void push_back(frame_archive::frame && f) { assert(!full()); times[(head + count) % slots.size()] = std::chrono::high_resolution_clock::now(); (*this)[count] = std::move(f); ++count; }
+        void pop_front() { front() = frame_archive::frame(); head = (head + 1) % slots.size(); --count; } // Frees whatever the popped frame still holds
+    };
+
+    // File descriptor which is readable while a coherent frameset is ready, for waiting on frames from a poll/select/epoll loop.
+    // Backed by an eventfd on Linux and a pipe on other POSIX systems, unavailable on Windows.
+    class frameset_event
+    {
+        int read_fd, write_fd;
+        std::atomic<bool> signaled;
+    public:
+        frameset_event();
+        ~frameset_event();
+
+        int get_fd() const;
+        void signal();
+        void clear();
+    };
+
     class syncronizing_archive : public frame_archive
     {
     private:
@@ -60,10 +101,25 @@ namespace rsimpl
         frameset frontbuffer;
 
         // This data will be read and written by all threads, and synchronized with a mutex
-        std::vector<frame> frames[RS_STREAM_NATIVE_COUNT];
+        frame_queue frames[RS_STREAM_NATIVE_COUNT];
         std::condition_variable_any cv;
-        
-        void get_next_frames();
+
+        // The matching policy, with its tolerance and latency resolved against the frame rate of the key stream
+        rs_sync_policy policy;
+        double tolerance;
+        std::chrono::microseconds max_latency;
+        sync_counters * counters;
+        frameset_event * ready_event;
+
+        bool is_match(frame & key, frame & other) const;
+        bool is_at_or_after(frame & key, frame & other) const;
+        bool is_frameset_ready(std::chrono::high_resolution_clock::time_point & deadline);
+        bool wait_for_frameset(std::unique_lock<std::recursive_mutex> & lock, std::chrono::high_resolution_clock::duration timeout);
+        void update_ready_event();
+        bool get_next_frames();
+        bool get_nearest_frames();
+        bool get_matching_frames();
+        void count_frameset(bool complete, std::chrono::high_resolution_clock::duration latency);
         void dequeue_frame(rs_stream stream);
         void discard_frame(rs_stream stream);
         void cull_frames();
@@ -72,13 +128,20 @@ namespace rsimpl
     public:
         syncronizing_archive(const std::vector<subdevice_mode_selection> & selection, 
             rs_stream key_stream, 
+            const int (&queue_sizes)[RS_STREAM_NATIVE_COUNT],
+            const sync_settings & settings,
+            sync_counters * counters,
+            frameset_event * ready_event,
             std::atomic<uint32_t>* max_size,
             std::atomic<uint32_t>* event_queue_size,
             std::atomic<uint32_t>* events_timeout,
+            frame_pool_counters* pool_counters,
+            frame_allocator_ptr allocator,
             std::chrono::high_resolution_clock::time_point capture_started = std::chrono::high_resolution_clock::now());
         
         // Application thread API
         void wait_for_frames();
+        bool wait_for_frames(std::chrono::high_resolution_clock::duration timeout);
         bool poll_for_frames();
 
         frameset * wait_for_frames_safe();
@@ -12,6 +12,14 @@
 #include <algorithm>
 #include <iomanip>
 
+#ifdef RS_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>     // For __cpuid, __cpuidex, _xgetbv
+#else
+#include <cpuid.h>      // For __cpuid, __cpuid_count
+#endif
+#endif
+
 #define unknown "UNKNOWN" 
 
 namespace rsimpl
@@ -32,6 +40,7 @@ namespace rsimpl
         CASE(DEPTH_ALIGNED_TO_RECTIFIED_COLOR)
         CASE(INFRARED2_ALIGNED_TO_DEPTH)
         CASE(DEPTH_ALIGNED_TO_INFRARED2)
+        CASE(COLORED_POINTS)
         CASE(FISHEYE)
         default: assert(!is_valid(value)); return unknown;
         }
@@ -57,6 +66,9 @@ namespace rsimpl
         CASE(RAW10)
         CASE(RAW16)
         CASE(RAW8)
+        CASE(XYZ16F)
+        CASE(XYZ16)
+        CASE(XYZRGB)
         default: assert(!is_valid(value)); return unknown;
         }
         #undef CASE
@@ -156,6 +168,29 @@ namespace rsimpl
         CASE(FISHEYE_EXTERNAL_TRIGGER)
         CASE(FRAMES_QUEUE_SIZE)
         CASE(TOTAL_FRAME_DROPS)
+        CASE(FRAME_POOL_HITS)
+        CASE(FRAME_POOL_MISSES)
+        CASE(FRAME_POOL_EVICTIONS)
+        CASE(CAPTURE_BUFFERS_COUNT)
+        CASE(ZERO_COPY_ENABLED)
+        CASE(CAPTURE_THREAD_PER_SUBDEVICE)
+        CASE(CAPTURE_THREAD_AFFINITY)
+        CASE(CAPTURE_THREAD_PRIORITY)
+        CASE(UNPACK_THREADS)
+        CASE(LAZY_UNPACK_ENABLED)
+        CASE(ALIGNMENT_THREADS)
+        CASE(INCREMENTAL_ALIGNMENT_ENABLED)
+        CASE(COMPACT_POINT_CLOUD_ENABLED)
+        CASE(SYNC_QUEUE_SIZE)
+        CASE(SYNC_POLICY)
+        CASE(SYNC_TOLERANCE)
+        CASE(SYNC_MAX_LATENCY)
+        CASE(SYNC_FRAMESETS)
+        CASE(SYNC_INCOMPLETE_FRAMESETS)
+        CASE(SYNC_DROPPED_FRAMES)
+        CASE(SYNC_AVERAGE_LATENCY)
+        CASE(FRAME_CAPACITY_DROPS)
+        CASE(BILINEAR_RECTIFICATION_ENABLED)
         CASE(FISHEYE_ENABLE_AUTO_EXPOSURE)
         CASE(FISHEYE_AUTO_EXPOSURE_MODE)
         CASE(FISHEYE_AUTO_EXPOSURE_ANTIFLICKER_RATE)
@@ -267,6 +302,34 @@ namespace rsimpl
         {
         CASE(ACTUAL_EXPOSURE)
         CASE(ACTUAL_FPS)
+        CASE(DMABUF_FD)
+        default: assert(!is_valid(value)); return unknown;
+        }
+        #undef CASE
+    }
+
+    const char * get_string(rs_capture_memory value)
+    {
+        #define CASE(X) case RS_CAPTURE_MEMORY_##X: return #X;
+        switch (value)
+        {
+        CASE(MMAP)
+        CASE(USERPTR)
+        CASE(DMABUF)
+        default: assert(!is_valid(value)); return unknown;
+        }
+        #undef CASE
+    }
+
+    const char * get_string(rs_sync_policy value)
+    {
+        #define CASE(X) case RS_SYNC_POLICY_##X: return #X;
+        switch (value)
+        {
+        CASE(NEAREST)
+        CASE(FRAME_NUMBER)
+        CASE(WINDOW)
+        CASE(COMPLETE)
         default: assert(!is_valid(value)); return unknown;
         }
         #undef CASE
@@ -294,7 +357,7 @@ namespace rsimpl
         output_format = in_output_format;
     }
 
-    void subdevice_mode_selection::unpack(byte * const dest[], const byte * source) const
+    void subdevice_mode_selection::unpack(byte * const dest[], const byte * source, worker_pool * pool) const
     {
         const int MAX_OUTPUTS = 2;
         const auto & outputs = get_outputs();        
@@ -317,22 +380,46 @@ namespace rsimpl
 
         // Unpack (potentially a subrect of) the source image into (potentially a subrect of) the destination buffers
         const int unpack_width = get_unpacked_width(), unpack_height = get_unpacked_height();
+        const auto & unpacker = mode.pf.unpackers[unpacker_index];
         if(mode.native_dims.x == get_width())
         {
-            // If not strided, unpack as though it were a single long row
-            mode.pf.unpackers[unpacker_index].unpack(out, in, unpack_width * unpack_height);
+            // If not strided, unpack as though it were a single long row. Bands must start on a byte in every buffer, so bit-packed formats are
+            // unpacked in one go, as are planar ones.
+            bool byte_aligned = true;
+            for(auto & output : outputs) byte_aligned = byte_aligned && get_image_bpp(output.second) % 8 == 0;
+            if(!pool || mode.pf.plane_count != 1 || !byte_aligned)
+            {
+                unpacker.unpack(out, in, unpack_width * unpack_height);
+                return;
+            }
+
+            // Rows are contiguous in both buffers, so each band is the same long row starting further along
+            pool->parallel_for(unpack_height, [&](int begin, int end)
+            {
+                const int offset = begin * unpack_width;
+                byte * band_out[MAX_OUTPUTS];
+                for(size_t i=0; i<outputs.size(); ++i) band_out[i] = out[i] + rsimpl::get_image_size(offset, 1, outputs[i].second);
+                unpacker.unpack(band_out, in + mode.pf.get_image_size(offset, 1), (end - begin) * unpack_width);
+            });
         }
         else
         {
-            
             // Otherwise unpack one row at a time
             assert(mode.pf.plane_count == 1); // Can't unpack planar formats row-by-row (at least not with the current architecture, would need to pass multiple source ptrs to unpack)
-            for(int i=0; i<unpack_height; ++i)
+            auto unpack_rows = [&](int begin, int end)
             {
-                mode.pf.unpackers[unpacker_index].unpack(out, in, unpack_width);
-                for(size_t i=0; i<outputs.size(); ++i) out[i] += out_stride[i];
-                in += in_stride;
-            }
+                byte * row_out[MAX_OUTPUTS];
+                for(size_t i=0; i<outputs.size(); ++i) row_out[i] = out[i] + out_stride[i] * begin;
+                const byte * row_in = in + in_stride * begin;
+                for(int y=begin; y<end; ++y)
+                {
+                    unpacker.unpack(row_out, row_in, unpack_width);
+                    for(size_t i=0; i<outputs.size(); ++i) row_out[i] += out_stride[i];
+                    row_in += in_stride;
+                }
+            };
+            if(pool) pool->parallel_for(unpack_height, unpack_rows);
+            else unpack_rows(0, unpack_height);
         }
     }
 
@@ -727,4 +814,133 @@ namespace rsimpl
         return intrinsic_validator(stream);
     }
 
+#ifdef RS_SIMD_X86
+    static void cpuid(unsigned leaf, unsigned subleaf, unsigned (&regs)[4])
+    {
+#ifdef _MSC_VER
+        int r[4];
+        __cpuidex(r, leaf, subleaf);
+        for (int i = 0; i < 4; ++i) regs[i] = r[i];
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    }
+
+    static unsigned long long xgetbv()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        unsigned eax, edx;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (unsigned long long)edx << 32 | eax;
+#endif
+    }
+#endif
+
+    simd_level get_supported_simd_level()
+    {
+#ifdef RS_SIMD_X86
+        unsigned regs[4];
+        cpuid(0, 0, regs);
+        auto max_leaf = regs[0];
+
+        cpuid(1, 0, regs);
+        if (!(regs[2] & (1 << 9))) return simd_level::generic;                                          // SSSE3
+        if (!(regs[2] & (1 << 27)) || !(regs[2] & (1 << 28)) || !(regs[2] & (1 << 29)) || max_leaf < 7) return simd_level::ssse3; // OSXSAVE, AVX, F16C
+
+        // The operating system must save the YMM (and for AVX-512, the opmask and ZMM) registers on context switches
+        auto xcr0 = xgetbv();
+        cpuid(7, 0, regs);
+        if ((xcr0 & 0x6) != 0x6 || !(regs[1] & (1 << 5))) return simd_level::ssse3; // AVX2
+        if ((xcr0 & 0xe6) != 0xe6 || !(regs[1] & (1 << 16)) || !(regs[1] & (1u << 30))) return simd_level::avx2; // AVX512F, AVX512BW
+        return simd_level::avx512bw;
+#elif defined(RS_SIMD_NEON)
+        return simd_level::neon;
+#else
+        return simd_level::generic;
+#endif
+    }
+
+    static std::atomic<simd_level> & current_simd_level()
+    {
+        static std::atomic<simd_level> level(get_supported_simd_level());
+        return level;
+    }
+
+    simd_level get_simd_level()
+    {
+        return current_simd_level().load(std::memory_order_relaxed);
+    }
+
+    void set_simd_level(simd_level level)
+    {
+        current_simd_level() = std::min(level, get_supported_simd_level());
+    }
+
+    worker_pool::worker_pool(int thread_count)
+    {
+        for(int i = 1; i < thread_count; ++i) workers.push_back(std::thread([this, i]() { run(i); }));
+    }
+
+    worker_pool::~worker_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        work_cv.notify_all();
+        for(auto & worker : workers) worker.join();
+    }
+
+    void worker_pool::run(int band)
+    {
+        uint64_t seen = 0;
+        while(true)
+        {
+            const std::function<void(int, int)> * body;
+            int count, bands;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_cv.wait(lock, [&]() { return stopping || generation != seen; });
+                if(stopping) return;
+                seen = generation;
+                body = job;
+                count = job_count;
+                bands = job_bands;
+            }
+
+            if(band < bands) (*body)(count * band / bands, count * (band + 1) / bands);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--pending == 0) done_cv.notify_one();
+        }
+    }
+
+    void worker_pool::parallel_for(int count, const std::function<void(int begin, int end)> & body)
+    {
+        std::unique_lock<std::mutex> exclusive(busy, std::try_to_lock);
+        if(workers.empty() || count < 2 || !exclusive.owns_lock())
+        {
+            body(0, count);
+            return;
+        }
+
+        const int bands = std::min(count, get_thread_count());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            job_count = count;
+            job_bands = bands;
+            pending = (int)workers.size();
+            ++generation;
+        }
+        work_cv.notify_all();
+
+        body(0, count / bands);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [this]() { return pending == 0; });
+        job = nullptr;
+    }
 }
@@ -18,6 +18,7 @@
 #include <sstream>                          // For ostringstream
 #include <mutex>                            // For mutex, unique_lock
 #include <condition_variable>               // For condition_variable
+#include <thread>                           // For thread
 #include <memory>                           // For unique_ptr
 #include <atomic>
 #include <map>          
@@ -25,7 +26,17 @@
 #include <functional>
 
 const uint8_t RS_STREAM_NATIVE_COUNT    = 5;
-const int RS_USER_QUEUE_SIZE = 20;
+const int RS_USER_QUEUE_SIZE = 20;        // Default number of frames the user may hold per stream
+const int RS_MAX_USER_QUEUE_SIZE = 128;
+const int RS_DEFAULT_CAPTURE_BUFFERS = 4; // Number of buffers each subdevice streams into on the driver side
+const int RS_MAX_CAPTURE_BUFFERS = 32;
+const int RS_DEFAULT_SYNC_QUEUE_SIZE = 4; // Number of frames each stream keeps queued to be matched into framesets
+const int RS_MAX_SYNC_QUEUE_SIZE = 32;
+
+// Frame buffer recycling settings:
+const int RS_FRAME_POOL_SIZE = 8;          // Max number of idle frame buffers kept for reuse per native stream (must be a power of two)
+const int RS_FRAME_POOL_PREALLOCATED = 4;  // Number of frame buffers allocated up-front for each stream that requires processing
+const size_t RS_FRAME_BUFFER_ALIGNMENT = 64; // Alignment in bytes of every frame buffer, allowing aligned SIMD loads by consumers
 
 // Timestamp syncronization settings:
 const int RS_MAX_EVENT_QUEUE_SIZE = 500;  // Max number of timestamp events to keep for all streams
@@ -100,8 +111,62 @@ namespace rsimpl
     RS_ENUM_HELPERS(rs_camera_info, CAMERA_INFO)
     RS_ENUM_HELPERS(rs_timestamp_domain, TIMESTAMP_DOMAIN)
     RS_ENUM_HELPERS(rs_frame_metadata, FRAME_METADATA)
+    RS_ENUM_HELPERS(rs_capture_memory, CAPTURE_MEMORY)
+    RS_ENUM_HELPERS(rs_sync_policy, SYNC_POLICY)
     #undef RS_ENUM_HELPERS
 
+    //////////////////////////
+    // Runtime CPU dispatch //
+    //////////////////////////
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#define RS_SIMD_X86
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && defined(RS_ENABLE_NEON) // Opt-in until the NEON kernels are validated on hardware, see ENABLE_NEON in CMakeLists.txt
+#define RS_SIMD_NEON
+#endif
+
+// Compiles a single function for an instruction set extension the rest of the library is not built for. Such functions
+// must only be called after get_simd_level() has confirmed the extension is available. MSVC needs no annotation.
+#if defined(RS_SIMD_X86) && !defined(_MSC_VER)
+#define RS_TARGET(ISA) __attribute__((target(ISA)))
+#else
+#define RS_TARGET(ISA)
+#endif
+
+// Inlines a template shared by the kernels of several instruction sets into each of them, so that it is compiled for that instruction set
+#ifdef _MSC_VER
+#define RS_ALWAYS_INLINE __forceinline
+#else
+#define RS_ALWAYS_INLINE inline __attribute__((always_inline))
+#endif
+
+    enum class simd_level { generic, ssse3, avx2, avx512bw, neon }; // Instruction set extensions used by image processing kernels. The x86 levels are in increasing order, NEON is the only level above generic on ARM. The avx2 level includes F16C.
+
+    simd_level get_supported_simd_level();      // Highest level supported by both this CPU and the operating system
+    simd_level get_simd_level();                // Level the image processing kernels currently dispatch to
+    void set_simd_level(simd_level level);      // Caps dispatching at the given level, clamped to the supported level. Intended for validation.
+
+    // Fixed set of threads which split a range of work into contiguous bands, with the calling thread processing the first band itself.
+    // A pool serves one parallel_for() at a time, concurrent callers process their whole range on their own thread instead of waiting.
+    class worker_pool
+    {
+        std::vector<std::thread> workers;
+        std::mutex busy, mutex;
+        std::condition_variable work_cv, done_cv;
+        const std::function<void(int, int)> * job = nullptr;
+        int job_count = 0, job_bands = 0, pending = 0;
+        uint64_t generation = 0;
+        bool stopping = false;
+
+        void run(int band);
+    public:
+        explicit worker_pool(int thread_count); // Including the calling thread, so thread_count - 1 workers are started
+        ~worker_pool();
+
+        int get_thread_count() const { return (int)workers.size() + 1; }
+        void parallel_for(int count, const std::function<void(int begin, int end)> & body);
+    };
+
     ////////////////////////////////////////////
     // World's tiniest linear algebra library //
     ////////////////////////////////////////////
@@ -174,6 +239,13 @@ namespace rsimpl
         bool is_filled() const;
     };
 
+    struct capture_request
+    {
+        int buffer_count = 0;                                   // 0 selects RS_OPTION_CAPTURE_BUFFERS_COUNT
+        rs_capture_memory memory = RS_CAPTURE_MEMORY_MMAP;
+        int sync_queue_size = 0;                                // 0 selects RS_OPTION_SYNC_QUEUE_SIZE
+    };
+
     struct interstream_rule // Requires a.*field + delta == b.*field OR a.*field + delta2 == b.*field
     {
         rs_stream a, b;
@@ -296,6 +368,7 @@ namespace rsimpl
         int pad_crop;                           // The number of pixels of padding (positive values) or cropping (negative values) to apply to all four edges of the image
         size_t unpacker_index;                  // The specific unpacker used to unpack the encoded format into the desired output formats
         rs_output_buffer_format output_format = RS_OUTPUT_BUFFER_FORMAT_CONTINUOUS; // The output buffer format. 
+        bool zero_copy = false;                 // Pass the driver's buffer through whenever its layout already matches the requested output
 
         subdevice_mode_selection() : mode({}), pad_crop(), unpacker_index(), output_format(RS_OUTPUT_BUFFER_FORMAT_CONTINUOUS){}
         subdevice_mode_selection(const subdevice_mode & mode, int pad_crop, int unpacker_index) : mode(mode), pad_crop(pad_crop), unpacker_index(unpacker_index){}
@@ -316,11 +389,12 @@ namespace rsimpl
         rs_format get_format(rs_stream stream) const { return get_unpacker().get_format(stream); }
         void set_output_buffer_format(const rs_output_buffer_format in_output_format);
 
-        void unpack(byte * const dest[], const byte * source) const;
+        void unpack(byte * const dest[], const byte * source, worker_pool * pool = nullptr) const; // Splits the image into row bands across the pool if one is given
         int get_unpacked_width() const;
         int get_unpacked_height() const;
 
-        bool requires_processing() const { return (output_format == RS_OUTPUT_BUFFER_FORMAT_CONTINUOUS) || (mode.pf.unpackers[unpacker_index].requires_processing); }
+        bool requires_processing() const { return (output_format == RS_OUTPUT_BUFFER_FORMAT_CONTINUOUS && !(zero_copy && is_natively_continuous())) || (mode.pf.unpackers[unpacker_index].requires_processing); }
+        bool is_natively_continuous() const { return pad_crop == 0 && mode.native_dims.x == mode.native_intrinsics.width && mode.native_dims.y == mode.native_intrinsics.height; }
 
     };
 
@@ -328,6 +402,8 @@ namespace rsimpl
     typedef void(*motion_callback_function_ptr)(rs_device * dev, rs_motion_data data, void * user);
     typedef void(*timestamp_callback_function_ptr)(rs_device * dev, rs_timestamp_data data, void * user);
     typedef void(*log_callback_function_ptr)(rs_log_severity severity, const char * message, void * user);
+    typedef void *(*frame_alloc_function_ptr)(rs_device * dev, unsigned int size, unsigned int alignment, void * user);
+    typedef void(*frame_free_function_ptr)(rs_device * dev, void * ptr, unsigned int size, void * user);
 
     class frame_callback : public rs_frame_callback
     {
@@ -423,7 +499,37 @@ namespace rsimpl
         void release() override { }
     };
 
+    class frame_allocator : public rs_frame_allocator
+    {
+        frame_alloc_function_ptr alloc_fptr;
+        frame_free_function_ptr free_fptr;
+        void        * user;
+        rs_device   * device;
+    public:
+        frame_allocator(rs_device * dev, frame_alloc_function_ptr on_alloc, frame_free_function_ptr on_free, void * user) : alloc_fptr(on_alloc), free_fptr(on_free), user(user), device(dev) {}
+
+        void * allocate(size_t size, size_t alignment) override
+        {
+            try { return alloc_fptr(device, (unsigned int)size, (unsigned int)alignment, user); } catch (...)
+            {
+                LOG_ERROR("Received an exception from frame allocator!");
+                return nullptr;
+            }
+        }
+
+        void deallocate(void * ptr, size_t size) override
+        {
+            try { free_fptr(device, ptr, (unsigned int)size, user); } catch (...)
+            {
+                LOG_ERROR("Received an exception from frame deallocator!");
+            }
+        }
+
+        void release() override { delete this; }
+    };
+
     typedef std::unique_ptr<rs_log_callback, void(*)(rs_log_callback*)> log_callback_ptr;
+    typedef std::shared_ptr<rs_frame_allocator> frame_allocator_ptr;
     typedef std::unique_ptr<rs_motion_callback, void(*)(rs_motion_callback*)> motion_callback_ptr;
     typedef std::unique_ptr<rs_timestamp_callback, void(*)(rs_timestamp_callback*)> timestamp_callback_ptr;
     class frame_callback_ptr
@@ -453,6 +559,8 @@ namespace rsimpl
         data_polling_request                data_request;                                           // Modified by enable/disable_events calls
         motion_callback_ptr                 motion_callback{ nullptr, [](rs_motion_callback*){} };  // Modified by set_events_callback calls
         timestamp_callback_ptr              timestamp_callback{ nullptr, [](rs_timestamp_callback*){} };
+        frame_allocator_ptr                 allocator;                                              // Modified by set_frame_allocator calls
+        capture_request                     capture_requests[RS_STREAM_NATIVE_COUNT];               // Modified by set_stream_capture_buffers and set_stream_sync_queue_size calls
         float depth_scale;                                              // Scale of depth values
 
         explicit device_config(const rsimpl::static_device_info & info) : info(info), depth_scale(info.nominal_depth_scale)
@@ -486,75 +594,134 @@ namespace rsimpl
     }
 
     inline bool operator == (const rs_intrinsics & a, const rs_intrinsics & b) { return std::memcmp(&a, &b, sizeof(a)) == 0; }
+    inline bool operator == (const rs_extrinsics & a, const rs_extrinsics & b) { return std::memcmp(&a, &b, sizeof(a)) == 0; }
 
     inline uint32_t pack(uint8_t c0, uint8_t c1, uint8_t c2, uint8_t c3)
     {
         return (c0 << 24) | (c1 << 16) | (c2 << 8) | c3;
     }
 
-    template<class T, int C>
+    // Frame buffer recycling statistics, owned by the device so that they persist across streaming sessions
+    struct frame_pool_counters
+    {
+        std::atomic<uint32_t> hits;         // Frame buffers served from the pool
+        std::atomic<uint32_t> misses;       // Frame buffers that had to be allocated
+        std::atomic<uint32_t> evictions;    // Released frame buffers that could not be retained by the pool
+        std::atomic<uint32_t> exhausted;    // Frames, framesets and references withheld because the published capacity was in use
+
+        frame_pool_counters() : hits(0), misses(0), evictions(0), exhausted(0) {}
+    };
+
+    // How the synchronizing archive matches frames into framesets. Tolerance and latency are in milliseconds, 0 selects the defaults of the options.
+    struct sync_settings
+    {
+        rs_sync_policy policy = RS_SYNC_POLICY_NEAREST;
+        double tolerance = 0;
+        double max_latency = 0;
+    };
+
+    struct sync_counters
+    {
+        std::atomic<uint32_t> framesets;            // Framesets delivered to the application
+        std::atomic<uint32_t> incomplete;           // Delivered framesets in which some stream kept its previous frame
+        std::atomic<uint32_t> dropped;              // Key stream frames dropped for lack of a match in every stream
+        std::atomic<uint64_t> total_latency;        // Microseconds the key stream frames of delivered framesets were queued, summed
+
+        sync_counters() : framesets(0), incomplete(0), dropped(0), total_latency(0) {}
+    };
+
+    // Lock-free LIFO of slot indices in [0, capacity). The head index is packed with a generation tag to rule out ABA.
+    class index_stack
+    {
+        static const uint32_t nil = 0xFFFFFFFF;
+        std::atomic<uint64_t> head;
+        std::unique_ptr<std::atomic<uint32_t>[]> next;
+
+        static uint64_t make_head(uint64_t prev, uint32_t index) { return (((prev >> 32) + 1) << 32) | index; }
+    public:
+        explicit index_stack(int capacity) : head(nil), next(new std::atomic<uint32_t>[capacity]) { for (auto i = 0; i < capacity; i++) next[i] = nil; }
+
+        void push(uint32_t index)
+        {
+            auto h = head.load(std::memory_order_relaxed);
+            do next[index].store((uint32_t)h, std::memory_order_relaxed);
+            while (!head.compare_exchange_weak(h, make_head(h, index), std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        bool pop(uint32_t & index)
+        {
+            auto h = head.load(std::memory_order_acquire);
+            while ((uint32_t)h != nil)
+            {
+                auto n = next[(uint32_t)h].load(std::memory_order_relaxed);
+                if (head.compare_exchange_weak(h, make_head(h, n), std::memory_order_acquire, std::memory_order_acquire))
+                {
+                    index = (uint32_t)h;
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    // Slab of objects with lock-free O(1) allocation and deallocation, whose capacity is chosen on construction.
+    // The mutex is only taken to wake a thread waiting for the slab to drain.
+    template<class T>
     class small_heap
     {
-        T buffer[C];
-        bool is_free[C];
+        std::unique_ptr<T[]> buffer;
+        const int capacity;
+        index_stack free_slots;
+        std::atomic<bool> keep_allocating;
+        std::atomic<int> size;
         std::mutex mutex;
-        bool keep_allocating = true;
         std::condition_variable cv;
-        int size = 0;
 
-    public:
-        small_heap()
+        void leave()
         {
-            for (auto i = 0; i < C; i++)
+            if (--size == 0)
             {
-                is_free[i] = true;
-                buffer[i] = std::move(T());
+                std::lock_guard<std::mutex> lock(mutex); // Orders the notification after a concurrent waiter's check of the size
+                cv.notify_all();
             }
         }
 
-        T * allocate()
+    public:
+        explicit small_heap(int capacity) : buffer(new T[capacity]), capacity(capacity), free_slots(capacity), keep_allocating(true), size(0)
         {
-            std::unique_lock<std::mutex> lock(mutex);
-            if (!keep_allocating) return nullptr;
+            for (auto i = capacity; i-- > 0; ) free_slots.push(i); // Hand out the lowest slots first
+        }
+
+        int get_capacity() const { return capacity; }
+        bool is_allocating() const { return keep_allocating; }
 
-            for (auto i = 0; i < C; i++)
+        T * allocate()
+        {
+            // Count the item before checking the flag, so that wait_until_empty either sees it or it sees stop_allocation
+            ++size;
+            uint32_t i;
+            if (!keep_allocating || !free_slots.pop(i))
             {
-                if (is_free[i])
-                {
-                    is_free[i] = false;
-                    size++;
-                    return &buffer[i];
-                }
+                leave();
+                return nullptr;
             }
-            return nullptr;
+            return &buffer[i];
         }
 
         void deallocate(T * item)
         {
-             if (item < buffer || item >= buffer + C)
+            if (item < buffer.get() || item >= buffer.get() + capacity)
             {
                 throw std::runtime_error("Trying to return item to a heap that didn't allocate it!");
             }
-            auto i = item - buffer;
+            auto i = item - buffer.get();
             buffer[i] = std::move(T());
-            
-            {
-                std::unique_lock<std::mutex> lock(mutex);
-
-                is_free[i] = true;
-                size--;
-
-                if (size == 0)
-                {
-                    lock.unlock();
-                    cv.notify_one();
-                }
-            }
+            free_slots.push((uint32_t)i);
+            leave();
         }
 
         void stop_allocation()
         {
-            std::unique_lock<std::mutex> lock(mutex);
             keep_allocating = false;
         }
 
@@ -243,6 +243,10 @@ namespace rsimpl
             sub.callback = callback;
         }
 
+        void set_subdevice_buffers(device & /*device*/, int /*subdevice_index*/, int /*count*/, rs_capture_memory /*memory*/) {}
+        int get_dmabuf_fd(const device & /*device*/, int /*subdevice_index*/, const void * /*frame*/) { return -1; }
+        void set_capture_threads(device & /*device*/, bool /*per_subdevice*/, int /*first_cpu*/, int /*priority*/) {}
+
         void set_subdevice_data_channel_handler(device & device, int subdevice_index, data_channel_callback callback)
         {
             device.subdevices[subdevice_index].set_data_channel_cfg(callback);
@@ -30,6 +30,10 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <sched.h>
 #include <linux/usb/video.h>
 #include <linux/uvcvideo.h>
 #include <linux/videodev2.h>
@@ -65,7 +69,7 @@ namespace rsimpl
             return r;
         }
 
-        struct buffer { void * start; size_t length; };
+        struct buffer { void * start; size_t length; int dmabuf_fd; };
 
         struct context
         {
@@ -91,11 +95,13 @@ namespace rsimpl
             std::vector<buffer> buffers;
 
             int width, height, format, fps;
+            int buffer_count;       // Number of buffers requested from the driver
+            rs_capture_memory memory; // How capture buffers are allocated and shared
             video_channel_callback callback = nullptr;
             data_channel_callback  channel_data_callback = nullptr;    // handle non-uvc data produced by device
             bool is_capturing;
 
-            subdevice(const std::string & name) : dev_name("/dev/" + name), vid(), pid(), fd(), width(), height(), format(), callback(nullptr), channel_data_callback(nullptr), is_capturing()
+            subdevice(const std::string & name) : dev_name("/dev/" + name), vid(), pid(), fd(), width(), height(), format(), buffer_count(RS_DEFAULT_CAPTURE_BUFFERS), memory(RS_CAPTURE_MEMORY_MMAP), callback(nullptr), channel_data_callback(nullptr), is_capturing()
             {
                 struct stat st;
                 if(stat(dev_name.c_str(), &st) < 0)
@@ -209,6 +215,8 @@ namespace rsimpl
                 this->channel_data_callback = callback;
             }
 
+            v4l2_memory get_v4l2_memory() const { return memory == RS_CAPTURE_MEMORY_USERPTR ? V4L2_MEMORY_USERPTR : V4L2_MEMORY_MMAP; }
+
             void start_capture()
             {
                 if(!is_capturing)
@@ -228,14 +236,14 @@ namespace rsimpl
                     parm.parm.capture.timeperframe.denominator = fps;
                     if(xioctl(fd, VIDIOC_S_PARM, &parm) < 0) throw_error("VIDIOC_S_PARM");
 
-                    // Init memory mapped IO
+                    // Init memory mapped or user pointer IO
                     v4l2_requestbuffers req = {};
-                    req.count = 4;
+                    req.count = buffer_count;
                     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                    req.memory = V4L2_MEMORY_MMAP;
+                    req.memory = get_v4l2_memory();
                     if(xioctl(fd, VIDIOC_REQBUFS, &req) < 0)
                     {
-                        if(errno == EINVAL) throw std::runtime_error(dev_name + " does not support memory mapping");
+                        if(errno == EINVAL) throw std::runtime_error(dev_name + (req.memory == V4L2_MEMORY_USERPTR ? " does not support user pointer i/o" : " does not support memory mapping"));
                         else throw_error("VIDIOC_REQBUFS");
                     }
                     if(req.count < 2)
@@ -243,9 +251,17 @@ namespace rsimpl
                         throw std::runtime_error("Insufficient buffer memory on " + dev_name);
                     }
 
-                    buffers.resize(req.count);
+                    buffers.assign(req.count, {nullptr, 0, -1});
                     for(size_t i = 0; i < buffers.size(); ++i)
                     {
+                        if(req.memory == V4L2_MEMORY_USERPTR)
+                        {
+                            // The driver writes straight into these page-aligned buffers, which are handed to the callback without a copy
+                            buffers[i].length = fmt.fmt.pix.sizeimage;
+                            if(posix_memalign(&buffers[i].start, getpagesize(), buffers[i].length) != 0) throw std::runtime_error("Insufficient user pointer buffer memory for " + dev_name);
+                            continue;
+                        }
+
                         v4l2_buffer buf = {};
                         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
                         buf.memory = V4L2_MEMORY_MMAP;
@@ -255,6 +271,16 @@ namespace rsimpl
                         buffers[i].length = buf.length;
                         buffers[i].start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
                         if(buffers[i].start == MAP_FAILED) throw_error("mmap");
+
+                        if(memory == RS_CAPTURE_MEMORY_DMABUF)
+                        {
+                            v4l2_exportbuffer expbuf = {};
+                            expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                            expbuf.index = i;
+                            expbuf.flags = O_CLOEXEC | O_RDONLY;
+                            if(xioctl(fd, VIDIOC_EXPBUF, &expbuf) < 0) warn_error("VIDIOC_EXPBUF");
+                            else buffers[i].dmabuf_fd = expbuf.fd;
+                        }
                     }
 
                     // Start capturing
@@ -262,8 +288,13 @@ namespace rsimpl
                     {
                         v4l2_buffer buf = {};
                         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                        buf.memory = V4L2_MEMORY_MMAP;
+                        buf.memory = req.memory;
                         buf.index = i;
+                        if(buf.memory == V4L2_MEMORY_USERPTR)
+                        {
+                            buf.m.userptr = reinterpret_cast<unsigned long>(buffers[i].start);
+                            buf.length = buffers[i].length;
+                        }
                         if(xioctl(fd, VIDIOC_QBUF, &buf) < 0) throw_error("VIDIOC_QBUF");
                     }
 
@@ -291,14 +322,17 @@ namespace rsimpl
 
                     for(size_t i = 0; i < buffers.size(); i++)
                     {
-                        if(munmap(buffers[i].start, buffers[i].length) < 0) warn_error("munmap");
+                        if(buffers[i].dmabuf_fd >= 0 && close(buffers[i].dmabuf_fd) < 0) warn_error("close");
+                        if(get_v4l2_memory() == V4L2_MEMORY_USERPTR) free(buffers[i].start);
+                        else if(munmap(buffers[i].start, buffers[i].length) < 0) warn_error("munmap");
                     }
+                    buffers.clear();
 
-                    // Close memory mapped IO
+                    // Close memory mapped or user pointer IO
                     struct v4l2_requestbuffers req = {};
                     req.count = 0;
                     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                    req.memory = V4L2_MEMORY_MMAP;
+                    req.memory = get_v4l2_memory();
                     if(xioctl(fd, VIDIOC_REQBUFS, &req) < 0)
                     {
                         if(errno == EINVAL) LOG_ERROR(dev_name + " does not support memory mapping");
@@ -310,44 +344,44 @@ namespace rsimpl
                 }
             }
 
-            static void poll(const std::vector<subdevice *> & subdevices)
+            void dequeue()
             {
-                int max_fd = 0;
-                fd_set fds;
-                FD_ZERO(&fds);
-                for(auto * sub : subdevices)
+                v4l2_buffer buf = {};
+                buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+                buf.memory = get_v4l2_memory();
+                if(xioctl(fd, VIDIOC_DQBUF, &buf) < 0)
                 {
-                    FD_SET(sub->fd, &fds);
-                    max_fd = std::max(max_fd, sub->fd);
+                    if(errno == EAGAIN) return;
+                    throw_error("VIDIOC_DQBUF");
                 }
 
-                struct timeval tv = {0,10000};
-                if(select(max_fd + 1, &fds, NULL, NULL, &tv) < 0)
+                auto sub = this;
+                callback(buffers[buf.index].start,
+                        [sub, buf]() mutable {
+                            if(xioctl(sub->fd, VIDIOC_QBUF, &buf) < 0) throw_error("VIDIOC_QBUF");
+                        });
+            }
+
+            // Waits on an epoll set of subdevices and dispatches every frame that is ready. The set also holds the device stop event,
+            // registered with a null pointer, so this returns false once streaming is being stopped.
+            static bool poll(int epoll_fd)
+            {
+                epoll_event events[8];
+                int count = epoll_wait(epoll_fd, events, sizeof(events) / sizeof(events[0]), -1);
+                if(count < 0)
                 {
-                    if (errno == EINTR) return;
-                    throw_error("select");
+                    if(errno == EINTR) return true;
+                    throw_error("epoll_wait");
                 }
 
-                for(auto * sub : subdevices)
+                for(int i = 0; i < count; ++i)
                 {
-                    if(FD_ISSET(sub->fd, &fds))
-                    {
-                        v4l2_buffer buf = {};
-                        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-                        buf.memory = V4L2_MEMORY_MMAP;
-                        if(xioctl(sub->fd, VIDIOC_DQBUF, &buf) < 0)
-                        {
-                            if(errno == EAGAIN) return;
-                            throw_error("VIDIOC_DQBUF");
-                        }
-
-                        sub->callback(sub->buffers[buf.index].start,
-                                [sub, buf]() mutable {
-                                    if(xioctl(sub->fd, VIDIOC_QBUF, &buf) < 0) throw_error("VIDIOC_QBUF");
-                                });
-                    }
+                    auto sub = static_cast<subdevice *>(events[i].data.ptr);
+                    if(!sub) return false;
+                    sub->dequeue();
                 }
-            }            
+                return true;
+            }
 
             static void poll_interrupts(libusb_device_handle *handle, const std::vector<subdevice *> & subdevices, uint16_t timeout)
             {
@@ -383,16 +417,20 @@ namespace rsimpl
         {
             const std::shared_ptr<context> parent;
             std::vector<std::unique_ptr<subdevice>> subdevices;
-            std::thread thread;
+            std::vector<std::thread> threads;
             std::thread data_channel_thread;
-            volatile bool stop;
+            int stop_fd;                        // eventfd that wakes the capture threads when streaming stops
             volatile bool data_stop;
 
+            bool per_subdevice_threads;         // One capture thread per subdevice instead of one shared thread
+            int first_capture_cpu;              // Capture thread i is pinned to CPU first_capture_cpu + i, or left unpinned if negative
+            int capture_priority;               // SCHED_FIFO priority of the capture threads, or 0 for the default scheduler
+
             libusb_device * usb_device;
             libusb_device_handle * usb_handle;
             std::vector<int> claimed_interfaces;
 
-            device(std::shared_ptr<context> parent) : parent(parent), stop(), data_stop(), usb_device(), usb_handle() {}
+            device(std::shared_ptr<context> parent) : parent(parent), stop_fd(-1), data_stop(), per_subdevice_threads(), first_capture_cpu(-1), capture_priority(), usb_device(), usb_handle() {}
             ~device()
             {
                 stop_streaming();
@@ -418,35 +456,101 @@ namespace rsimpl
 
             void start_streaming()
             {
-                std::vector<subdevice *> subs;
+                // Group the streaming subdevices by the capture thread that will service them
+                std::vector<std::vector<subdevice *>> groups;
 
                 for(auto & sub : subdevices)
                 {
                     if(sub->callback)
                     {
-                        sub->start_capture();
-                        subs.push_back(sub.get());
+                        if(per_subdevice_threads || groups.empty()) groups.emplace_back();
+                        groups.back().push_back(sub.get());
                     }                
                 }
 
-                thread = std::thread([this, subs]()
+                // Everything that can fail is set up before the capture threads start, and undone if it does. Each epoll set is closed by its
+                // thread once that thread has started, and by us otherwise.
+                std::vector<int> epoll_fds;
+                try
                 {
-                    while(!stop) subdevice::poll(subs);
-                });
+                    stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+                    if(stop_fd < 0) throw_error("eventfd");
+
+                    for(auto & group : groups)
+                    {
+                        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+                        if(epoll_fd < 0) throw_error("epoll_create1");
+                        epoll_fds.push_back(epoll_fd);
+
+                        epoll_event ev = {};
+                        ev.events = EPOLLIN;
+                        ev.data.ptr = nullptr;
+                        if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev) < 0) throw_error("epoll_ctl");
+                        for(auto * sub : group)
+                        {
+                            ev.data.ptr = sub;
+                            if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sub->fd, &ev) < 0) throw_error("epoll_ctl");
+                        }
+                    }
+
+                    for(auto & group : groups) for(auto * sub : group) sub->start_capture();
+
+                    threads.reserve(groups.size());
+                    for(size_t i = 0; i < groups.size(); ++i)
+                    {
+                        const int epoll_fd = epoll_fds[i];
+                        threads.push_back(std::thread([epoll_fd]()
+                        {
+                            while(subdevice::poll(epoll_fd)) {}
+                            close(epoll_fd);
+                        }));
+                        configure_capture_thread(threads.back(), i);
+                    }
+                }
+                catch(...)
+                {
+                    for(size_t i = threads.size(); i < epoll_fds.size(); ++i) close(epoll_fds[i]);
+                    stop_streaming();
+                    for(auto & group : groups) for(auto * sub : group) sub->stop_capture();
+                    throw;
+                }
             }
 
             void stop_streaming()
             {
-                if(thread.joinable())
+                if(stop_fd >= 0)
                 {
-                    stop = true;
-                    thread.join();
-                    stop = false;
+                    uint64_t value = 1;
+                    if(write(stop_fd, &value, sizeof(value)) < 0) warn_error("write");
+                    for(auto & thread : threads) thread.join();
+                    threads.clear();
+                    if(close(stop_fd) < 0) warn_error("close");
+                    stop_fd = -1;
 
                     for(auto & sub : subdevices) sub->stop_capture();
                 }                
             }
 
+            void configure_capture_thread(std::thread & thread, size_t index)
+            {
+                if(first_capture_cpu >= 0)
+                {
+                    cpu_set_t cpus;
+                    CPU_ZERO(&cpus);
+                    CPU_SET((first_capture_cpu + index) % std::max(1u, std::thread::hardware_concurrency()), &cpus);
+                    int status = pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+                    if(status) LOG_WARNING("pthread_setaffinity_np(...) returned " << strerror(status));
+                }
+
+                if(capture_priority > 0)
+                {
+                    sched_param param = {};
+                    param.sched_priority = capture_priority;
+                    int status = pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+                    if(status) LOG_WARNING("Cannot use SCHED_FIFO for capture threads, pthread_setschedparam(...) returned " << strerror(status));
+                }
+            }
+
             void start_data_acquisition()
             {
                 std::vector<subdevice *> data_channel_subs;
@@ -553,6 +657,25 @@ namespace rsimpl
             device.subdevices[subdevice_index]->set_format(width, height, (const big_endian<int> &)fourcc, fps, callback);
         }
 
+        void set_subdevice_buffers(device & device, int subdevice_index, int count, rs_capture_memory memory)
+        {
+            device.subdevices[subdevice_index]->buffer_count = count;
+            device.subdevices[subdevice_index]->memory = memory;
+        }
+
+        void set_capture_threads(device & device, bool per_subdevice, int first_cpu, int priority)
+        {
+            device.per_subdevice_threads = per_subdevice;
+            device.first_capture_cpu = first_cpu;
+            device.capture_priority = priority;
+        }
+
+        int get_dmabuf_fd(const device & device, int subdevice_index, const void * frame)
+        {
+            for(auto & buf : device.subdevices[subdevice_index]->buffers) if(buf.start == frame) return buf.dmabuf_fd;
+            return -1;
+        }
+
         void set_subdevice_data_channel_handler(device & device, int subdevice_index, data_channel_callback callback)
         {
             device.subdevices[subdevice_index]->set_data_channel_cfg(callback);
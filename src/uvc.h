@@ -64,6 +64,9 @@ namespace rsimpl
         typedef std::function<void(const void * frame, std::function<void()> continuation)> video_channel_callback;
 
         void set_subdevice_mode(device & device, int subdevice_index, int width, int height, uint32_t fourcc, int fps, video_channel_callback callback);
+        void set_subdevice_buffers(device & device, int subdevice_index, int count, rs_capture_memory memory); // Only honored by backends that stream into driver-allocated buffers
+        int get_dmabuf_fd(const device & device, int subdevice_index, const void * frame); // Returns -1 if the frame was not exported as a DMABUF
+        void set_capture_threads(device & device, bool per_subdevice, int first_cpu, int priority); // Only honored by the V4L2 backend
         void start_streaming(device & device, int num_transfer_bufs);
         void stop_streaming(device & device);
         
@@ -14,6 +14,8 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include "../src/sync.h"
+#include "../src/image.h"
 
 // noexcept is not accepted by Visual Studio 2013 yet, but noexcept(false) is require on throwing destructors on gcc and clang
 // It is normally advisable not to throw in a destructor, however, this usage is safe for require_error/require_no_error because
@@ -120,6 +122,14 @@ inline void require_zero_vector(const float (& vector)[3])
     for(int i=1; i<3; ++i) REQUIRE( vector[i] == 0.0f );
 }
 
+// Require that a and b hold the same count floats to within rounding, for kernels checked against the inline functions of rsutil.h, which
+// the compiler is free to round differently in each translation unit under -Ofast. Values computed as x * scale + offset, such as pixels,
+// should pass that scale, since rounding x then costs an absolute error proportional to it.
+inline void require_approx_equal(const float * a, const float * b, size_t count, float scale = 1.0f)
+{
+    for(size_t i=0; i<count; ++i) if(a[i] != b[i]) REQUIRE( a[i] == Approx(b[i]).scale(scale) );
+}
+
 // Require that a == transpose(b)
 inline void require_transposed(const float (& a)[9], const float (& b)[9])
 {
@@ -158,6 +168,43 @@ inline void require_identity_matrix(const float (& matrix)[9])
     for(int i=0; i<9; ++i) REQUIRE( matrix[i] == identity_matrix_3x3[i] );
 }
 
+// A 64x4 mode of the given native format, to exercise frame archives without a camera
+inline rsimpl::subdevice_mode_selection make_test_mode_selection(const rsimpl::native_pixel_format & pf = rsimpl::pf_yuy2)
+{
+    rsimpl::subdevice_mode mode = {};
+    mode.native_dims = { 64, 4 };
+    mode.pf = pf;
+    mode.native_intrinsics.width = 64;
+    mode.native_intrinsics.height = 4;
+    return rsimpl::subdevice_mode_selection(mode, 0, 0);
+}
+
+// The options and counters frame archives read and update through pointers, at their defaults
+struct test_archive_settings
+{
+    std::atomic<uint32_t> queue_size, event_queue_size, events_timeout;
+    rsimpl::frame_pool_counters counters;
+
+    test_archive_settings(uint32_t queue_size = RS_USER_QUEUE_SIZE) : queue_size(queue_size), event_queue_size(RS_MAX_EVENT_QUEUE_SIZE), events_timeout(RS_MAX_EVENT_TIME_OUT) {}
+};
+
+// Allocates and commits a frame of stream with the given frame number and timestamp
+inline void commit_test_frame(rsimpl::syncronizing_archive & archive, rs_stream stream, unsigned long long number, double timestamp)
+{
+    rsimpl::frame_archive::frame_additional_data additional_data;
+    additional_data.stream_type = stream;
+    additional_data.frame_number = number;
+    additional_data.timestamp = timestamp;
+    archive.alloc_frame(stream, additional_data, true);
+    archive.commit_frame(stream);
+}
+
+// Allocates and commits a frame of stream, with number as both its frame number and its timestamp
+inline void commit_test_frame(rsimpl::syncronizing_archive & archive, rs_stream stream, unsigned long long number)
+{
+    commit_test_frame(archive, stream, number, (double)number);
+}
+
 struct test_duration{
     bool is_start_time_initialized;
     bool is_end_time_initialized;
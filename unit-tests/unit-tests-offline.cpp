@@ -8,8 +8,16 @@
 
 #include "unit-tests-common.h"
 #include "../src/device.h"
+#include "../src/sync.h"
+#include "../src/image.h"
+#include <librealsense/rsutil.h>
 
 #include <sstream>
+#include <random>
+#include <set>
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 static std::string unknown = "UNKNOWN"; 
 
@@ -35,6 +43,413 @@ TEST_CASE("wraparound_mechanism produces correct output", "[offline] [validation
     }
 }
 
+TEST_CASE("frame_buffer_pool recycles buffers of its own size", "[offline] [validation]")
+{
+    rsimpl::frame_pool_counters counters;
+    rsimpl::frame_buffer_pool pool;
+    pool.reset(64, 2, &counters, nullptr);
+
+    std::vector<rsimpl::frame_buffer> buffers;
+    for (int i = 0; i < 3; ++i) buffers.push_back(pool.acquire());
+    for (auto & b : buffers) REQUIRE(b.size() == 64);
+    REQUIRE(counters.hits == 2);
+    REQUIRE(counters.misses == 1);
+
+    // Buffers of a different size are never retained
+    rsimpl::frame_buffer foreign(32, nullptr);
+    pool.release(foreign);
+    REQUIRE(counters.evictions == 1);
+
+    // The pool retains up to RS_FRAME_POOL_SIZE buffers and evicts the rest
+    for (int i = 0; i < RS_FRAME_POOL_SIZE; ++i) buffers.push_back(rsimpl::frame_buffer(64, nullptr));
+    for (auto & b : buffers) pool.release(b);
+    REQUIRE(counters.evictions == 1 + buffers.size() - RS_FRAME_POOL_SIZE);
+
+    for (int i = 0; i < RS_FRAME_POOL_SIZE; ++i) pool.acquire();
+    REQUIRE(counters.hits == 2 + RS_FRAME_POOL_SIZE);
+    REQUIRE(counters.misses == 1);
+}
+
+TEST_CASE("frame_buffer honors the user allocator and alignment", "[offline] [validation]")
+{
+    struct counting_allocator : rs_frame_allocator
+    {
+        int allocations = 0, deallocations = 0;
+        std::vector<std::vector<uint8_t>> blocks;
+        void * allocate(size_t size, size_t alignment) override
+        {
+            ++allocations;
+            blocks.push_back(std::vector<uint8_t>(size + alignment));
+            auto p = blocks.back().data();
+            return p + (alignment - reinterpret_cast<uintptr_t>(p) % alignment) % alignment;
+        }
+        void deallocate(void *, size_t) override { ++deallocations; }
+        void release() override {}
+    } user_allocator;
+
+    {
+        rsimpl::frame_buffer_pool pool;
+        pool.reset(1000, 1, nullptr, rsimpl::frame_allocator_ptr(&user_allocator, [](rs_frame_allocator *) {}));
+        auto a = pool.acquire(), b = pool.acquire();
+        REQUIRE(user_allocator.allocations == 2);
+        REQUIRE(reinterpret_cast<uintptr_t>(a.data()) % RS_FRAME_BUFFER_ALIGNMENT == 0);
+        REQUIRE(reinterpret_cast<uintptr_t>(b.data()) % RS_FRAME_BUFFER_ALIGNMENT == 0);
+        pool.release(a);
+    }
+    REQUIRE(user_allocator.deallocations == 2);
+
+    rsimpl::frame_buffer heap_buffer(13, nullptr);
+    REQUIRE(heap_buffer.size() == 13);
+    REQUIRE(reinterpret_cast<uintptr_t>(heap_buffer.data()) % RS_FRAME_BUFFER_ALIGNMENT == 0);
+}
+
+TEST_CASE("frame_archive unpacks a deferred frame once, on first data access", "[offline] [validation]")
+{
+    using namespace rsimpl;
+    auto selection = make_test_mode_selection();
+    std::vector<byte> native(selection.mode.pf.get_image_size(64, 4)), expected(get_image_size(64, 4, RS_FORMAT_RGB8));
+    for (size_t i = 0; i < native.size(); ++i) native[i] = static_cast<byte>(i * 7);
+    byte * dest[] = { expected.data() };
+    selection.unpack(dest, native.data());
+
+    test_archive_settings settings;
+    frame_archive archive({ selection }, &settings.queue_size, &settings.counters, nullptr);
+    std::atomic<int> released(0);
+    {
+        frame_archive::frame_additional_data additional_data;
+        additional_data.stream_type = RS_STREAM_COLOR;
+        archive.alloc_frame(RS_STREAM_COLOR, additional_data, true);
+        archive.defer_unpack(RS_STREAM_COLOR, frame_continuation([&]() { ++released; }, native.data()));
+
+        auto ref = archive.track_frame(RS_STREAM_COLOR);
+        REQUIRE(ref != nullptr);
+        REQUIRE(released == 0); // The capture buffer is held until the frame is unpacked
+        REQUIRE(memcmp(ref->get_frame_data(), expected.data(), expected.size()) == 0);
+        REQUIRE(released == 1);
+        REQUIRE(memcmp(ref->get_frame_data(), expected.data(), expected.size()) == 0);
+        archive.release_frame_ref(ref);
+    }
+    REQUIRE(released == 1);
+
+    // Readers racing to the first access all see the unpacked data, and the frame is still unpacked once
+    {
+        frame_archive::frame_additional_data additional_data;
+        additional_data.stream_type = RS_STREAM_COLOR;
+        archive.alloc_frame(RS_STREAM_COLOR, additional_data, true);
+        archive.defer_unpack(RS_STREAM_COLOR, frame_continuation([&]() { ++released; }, native.data()));
+        auto ref = archive.track_frame(RS_STREAM_COLOR);
+
+        const byte * results[4] = {};
+        std::vector<std::thread> readers;
+        for (auto & result : results) readers.emplace_back([&]() { result = ref->get_frame_data(); });
+        for (auto & reader : readers) reader.join();
+
+        REQUIRE(released == 2);
+        for (auto result : results) REQUIRE(memcmp(result, expected.data(), expected.size()) == 0);
+        archive.release_frame_ref(ref);
+    }
+}
+
+TEST_CASE("syncronizing_archive keeps the newest frames up to the queue size of each stream", "[offline] [validation]")
+{
+    using namespace rsimpl;
+
+    // Frames are only culled by timestamp once every stream has one queued, so a silent depth stream leaves the color queue to its size
+    test_archive_settings settings;
+    const int queue_sizes[RS_STREAM_NATIVE_COUNT] = { 4, 3, 0, 0, 0 };
+    sync_counters sync_stats;
+    syncronizing_archive archive({ make_test_mode_selection(), make_test_mode_selection(pf_z16) }, RS_STREAM_COLOR, queue_sizes, sync_settings(), &sync_stats, nullptr,
+        &settings.queue_size, &settings.event_queue_size, &settings.events_timeout, &settings.counters, nullptr);
+
+    unsigned long long number = 0;
+    auto commit = [&](int count) { for (int i = 0; i < count; ++i) commit_test_frame(archive, RS_STREAM_COLOR, ++number); };
+
+    // Only the three newest of five frames are kept, and the queue wraps around as frames come and go
+    commit(5);
+    for (unsigned long long expected : { 3, 4 })
+    {
+        REQUIRE(archive.poll_for_frames());
+        REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == expected);
+    }
+    commit(3);
+    for (unsigned long long expected : { 6, 7, 8 })
+    {
+        REQUIRE(archive.poll_for_frames());
+        REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == expected);
+    }
+    REQUIRE(!archive.poll_for_frames());
+    archive.flush();
+}
+
+TEST_CASE("syncronizing_archive matches frames according to the sync policy", "[offline] [validation]")
+{
+    using namespace rsimpl;
+    test_archive_settings archive_settings;
+    const int queue_sizes[RS_STREAM_NATIVE_COUNT] = { 4, 4, 0, 0, 0 };
+
+    for (auto policy : { RS_SYNC_POLICY_FRAME_NUMBER, RS_SYNC_POLICY_COMPLETE })
+    {
+        // A long latency bound ensures framesets are formed only once the depth stream has caught up with the key frame
+        sync_settings settings;
+        settings.policy = policy;
+        settings.tolerance = 0.5;
+        settings.max_latency = 1000;
+        sync_counters sync_stats;
+        syncronizing_archive archive({ make_test_mode_selection(), make_test_mode_selection(pf_z16) }, RS_STREAM_COLOR, queue_sizes, settings, &sync_stats, nullptr,
+            &archive_settings.queue_size, &archive_settings.event_queue_size, &archive_settings.events_timeout, &archive_settings.counters, nullptr);
+        auto commit = [&](rs_stream stream, unsigned long long number) { commit_test_frame(archive, stream, number); };
+
+        // Color frame 2 has no depth counterpart
+        for (unsigned long long number : { 1, 2, 3 }) commit(RS_STREAM_COLOR, number);
+        commit(RS_STREAM_DEPTH, 1);
+        REQUIRE(archive.poll_for_frames());
+        REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 1);
+        REQUIRE(archive.get_frame_number(RS_STREAM_DEPTH) == 1);
+        REQUIRE(!archive.poll_for_frames());
+
+        commit(RS_STREAM_DEPTH, 3);
+        REQUIRE(archive.poll_for_frames());
+        if (policy == RS_SYNC_POLICY_FRAME_NUMBER)
+        {
+            // The incomplete frameset is delivered, with the previous depth frame
+            REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 2);
+            REQUIRE(archive.get_frame_number(RS_STREAM_DEPTH) == 1);
+            REQUIRE(archive.poll_for_frames());
+        }
+        REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 3);
+        REQUIRE(archive.get_frame_number(RS_STREAM_DEPTH) == 3);
+        REQUIRE(!archive.poll_for_frames());
+
+        REQUIRE(sync_stats.framesets == (policy == RS_SYNC_POLICY_FRAME_NUMBER ? 3u : 2u));
+        REQUIRE(sync_stats.incomplete == (policy == RS_SYNC_POLICY_FRAME_NUMBER ? 1u : 0u));
+        REQUIRE(sync_stats.dropped == (policy == RS_SYNC_POLICY_FRAME_NUMBER ? 0u : 1u));
+        archive.flush();
+    }
+}
+
+TEST_CASE("syncronizing_archive matches frames within the tolerance under the window policy", "[offline] [validation]")
+{
+    using namespace rsimpl;
+    test_archive_settings archive_settings;
+    const int queue_sizes[RS_STREAM_NATIVE_COUNT] = { 4, 4, 0, 0, 0 };
+
+    sync_settings settings;
+    settings.policy = RS_SYNC_POLICY_WINDOW;
+    settings.tolerance = 2;
+    settings.max_latency = 1000;
+    sync_counters sync_stats;
+    syncronizing_archive archive({ make_test_mode_selection(), make_test_mode_selection(pf_z16) }, RS_STREAM_COLOR, queue_sizes, settings, &sync_stats, nullptr,
+        &archive_settings.queue_size, &archive_settings.event_queue_size, &archive_settings.events_timeout, &archive_settings.counters, nullptr);
+
+    // Color frames every 10 ms, from 10 to 30 ms
+    for (unsigned long long number : { 1, 2, 3 }) commit_test_frame(archive, RS_STREAM_COLOR, number, number * 10.0);
+
+    // A depth frame exactly the tolerance after the key frame matches it
+    commit_test_frame(archive, RS_STREAM_DEPTH, 1, 12);
+    REQUIRE(archive.poll_for_frames());
+    REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 1);
+    REQUIRE(archive.get_frame_number(RS_STREAM_DEPTH) == 1);
+    REQUIRE(!archive.poll_for_frames());
+
+    // A depth frame just outside the tolerance does not match, and the incomplete frameset is delivered with the previous depth frame
+    commit_test_frame(archive, RS_STREAM_DEPTH, 2, 23);
+    REQUIRE(archive.poll_for_frames());
+    REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 2);
+    REQUIRE(archive.get_frame_number(RS_STREAM_DEPTH) == 1);
+    REQUIRE(!archive.poll_for_frames());
+
+    // The unmatched depth frame is too old for the next key frame and is discarded in favor of one inside the tolerance
+    commit_test_frame(archive, RS_STREAM_DEPTH, 3, 31);
+    REQUIRE(archive.poll_for_frames());
+    REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 3);
+    REQUIRE(archive.get_frame_number(RS_STREAM_DEPTH) == 3);
+    REQUIRE(archive.get_frame_timestamp(RS_STREAM_DEPTH) == 31);
+    REQUIRE(!archive.poll_for_frames());
+
+    REQUIRE(sync_stats.framesets == 3u);
+    REQUIRE(sync_stats.incomplete == 1u);
+    REQUIRE(sync_stats.dropped == 0u);
+    archive.flush();
+}
+
+TEST_CASE("syncronizing_archive honors wait timeouts and signals when a frameset is ready", "[offline] [validation]")
+{
+    using namespace rsimpl;
+    test_archive_settings settings;
+    const int queue_sizes[RS_STREAM_NATIVE_COUNT] = { 0, 4, 0, 0, 0 };
+    frameset_event ready;
+    syncronizing_archive archive({ make_test_mode_selection() }, RS_STREAM_COLOR, queue_sizes, sync_settings(), nullptr, &ready,
+        &settings.queue_size, &settings.event_queue_size, &settings.events_timeout, &settings.counters, nullptr);
+
+    unsigned long long number = 0;
+    auto commit = [&]() { commit_test_frame(archive, RS_STREAM_COLOR, ++number); };
+#ifndef _WIN32
+    auto is_ready = [&]() { pollfd fd = { ready.get_fd(), POLLIN, 0 }; return poll(&fd, 1, 0) == 1; };
+#else
+    auto is_ready = [&]() { return false; };
+#endif
+
+    auto start = std::chrono::high_resolution_clock::now();
+    REQUIRE(!archive.wait_for_frames(std::chrono::milliseconds(20)));
+    REQUIRE(std::chrono::high_resolution_clock::now() - start >= std::chrono::milliseconds(20));
+    REQUIRE(!is_ready());
+
+    commit();
+#ifndef _WIN32
+    REQUIRE(is_ready());
+#endif
+    REQUIRE(archive.wait_for_frames(std::chrono::milliseconds(0)));
+    REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 1);
+    REQUIRE(!is_ready());
+
+    commit();
+#ifndef _WIN32
+    REQUIRE(is_ready());
+#endif
+    REQUIRE(archive.poll_for_frames());
+    REQUIRE(archive.get_frame_number(RS_STREAM_COLOR) == 2);
+    REQUIRE(!is_ready());
+    archive.flush();
+}
+
+// Runs thread_count threads allocating from and releasing to a full-size small_heap, requires that no slot was ever handed out twice or came
+// up short, and returns the time taken in seconds
+static double require_small_heap_exclusive(int thread_count, int iterations)
+{
+    using namespace rsimpl;
+    struct item { int owner = 0; };
+    const int capacity = RS_USER_QUEUE_SIZE * RS_STREAM_COUNT;
+    small_heap<item> heap(capacity);
+
+    // Every thread keeps a few items outstanding, as applications do while they process frames, and releases them in turn
+    std::atomic<int> conflicts(0), exhausted(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int t = 1; t <= thread_count; ++t) threads.emplace_back([&, t]()
+    {
+        item * held[4] = {};
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto & slot = held[i % 4];
+            if (slot)
+            {
+                if (slot->owner != t) ++conflicts;
+                heap.deallocate(slot);
+            }
+            slot = heap.allocate();
+            if (!slot) { ++exhausted; continue; }
+            if (slot->owner != 0) ++conflicts;
+            slot->owner = t;
+        }
+        for (auto slot : held) if (slot) heap.deallocate(slot);
+    });
+    for (auto & thread : threads) thread.join();
+    auto seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    REQUIRE(conflicts == 0);
+    REQUIRE(exhausted == 0);
+
+    // Every slot came back, and a stopped heap refuses further allocations
+    std::vector<item *> items;
+    for (int i = 0; i < capacity; ++i) items.push_back(heap.allocate());
+    REQUIRE(std::find(items.begin(), items.end(), nullptr) == items.end());
+    REQUIRE(heap.allocate() == nullptr);
+    for (auto i : items) heap.deallocate(i);
+    heap.stop_allocation();
+    REQUIRE(heap.allocate() == nullptr);
+    heap.wait_until_empty();
+    return seconds;
+}
+
+TEST_CASE("small_heap hands out each slot once under 8 concurrent releasing threads", "[offline] [validation]")
+{
+    require_small_heap_exclusive(8, 5000);
+}
+
+TEST_CASE("small_heap allocate/deallocate throughput with 8 threads", "[.benchmark]")
+{
+    const int thread_count = 8, iterations = 200000;
+    auto seconds = require_small_heap_exclusive(thread_count, iterations);
+    WARN("small_heap: " << (thread_count * iterations / seconds / 1e6) << " million allocate/deallocate pairs per second with " << thread_count << " threads");
+}
+
+TEST_CASE("frame_archive publishes derived frames computed into pooled buffers", "[offline] [validation]")
+{
+    using namespace rsimpl;
+    test_archive_settings settings;
+    auto & counters = settings.counters;
+    frame_archive archive({ make_test_mode_selection() }, &settings.queue_size, &counters, nullptr);
+    archive.reset_derived_pool(RS_STREAM_RECTIFIED_COLOR, get_image_size(64, 4, RS_FORMAT_RGB8));
+
+    frame_archive::frame_additional_data additional_data;
+    additional_data.stream_type = RS_STREAM_RECTIFIED_COLOR;
+    additional_data.frame_number = 42;
+    additional_data.width = additional_data.stride_x = 64;
+    additional_data.height = 4;
+    additional_data.bpp = 24;
+    additional_data.format = RS_FORMAT_RGB8;
+    const byte * first_data = nullptr;
+    for (int i = 0; i < 2; ++i)
+    {
+        auto hits = counters.hits.load(), misses = counters.misses.load();
+        auto ref = archive.derive_frame(RS_STREAM_RECTIFIED_COLOR, additional_data, [](byte * dest) { memset(dest, 7, 64 * 4 * 3); });
+        REQUIRE(ref != nullptr);
+        REQUIRE(ref->get_stream_type() == RS_STREAM_RECTIFIED_COLOR);
+        REQUIRE(ref->get_frame_number() == 42);
+        REQUIRE(ref->get_frame_stride() == 64 * 3);
+        REQUIRE(ref->get_frame_data()[64 * 4 * 3 - 1] == 7);
+
+        // The buffer of the first frame is recycled for the second
+        if (i == 0) first_data = ref->get_frame_data();
+        else REQUIRE(ref->get_frame_data() == first_data);
+        REQUIRE(counters.hits == hits + i);
+        REQUIRE(counters.misses == misses + 1 - i);
+        archive.release_frame_ref(ref);
+    }
+
+    // A frame which fails to compute is not published, and its buffer goes back to the pool
+    REQUIRE_THROWS(archive.derive_frame(RS_STREAM_RECTIFIED_COLOR, additional_data, [](byte *) { throw std::runtime_error("failed"); }));
+    auto ref = archive.derive_frame(RS_STREAM_RECTIFIED_COLOR, additional_data, [](byte *) {});
+    REQUIRE(ref->get_frame_data() == first_data);
+    archive.release_frame_ref(ref);
+}
+
+TEST_CASE("frame_archive reserves room for the frames queue size of every stream and counts drops once it is exhausted", "[offline] [validation]")
+{
+    using namespace rsimpl;
+    test_archive_settings settings(2);
+    auto & queue_size = settings.queue_size;
+    auto & counters = settings.counters;
+    frame_archive archive({ make_test_mode_selection() }, &queue_size, &counters, nullptr);
+    archive.reset_derived_pool(RS_STREAM_RECTIFIED_COLOR, get_image_size(64, 4, RS_FORMAT_RGB8));
+
+    frame_archive::frame_additional_data additional_data;
+    additional_data.stream_type = RS_STREAM_RECTIFIED_COLOR;
+    additional_data.width = additional_data.stride_x = 64;
+    additional_data.height = 4;
+    additional_data.bpp = 24;
+    additional_data.format = RS_FORMAT_RGB8;
+    auto derive = [&]() { return archive.derive_frame(RS_STREAM_RECTIFIED_COLOR, additional_data, [](byte *) {}); };
+
+    // Frames beyond the queue size of a stream are dropped without exhausting the archive
+    std::vector<frame_archive::frame_ref *> refs = { derive(), derive() };
+    REQUIRE(derive() == nullptr);
+    REQUIRE(counters.exhausted == 0);
+
+    // Raising the queue size while streaming is limited by the room reserved on construction
+    queue_size = RS_MAX_USER_QUEUE_SIZE;
+    while (refs.size() < 2 * RS_STREAM_COUNT) refs.push_back(derive());
+    REQUIRE(std::find(refs.begin(), refs.end(), nullptr) == refs.end());
+    REQUIRE(derive() == nullptr);
+    REQUIRE(counters.exhausted == 1);
+
+    archive.release_frame_ref(refs.back());
+    refs.back() = derive();
+    REQUIRE(refs.back() != nullptr);
+    for (auto ref : refs) archive.release_frame_ref(ref);
+    REQUIRE(counters.exhausted == 1);
+}
+
 TEST_CASE( "rs_create_context() validates input", "[offline] [validation]" )
 {
     REQUIRE(rs_create_context(RS_API_VERSION - 100, require_error("", false)) == nullptr);
@@ -62,6 +477,21 @@ TEST_CASE( "rs_get_device() validates input", "[offline] [validation]" )
     // NOTE: Index upper bound determined by rs_get_device_count(), can't validate without a live object
 }
 
+TEST_CASE( "rs_set_stream_sync_queue_size() validates input", "[offline] [validation]" )
+{
+    rs_set_stream_sync_queue_size(nullptr, RS_STREAM_DEPTH, 0, require_error("null pointer passed for argument \"device\""));
+    rs_set_stream_sync_queue_size(fake_object_pointer(), RS_STREAM_POINTS, 0, require_error("argument \"stream\" must be a native stream"));
+    rs_set_stream_sync_queue_size(fake_object_pointer(), RS_STREAM_DEPTH, -1, require_error("out of range value for argument \"size\""));
+    rs_set_stream_sync_queue_size(fake_object_pointer(), RS_STREAM_DEPTH, RS_MAX_SYNC_QUEUE_SIZE + 1, require_error("out of range value for argument \"size\""));
+}
+
+TEST_CASE( "rs_compute_detached_frame() validates input", "[offline] [validation]" )
+{
+    REQUIRE(rs_compute_detached_frame(nullptr, RS_STREAM_POINTS, nullptr, nullptr, require_error("null pointer passed for argument \"device\"")) == nullptr);
+    REQUIRE(rs_compute_detached_frame(fake_object_pointer(), RS_STREAM_COUNT, nullptr, nullptr, require_error("bad enum value for argument \"stream\"")) == nullptr);
+    REQUIRE(rs_compute_detached_frame(fake_object_pointer(), RS_STREAM_POINTS, nullptr, nullptr, require_error("null pointer passed for argument \"frame\"")) == nullptr);
+}
+
 TEST_CASE( "rs_get_device_name() validates input", "[offline] [validation]" )
 {
     REQUIRE(rs_get_device_name(nullptr, require_error("null pointer passed for argument \"device\"")) == nullptr);
@@ -240,6 +670,16 @@ TEST_CASE( "rs_wait_for_frames() validates input", "[offline] [validation]" )
     rs_wait_for_frames(nullptr, require_error("null pointer passed for argument \"device\""));
 }
 
+TEST_CASE( "rs_wait_for_frames_timeout() validates input", "[offline] [validation]" )
+{
+    REQUIRE(rs_wait_for_frames_timeout(nullptr, 10, require_error("null pointer passed for argument \"device\"")) == 0);
+}
+
+TEST_CASE( "rs_get_frames_ready_fd() validates input", "[offline] [validation]" )
+{
+    REQUIRE(rs_get_frames_ready_fd(nullptr, require_error("null pointer passed for argument \"device\"")) == -1);
+}
+
 TEST_CASE( "rs_get_frame_timestamp() validates input", "[offline] [validation]" )
 {
     REQUIRE(rs_get_frame_timestamp(nullptr,               RS_STREAM_DEPTH,    require_error("null pointer passed for argument \"device\"")) == 0);
@@ -376,6 +816,633 @@ TEST_CASE( "rs_option_to_string() produces correct output", "[offline] [validati
     REQUIRE(rs_option_to_string(RS_OPTION_COUNT) == unknown);
 }
 
+TEST_CASE( "rs_capture_memory_to_string() produces correct output", "[offline] [validation]" )
+{
+    // Valid enum values should return the text that follows the type prefix
+    REQUIRE(rs_capture_memory_to_string(RS_CAPTURE_MEMORY_MMAP) == std::string("MMAP"));
+    REQUIRE(rs_capture_memory_to_string(RS_CAPTURE_MEMORY_USERPTR) == std::string("USERPTR"));
+    REQUIRE(rs_capture_memory_to_string(RS_CAPTURE_MEMORY_DMABUF) == std::string("DMABUF"));
+
+    // Invalid enum values should return nullptr
+    REQUIRE(rs_capture_memory_to_string((rs_capture_memory)-1) == unknown);
+    REQUIRE(rs_capture_memory_to_string(RS_CAPTURE_MEMORY_COUNT) == unknown);
+}
+
+TEST_CASE( "rs_sync_policy_to_string() produces correct output", "[offline] [validation]" )
+{
+    // Valid enum values should return the text that follows the type prefix
+    REQUIRE(rs_sync_policy_to_string(RS_SYNC_POLICY_NEAREST) == std::string("NEAREST"));
+    REQUIRE(rs_sync_policy_to_string(RS_SYNC_POLICY_FRAME_NUMBER) == std::string("FRAME_NUMBER"));
+    REQUIRE(rs_sync_policy_to_string(RS_SYNC_POLICY_WINDOW) == std::string("WINDOW"));
+    REQUIRE(rs_sync_policy_to_string(RS_SYNC_POLICY_COMPLETE) == std::string("COMPLETE"));
+
+    // Every value has a name, which names no other value
+    for (int i = 0; i < RS_SYNC_POLICY_COUNT; ++i)
+    {
+        const std::string name = rs_sync_policy_to_string((rs_sync_policy)i);
+        int found = -1;
+        for (int j = 0; j < RS_SYNC_POLICY_COUNT; ++j) if (rs_sync_policy_to_string((rs_sync_policy)j) == name) found = found < 0 ? j : RS_SYNC_POLICY_COUNT;
+        REQUIRE(found == i);
+    }
+
+    // Invalid enum values should return nullptr
+    REQUIRE(rs_sync_policy_to_string((rs_sync_policy)-1) == unknown);
+    REQUIRE(rs_sync_policy_to_string(RS_SYNC_POLICY_COUNT) == unknown);
+}
+
+TEST_CASE( "all image unpacking kernels produce bit-identical output", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    const native_pixel_format * formats[] = { &pf_yuy2, &pf_y8, &pf_y8i, &pf_y16, &pf_y12i, &pf_f200_inzi, &pf_sr300_invi, &pf_sr300_inzi };
+    const int lengths[] = { 2, 8, 14, 16, 30, 32, 50, 64, 66, 126, 640 }; // Includes lengths that are not a multiple of any kernel's block size
+    const int guard = 64;
+    const auto supported = get_supported_simd_level();
+
+    std::mt19937 rng(42);
+    for(auto pf : formats)
+    {
+        for(auto & unpacker : pf->unpackers)
+        {
+            for(int n : lengths)
+            {
+                std::vector<byte> source(pf->get_image_size(n, 1));
+                for(auto & b : source) b = static_cast<byte>(rng());
+
+                // Unpack with each instruction set the CPU supports, and compare against the scalar reference
+                std::vector<std::vector<byte>> reference;
+                for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+                {
+                    set_simd_level((simd_level)level);
+                    std::vector<std::vector<byte>> outputs;
+                    std::vector<byte *> dest;
+                    for(auto & output : unpacker.outputs)
+                    {
+                        outputs.push_back(std::vector<byte>(n * get_image_bpp(output.second) / 8 + guard, 0xcd));
+                        dest.push_back(outputs.back().data());
+                    }
+                    unpacker.unpack(dest.data(), source.data(), n);
+
+                    for(auto & out : outputs) for(int i = 0; i < guard; ++i) REQUIRE(out[out.size() - guard + i] == 0xcd);
+                    if(reference.empty()) reference = outputs;
+                    else for(size_t i = 0; i < outputs.size(); ++i) REQUIRE(outputs[i] == reference[i]);
+                }
+            }
+        }
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "deprojection through a ray table matches rs_deproject_pixel_to_point() and is identical at every simd level", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics intrin = { 61, 7, 30.5f, 3.2f, 55.1f, 54.9f, RS_DISTORTION_INVERSE_BROWN_CONRADY, { 0.1f, -0.05f, 0.001f, 0.002f, 0.01f } };
+    auto table = compute_deprojection_table(intrin);
+
+    std::mt19937 rng(42);
+    std::vector<uint16_t> depth(intrin.width * intrin.height);
+    for(auto & d : depth) d = rng() % 8 ? static_cast<uint16_t>(rng()) : 0; // Include some invalid pixels
+
+    const float scale = 0.001f;
+    std::vector<float> z_expected, disparity_expected;
+    for(int y = 0; y < intrin.height; ++y) for(int x = 0; x < intrin.width; ++x)
+    {
+        const float pixel[] = { (float)x, (float)y }, z = depth[y * intrin.width + x];
+        float point[3];
+        rs_deproject_pixel_to_point(point, &intrin, pixel, scale * z);
+        z_expected.insert(z_expected.end(), point, point + 3);
+        rs_deproject_pixel_to_point(point, &intrin, pixel, scale / z);
+        disparity_expected.insert(disparity_expected.end(), point, point + 3);
+    }
+
+    const auto supported = get_supported_simd_level();
+    std::vector<float> z_reference, disparity_reference;
+    for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+    {
+        set_simd_level((simd_level)level);
+        std::vector<float> z_points(depth.size() * 3), disparity_points(depth.size() * 3);
+        deproject_z(z_points.data(), table, depth.data(), scale);
+        deproject_disparity(disparity_points.data(), table, depth.data(), scale);
+        if(z_reference.empty())
+        {
+            require_approx_equal(z_points.data(), z_expected.data(), z_points.size());
+            z_reference = z_points;
+            disparity_reference = disparity_points;
+        }
+        REQUIRE(memcmp(z_points.data(), z_reference.data(), z_points.size() * sizeof(float)) == 0);
+
+        // Zero disparity has no finite point, and under -Ofast nothing is guaranteed about what is written for it
+        for(size_t i = 0; i < depth.size(); ++i) if(depth[i])
+        {
+            require_approx_equal(&disparity_points[i * 3], &disparity_expected[i * 3], 3);
+            REQUIRE(memcmp(&disparity_points[i * 3], &disparity_reference[i * 3], sizeof(float) * 3) == 0);
+        }
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "compact deprojection keeps exactly the points of pixels with depth, with their indices and texture coordinates", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics depth_intrin = { 61, 37, 30.5f, 18.2f, 55.1f, 54.9f, RS_DISTORTION_INVERSE_BROWN_CONRADY, { 0.1f, -0.05f, 0.001f, 0.002f, 0.01f } };
+    rs_intrinsics color_intrin = { 83, 51, 41.3f, 25.6f, 70.2f, 70.4f, RS_DISTORTION_MODIFIED_BROWN_CONRADY, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+    rs_extrinsics depth_to_color = { { 0.999f, 0.02f, -0.03f, -0.02f, 0.999f, 0.01f, 0.03f, -0.01f, 0.999f }, { 0.025f, 0.001f, -0.002f } };
+    auto table = compute_deprojection_table(depth_intrin);
+
+    // Runs of pixels with and without depth, as well as isolated holes
+    std::mt19937 rng(42);
+    std::vector<uint16_t> depth(depth_intrin.width * depth_intrin.height);
+    for(size_t i = 0; i < depth.size(); i += 5)
+    {
+        const auto kind = rng() % 3;
+        for(size_t j = i; j < std::min(i + 5, depth.size()); ++j) depth[j] = kind == 0 || (kind == 2 && rng() % 2) ? 0 : static_cast<uint16_t>(200 + rng() % 2000);
+    }
+
+    const float scale = 0.001f;
+    std::vector<float> z_full(depth.size() * 3), disparity_full(depth.size() * 3);
+    set_simd_level(simd_level::generic);
+    deproject_z(z_full.data(), table, depth.data(), scale);
+    deproject_disparity(disparity_full.data(), table, depth.data(), scale);
+
+    std::vector<int> indices(depth.size());
+    find_valid_pixels(indices.data(), depth.data(), (int)depth.size());
+    const int count = (int)std::count_if(depth.begin(), depth.end(), [](uint16_t d) { return d != 0; });
+    for(int i = 0; i < count; ++i) REQUIRE(depth[indices[i]] != 0);
+    for(int i = 1; i < count; ++i) REQUIRE(indices[i - 1] < indices[i]);
+
+    const auto supported = get_supported_simd_level();
+    for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+    {
+        set_simd_level((simd_level)level);
+        std::vector<float> points(depth.size() * 3);
+        REQUIRE(deproject_z_compact(points.data(), table, depth.data(), scale) == count);
+        for(int i = 0; i < count; ++i) REQUIRE(memcmp(&points[i * 3], &z_full[indices[i] * 3], sizeof(float) * 3) == 0);
+        REQUIRE(deproject_disparity_compact(points.data(), table, depth.data(), scale) == count);
+        for(int i = 0; i < count; ++i) require_approx_equal(&points[i * 3], &disparity_full[indices[i] * 3], 3); // Vectorized division may round differently under -Ofast
+
+        std::vector<float> uv(count * 2);
+        deproject_z_compact(points.data(), table, depth.data(), scale);
+        compute_texture_coordinates(uv.data(), points.data(), count, depth_to_color, color_intrin);
+        for(int i = 0; i < count; ++i)
+        {
+            float color_point[3], color_pixel[2];
+            rs_transform_point_to_point(color_point, &depth_to_color, &points[i * 3]);
+            rs_project_point_to_pixel(color_pixel, &color_intrin, color_point);
+            REQUIRE(uv[i * 2 + 0] == Approx(color_pixel[0] / color_intrin.width));
+            REQUIRE(uv[i * 2 + 1] == Approx(color_pixel[1] / color_intrin.height));
+        }
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "colored deprojection matches deprojecting and projecting each point into the color image", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics depth_intrin = { 61, 37, 30.5f, 18.2f, 55.1f, 54.9f, RS_DISTORTION_INVERSE_BROWN_CONRADY, { 0.1f, -0.05f, 0.001f, 0.002f, 0.01f } };
+    rs_intrinsics color_intrin = { 83, 51, 41.3f, 25.6f, 70.2f, 70.4f, RS_DISTORTION_MODIFIED_BROWN_CONRADY, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+    rs_extrinsics depth_to_color = { { 0.999f, 0.02f, -0.03f, -0.02f, 0.999f, 0.01f, 0.03f, -0.01f, 0.999f }, { 0.025f, 0.001f, -0.002f } };
+    auto table = compute_deprojection_table(depth_intrin);
+
+    std::mt19937 rng(42);
+    std::vector<uint16_t> depth(depth_intrin.width * depth_intrin.height);
+    for(auto & d : depth) d = rng() % 8 ? static_cast<uint16_t>(200 + rng() % 2000) : 0;
+    std::vector<uint8_t> color(color_intrin.width * color_intrin.height * 4);
+    for(auto & c : color) c = static_cast<uint8_t>(rng());
+
+    for(bool disparity : { false, true })
+    {
+        const float scale = disparity ? 440.0f : 0.001f;
+        std::vector<float> points(depth.size() * 3);
+        if(disparity) deproject_disparity(points.data(), table, depth.data(), scale);
+        else deproject_z(points.data(), table, depth.data(), scale);
+
+        for(auto format : { RS_FORMAT_RGB8, RS_FORMAT_BGRA8, RS_FORMAT_Y8 })
+        {
+            std::vector<uint8_t> colored(get_image_size(depth_intrin.width, depth_intrin.height, RS_FORMAT_XYZRGB));
+            if(disparity) deproject_disparity_colored(colored.data(), table, depth.data(), scale, depth_to_color, color_intrin, color.data(), format);
+            else deproject_z_colored(colored.data(), table, depth.data(), scale, depth_to_color, color_intrin, color.data(), format);
+
+            int colored_count = 0;
+            for(size_t i = 0; i < depth.size(); ++i)
+            {
+                auto point = &points[i * 3];
+                auto out = &colored[i * 16];
+                REQUIRE(memcmp(out, point, sizeof(float) * 3) == 0);
+
+                float color_point[3], color_pixel[2];
+                rs_transform_point_to_point(color_point, &depth_to_color, point);
+                rs_project_point_to_pixel(color_pixel, &color_intrin, color_point);
+                const int x = (int)std::floor(color_pixel[0] + 0.5f), y = (int)std::floor(color_pixel[1] + 0.5f);
+                uint8_t rgb[3] = {};
+                if(depth[i] && x >= 0 && y >= 0 && x < color_intrin.width && y < color_intrin.height)
+                {
+                    auto c = &color[(y * color_intrin.width + x) * (format == RS_FORMAT_RGB8 ? 3 : format == RS_FORMAT_BGRA8 ? 4 : 1)];
+                    if(format == RS_FORMAT_RGB8) rgb[0] = c[0], rgb[1] = c[1], rgb[2] = c[2];
+                    if(format == RS_FORMAT_BGRA8) rgb[0] = c[2], rgb[1] = c[1], rgb[2] = c[0];
+                    if(format == RS_FORMAT_Y8) rgb[0] = rgb[1] = rgb[2] = c[0];
+                    ++colored_count;
+                }
+                REQUIRE(memcmp(out + 12, rgb, 3) == 0);
+                REQUIRE(out[15] == 0);
+            }
+            REQUIRE(colored_count > (int)depth.size() / 2);
+        }
+    }
+}
+
+TEST_CASE( "point clouds convert to half precision and millimeters identically at every simd level", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    const float nan = std::numeric_limits<float>::quiet_NaN(), inf = std::numeric_limits<float>::infinity();
+    std::vector<float> points = { 1.0f, -2.0f, 0.1f, 65504.0f, 65519.0f, 65520.0f, 5.9604645e-8f, 2.9802322e-8f, 8.940697e-8f, 6.1035156e-5f, inf, -inf, nan, 0.0f, -0.0f,
+                                  0.25f, -0.25f, 32.767f, 32.768f, -32.768f, -32.769f, 40.0f, -40.0f };
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> meters(-40, 40);
+    while(points.size() < 1000) points.push_back(meters(rng));
+
+    const uint16_t halves[] = { 0x3C00, 0xC000, 0x2E66, 0x7BFF, 0x7BFF, 0x7C00, 0x0001, 0x0000, 0x0002, 0x0400, 0x7C00, 0xFC00 };
+    const int16_t millimeters[] = { 1000, -2000, 100, 32767, 32767, 32767, 0, 0, 0, 0, 32767, -32768, -32768, 0, 0, 250, -250, 32767, 32767, -32768, -32768, 32767, -32768 };
+
+    std::vector<uint16_t> xyz16f_expected(points.size()), xyz16f(points.size());
+    std::vector<int16_t> xyz16_expected(points.size()), xyz16(points.size());
+    set_simd_level(simd_level::generic);
+    convert_points_to_xyz16f(xyz16f_expected.data(), points.data(), (int)points.size());
+    convert_points_to_xyz16(xyz16_expected.data(), points.data(), (int)points.size());
+    for(size_t i = 0; i < sizeof(halves) / sizeof(halves[0]); ++i) REQUIRE(xyz16f_expected[i] == halves[i]);
+    REQUIRE((xyz16f_expected[12] & 0x7E00) == 0x7E00); // NaN stays a quiet NaN
+    for(size_t i = 0; i < sizeof(millimeters) / sizeof(millimeters[0]); ++i) REQUIRE(xyz16_expected[i] == millimeters[i]);
+
+    const auto supported = get_supported_simd_level();
+    for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+    {
+        set_simd_level((simd_level)level);
+        for(int count : { 1000, 997 }) // Including a count the vector kernels leave a remainder of
+        {
+            convert_points_to_xyz16f(xyz16f.data(), points.data(), count);
+            convert_points_to_xyz16(xyz16.data(), points.data(), count);
+            REQUIRE(std::equal(xyz16f.begin(), xyz16f.begin() + count, xyz16f_expected.begin()));
+            REQUIRE(std::equal(xyz16.begin(), xyz16.begin() + count, xyz16_expected.begin()));
+        }
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "alignment matches per-pixel projection at every simd level and thread count", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics depth_intrin = { 61, 37, 30.5f, 18.2f, 55.1f, 54.9f, RS_DISTORTION_INVERSE_BROWN_CONRADY, { 0.1f, -0.05f, 0.001f, 0.002f, 0.01f } };
+    rs_intrinsics color_intrin = { 83, 51, 41.3f, 25.6f, 70.2f, 70.4f, RS_DISTORTION_MODIFIED_BROWN_CONRADY, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+    rs_extrinsics depth_to_color = { { 0.999f, 0.02f, -0.03f, -0.02f, 0.999f, 0.01f, 0.03f, -0.01f, 0.999f }, { 0.025f, 0.001f, -0.002f } };
+
+    std::mt19937 rng(42);
+    std::vector<uint16_t> depth(depth_intrin.width * depth_intrin.height);
+    for(auto & d : depth) d = rng() % 8 ? static_cast<uint16_t>(200 + rng() % 2000) : 0; // Include some invalid pixels
+    std::vector<uint8_t> color(color_intrin.width * color_intrin.height * 3);
+    for(auto & c : color) c = static_cast<uint8_t>(rng());
+
+    // Project both corners of every depth pixel one at a time, as alignment was originally specified
+    auto align_reference = [&](std::function<float(int)> get_depth, std::function<void(int, int)> transfer_pixel)
+    {
+        for(int depth_y = 0; depth_y < depth_intrin.height; ++depth_y) for(int depth_x = 0; depth_x < depth_intrin.width; ++depth_x)
+        {
+            const int depth_pixel_index = depth_y * depth_intrin.width + depth_x;
+            if(!get_depth(depth_pixel_index)) continue;
+            int corners[2][2];
+            for(int i = 0; i < 2; ++i)
+            {
+                const float depth_pixel[] = { depth_x - 0.5f + i, depth_y - 0.5f + i };
+                float depth_point[3], color_point[3], color_pixel[2];
+                rs_deproject_pixel_to_point(depth_point, &depth_intrin, depth_pixel, get_depth(depth_pixel_index));
+                rs_transform_point_to_point(color_point, &depth_to_color, depth_point);
+                rs_project_point_to_pixel(color_pixel, &color_intrin, color_point);
+                corners[i][0] = static_cast<int>(color_pixel[0] + 0.5f);
+                corners[i][1] = static_cast<int>(color_pixel[1] + 0.5f);
+            }
+            if(corners[0][0] < 0 || corners[0][1] < 0 || corners[1][0] >= color_intrin.width || corners[1][1] >= color_intrin.height) continue;
+            for(int y = corners[0][1]; y <= corners[1][1]; ++y) for(int x = corners[0][0]; x <= corners[1][0]; ++x) transfer_pixel(depth_pixel_index, y * color_intrin.width + x);
+        }
+    };
+
+    const float scale = 0.001f;
+    std::vector<uint16_t> z_expected(color_intrin.width * color_intrin.height), disparity_expected(z_expected.size(), 0xFFFF);
+    std::vector<uint8_t> color_expected(depth.size() * 3);
+    align_reference([&](int i) { return scale * depth[i]; }, [&](int depth_pixel_index, int color_pixel_index)
+    {
+        auto & z = z_expected[color_pixel_index];
+        z = z ? std::min(z, depth[depth_pixel_index]) : depth[depth_pixel_index];
+        std::copy_n(&color[color_pixel_index * 3], 3, &color_expected[depth_pixel_index * 3]);
+    });
+    const float disparity_scale = 440.0f; // Reusing the depth values as disparities turns overlaps around, since the last write wins
+    align_reference([&](int i) { return disparity_scale / depth[i]; }, [&](int depth_pixel_index, int color_pixel_index) { disparity_expected[color_pixel_index] = depth[depth_pixel_index]; });
+
+    worker_pool pool(4);
+    const auto supported = get_supported_simd_level();
+    for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+    {
+        set_simd_level((simd_level)level);
+        for(auto p : { (worker_pool *)nullptr, &pool })
+        {
+            alignment_workspace workspace;
+            workspace.pool = p;
+            std::vector<uint16_t> z(z_expected.size());
+            align_z_to_other((byte *)z.data(), depth.data(), scale, depth_intrin, depth_to_color, color_intrin, workspace);
+            REQUIRE(z == z_expected);
+
+            std::vector<uint16_t> disparity(disparity_expected.size(), 0xFFFF);
+            align_disparity_to_other((byte *)disparity.data(), depth.data(), disparity_scale, depth_intrin, depth_to_color, color_intrin, workspace);
+            REQUIRE(disparity == disparity_expected);
+
+            std::vector<uint8_t> color_aligned(color_expected.size());
+            align_other_to_z(color_aligned.data(), depth.data(), scale, depth_intrin, depth_to_color, color_intrin, color.data(), RS_FORMAT_RGB8, workspace);
+            REQUIRE(color_aligned == color_expected);
+        }
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "incremental alignment matches aligning every frame from scratch", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics depth_intrin = { 100, 37, 50.5f, 18.2f, 55.1f, 54.9f, RS_DISTORTION_INVERSE_BROWN_CONRADY, { 0.1f, -0.05f, 0.001f, 0.002f, 0.01f } };
+    rs_intrinsics color_intrin = { 120, 51, 60.3f, 25.6f, 70.2f, 70.4f, RS_DISTORTION_MODIFIED_BROWN_CONRADY, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+    rs_extrinsics depth_to_color = { { 1, 0, 0, 0, 1, 0, 0, 0, 1 }, { 0.025f, 0.001f, -0.002f } };
+
+    std::mt19937 rng(42);
+    std::vector<uint16_t> depth(depth_intrin.width * depth_intrin.height);
+    for(auto & d : depth) d = rng() % 8 ? static_cast<uint16_t>(200 + rng() % 2000) : 0;
+    std::vector<uint8_t> color(color_intrin.width * color_intrin.height * 3);
+    for(auto & c : color) c = static_cast<uint8_t>(rng());
+
+    alignment_workspace z_workspace, disparity_workspace;
+    z_workspace.incremental = disparity_workspace.incremental = true;
+    for(int frame = 0; frame < 7; ++frame)
+    {
+        switch(frame)
+        {
+        case 2: for(int y = 10; y < 14; ++y) for(int x = 40; x < 45; ++x) depth[y * depth_intrin.width + x] += 100; break; // A small object moves
+        case 3: depth[depth.size() - 1] = 0; break; // The last pixel of a partial block loses its depth
+        case 4: depth_to_color.translation[0] = 0.03f; break; // The camera is recalibrated
+        case 5: color_intrin.fx = 71.0f; break;
+        case 6: break; // Switching between depth and disparity units invalidates the previous rectangles
+        }
+
+        std::vector<uint16_t> z(color_intrin.width * color_intrin.height), z_expected(z.size());
+        align_z_to_other((byte *)z.data(), depth.data(), 0.001f, depth_intrin, depth_to_color, color_intrin, frame < 6 ? z_workspace : disparity_workspace);
+        align_z_to_other((byte *)z_expected.data(), depth.data(), 0.001f, depth_intrin, depth_to_color, color_intrin);
+        REQUIRE(z == z_expected);
+
+        std::vector<uint8_t> color_aligned(depth.size() * 3), color_expected(color_aligned.size());
+        align_other_to_disparity(color_aligned.data(), depth.data(), 440.0f, depth_intrin, depth_to_color, color_intrin, color.data(), RS_FORMAT_RGB8, frame < 6 ? disparity_workspace : z_workspace);
+        align_other_to_disparity(color_expected.data(), depth.data(), 440.0f, depth_intrin, depth_to_color, color_intrin, color.data(), RS_FORMAT_RGB8);
+        REQUIRE(color_aligned == color_expected);
+    }
+}
+
+TEST_CASE( "bilinear rectification is exact for an identity mapping and identical at every simd level", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics rect_intrin = { 77, 29, 38.2f, 14.1f, 60.0f, 60.0f, RS_DISTORTION_NONE, {} };
+    rs_intrinsics unrect_intrin = { 81, 31, 40.3f, 15.6f, 62.2f, 61.4f, RS_DISTORTION_MODIFIED_BROWN_CONRADY, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+    rs_extrinsics identity = { { 1, 0, 0, 0, 1, 0, 0, 0, 1 }, {} }, rect_to_unrect = { { 0.999f, 0.02f, -0.03f, -0.02f, 0.999f, 0.01f, 0.03f, -0.01f, 0.999f }, {} };
+
+    std::mt19937 rng(42);
+    std::vector<uint8_t> unrect(unrect_intrin.width * unrect_intrin.height * 4);
+    for(auto & b : unrect) b = static_cast<uint8_t>(rng());
+
+    const auto supported = get_supported_simd_level();
+    for(auto format : { RS_FORMAT_Y8, RS_FORMAT_Y16, RS_FORMAT_Z16, RS_FORMAT_RGB8, RS_FORMAT_RGBA8 })
+    {
+        // Every pixel center lands exactly on a source pixel
+        auto undistorted = unrect_intrin;
+        undistorted.model = RS_DISTORTION_NONE;
+        auto table = compute_rectification_table(undistorted, identity, undistorted, true);
+        std::vector<uint8_t> rect(get_image_size(unrect_intrin.width, unrect_intrin.height, format));
+        rectify_image(rect.data(), table, unrect.data(), format);
+        REQUIRE(memcmp(rect.data(), unrect.data(), rect.size()) == 0);
+
+        table = compute_rectification_table(rect_intrin, rect_to_unrect, unrect_intrin, true);
+        REQUIRE(std::count(table.index.begin(), table.index.end(), -1) > 0);
+        std::vector<uint8_t> expected(get_image_size(rect_intrin.width, rect_intrin.height, format));
+        set_simd_level(simd_level::generic);
+        rectify_image(expected.data(), table, unrect.data(), format);
+        for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+        {
+            set_simd_level((simd_level)level);
+            rect.assign(expected.size(), 0xcd);
+            rectify_image(rect.data(), table, unrect.data(), format);
+            REQUIRE(rect == expected);
+        }
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "nearest rectification copies the source pixel nearest to each point, and is exact for an identity mapping", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    rs_intrinsics rect_intrin = { 77, 29, 38.2f, 14.1f, 60.0f, 60.0f, RS_DISTORTION_NONE, {} };
+    rs_intrinsics unrect_intrin = { 81, 31, 40.3f, 15.6f, 62.2f, 61.4f, RS_DISTORTION_MODIFIED_BROWN_CONRADY, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+    rs_extrinsics identity = { { 1, 0, 0, 0, 1, 0, 0, 0, 1 }, {} }, rect_to_unrect = { { 0.999f, 0.02f, -0.03f, -0.02f, 0.999f, 0.01f, 0.03f, -0.01f, 0.999f }, {} };
+
+    std::mt19937 rng(42);
+    std::vector<uint8_t> unrect(unrect_intrin.width * unrect_intrin.height * 4);
+    for(auto & b : unrect) b = static_cast<uint8_t>(rng());
+
+    // The nearest pixel is one of the four around the point, and both tables agree on which points lie outside the source
+    const auto nearest = compute_rectification_table(rect_intrin, rect_to_unrect, unrect_intrin, false), bilinear = compute_rectification_table(rect_intrin, rect_to_unrect, unrect_intrin, true);
+    REQUIRE(nearest.fraction.empty());
+    for(size_t i = 0; i < nearest.index.size(); ++i)
+    {
+        if(bilinear.index[i] < 0)
+        {
+            REQUIRE(nearest.index[i] == -1);
+            continue;
+        }
+        const int offset = nearest.index[i] - bilinear.index[i];
+        REQUIRE((offset == 0 || offset == 1 || offset == unrect_intrin.width || offset == unrect_intrin.width + 1));
+    }
+
+    for(auto format : { RS_FORMAT_Y8, RS_FORMAT_Y16, RS_FORMAT_Z16, RS_FORMAT_RGB8, RS_FORMAT_RGBA8 })
+    {
+        auto undistorted = unrect_intrin;
+        undistorted.model = RS_DISTORTION_NONE;
+        std::vector<uint8_t> rect(get_image_size(unrect_intrin.width, unrect_intrin.height, format));
+        rectify_image(rect.data(), compute_rectification_table(undistorted, identity, undistorted, false), unrect.data(), format);
+        REQUIRE(memcmp(rect.data(), unrect.data(), rect.size()) == 0);
+
+        // Pixels that see outside the source are black
+        const size_t bpp = get_image_bpp(format) / 8;
+        rect.assign(get_image_size(rect_intrin.width, rect_intrin.height, format), 0xcd);
+        rectify_image(rect.data(), nearest, unrect.data(), format);
+        for(size_t i = 0; i < nearest.index.size(); ++i)
+        {
+            const uint8_t black[4] = {};
+            REQUIRE(memcmp(rect.data() + i * bpp, nearest.index[i] < 0 ? black : unrect.data() + nearest.index[i] * bpp, bpp) == 0);
+        }
+    }
+}
+
+TEST_CASE( "batched projection matches rsutil.h to within rounding, round trips every distortion model, and is identical at every simd level", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    const int count = 1003; // Not a multiple of any vector width
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> lateral(-1, 1), depth(0.3f, 4.0f);
+    std::vector<float> points(count * 3), point_x(count), point_y(count), point_z(count);
+    auto generate_points = [&](float spread)
+    {
+        for(int i = 0; i < count; ++i)
+        {
+            point_z[i] = points[i*3+2] = depth(rng);
+            point_x[i] = points[i*3+0] = lateral(rng) * spread * point_z[i];
+            point_y[i] = points[i*3+1] = lateral(rng) * spread * point_z[i];
+        }
+    };
+    const rs_extrinsics extrin = { { 0.999f, 0.02f, -0.03f, -0.02f, 0.999f, 0.01f, 0.03f, -0.01f, 0.999f }, { 0.025f, 0.001f, -0.002f } };
+
+    const auto supported = get_supported_simd_level();
+    for(auto model : { RS_DISTORTION_NONE, RS_DISTORTION_MODIFIED_BROWN_CONRADY, RS_DISTORTION_INVERSE_BROWN_CONRADY, RS_DISTORTION_FTHETA })
+    {
+        rs_intrinsics intrin = { 640, 480, 320.5f, 240.2f, 610.1f, 609.7f, model, { 0.12f, -0.25f, 0.002f, -0.001f, 0.1f } };
+        if(model == RS_DISTORTION_FTHETA) intrin.coeffs[0] = 0.92f;
+        generate_points(model == RS_DISTORTION_FTHETA ? 2.0f : 0.4f); // A fisheye lens sees up to 70 degrees off its axis
+
+        std::vector<float> expected_pixels, expected_points;
+        for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+        {
+            set_simd_level((simd_level)level);
+            std::vector<float> pixels(count * 2), pixel_x(count), pixel_y(count);
+            rs_project_points_to_pixels(pixels.data(), &intrin, points.data(), count, require_no_error());
+            rs_project_points_to_pixels_soa(pixel_x.data(), pixel_y.data(), &intrin, point_x.data(), point_y.data(), point_z.data(), count, require_no_error());
+            for(int i = 0; i < count; ++i)
+            {
+                REQUIRE(pixels[i*2+0] == pixel_x[i]);
+                REQUIRE(pixels[i*2+1] == pixel_y[i]);
+                if(model == RS_DISTORTION_NONE || model == RS_DISTORTION_MODIFIED_BROWN_CONRADY)
+                {
+                    float pixel[2];
+                    rs_project_point_to_pixel(pixel, &intrin, &points[i*3]);
+                    require_approx_equal(&pixels[i*2], pixel, 2, intrin.fx);
+                }
+            }
+            if(expected_pixels.empty()) expected_pixels = pixels;
+            REQUIRE(pixels == expected_pixels);
+
+            std::vector<float> deprojected(count * 3), deprojected_x(count), deprojected_y(count), deprojected_z(count);
+            rs_deproject_pixels_to_points(deprojected.data(), &intrin, pixels.data(), point_z.data(), count, require_no_error());
+            rs_deproject_pixels_to_points_soa(deprojected_x.data(), deprojected_y.data(), deprojected_z.data(), &intrin, pixel_x.data(), pixel_y.data(), point_z.data(), count, require_no_error());
+            for(int i = 0; i < count; ++i)
+            {
+                REQUIRE(deprojected[i*3+0] == deprojected_x[i]);
+                REQUIRE(deprojected[i*3+1] == deprojected_y[i]);
+                REQUIRE(deprojected[i*3+2] == deprojected_z[i]);
+                REQUIRE(std::abs(deprojected[i*3+0] - points[i*3+0]) < 0.0001f * points[i*3+2]);
+                REQUIRE(std::abs(deprojected[i*3+1] - points[i*3+1]) < 0.0001f * points[i*3+2]);
+                REQUIRE(deprojected[i*3+2] == points[i*3+2]);
+                if(model == RS_DISTORTION_NONE || model == RS_DISTORTION_INVERSE_BROWN_CONRADY)
+                {
+                    float point[3];
+                    rs_deproject_pixel_to_point(point, &intrin, &pixels[i*2], point_z[i]);
+                    require_approx_equal(&deprojected[i*3], point, 3);
+                }
+            }
+            if(expected_points.empty()) expected_points = deprojected;
+            REQUIRE(deprojected == expected_points);
+        }
+    }
+
+    std::vector<float> expected_transformed;
+    for(int level = (int)simd_level::generic; level <= (int)supported; ++level)
+    {
+        set_simd_level((simd_level)level);
+        std::vector<float> transformed = points, transformed_x = point_x, transformed_y = point_y, transformed_z = point_z;
+        rs_transform_points_to_points(transformed.data(), &extrin, transformed.data(), count, require_no_error());
+        rs_transform_points_to_points_soa(transformed_x.data(), transformed_y.data(), transformed_z.data(), &extrin, transformed_x.data(), transformed_y.data(), transformed_z.data(), count, require_no_error());
+        for(int i = 0; i < count; ++i)
+        {
+            float point[3];
+            rs_transform_point_to_point(point, &extrin, &points[i*3]);
+            require_approx_equal(&transformed[i*3], point, 3);
+            REQUIRE(transformed_x[i] == transformed[i*3+0]);
+            REQUIRE(transformed_y[i] == transformed[i*3+1]);
+            REQUIRE(transformed_z[i] == transformed[i*3+2]);
+        }
+        if(expected_transformed.empty()) expected_transformed = transformed;
+        REQUIRE(transformed == expected_transformed);
+    }
+    set_simd_level(supported);
+}
+
+TEST_CASE( "unpacking in row bands on a worker pool produces the same image", "[offline] [validation]" )
+{
+    using namespace rsimpl;
+    worker_pool pool(4);
+    std::mt19937 rng(42);
+    for(auto pf : { &pf_yuy2, &pf_rw10 }) for(int pad_crop : { 0, 4, -4 }) // Padding and cropping make the unpacker work row by row
+    {
+        subdevice_mode mode = {};
+        mode.native_dims = { 640, 480 };
+        mode.pf = *pf;
+        mode.native_intrinsics.width = 640;
+        mode.native_intrinsics.height = 480;
+        subdevice_mode_selection selection(mode, pad_crop, 0);
+
+        // RAW10 pixels are bit-packed into more bytes than the native format advertises
+        std::vector<byte> source(std::max(mode.pf.get_image_size(640, 480), get_image_size(640, 480, RS_FORMAT_RAW10)));
+        for(auto & b : source) b = static_cast<byte>(rng());
+        std::vector<byte> single(get_image_size(selection.get_width(), selection.get_height(), selection.get_format(RS_STREAM_COLOR))), banded(single.size());
+        byte * dest[] = { single.data() };
+        selection.unpack(dest, source.data());
+        dest[0] = banded.data();
+        selection.unpack(dest, source.data(), &pool);
+        REQUIRE(single == banded);
+    }
+}
+
+TEST_CASE( "derived frames are computed once per source frame and shared by concurrent readers", "[offline] [validation]" )
+{
+    rsimpl::derived_frame<std::vector<int>> frame;
+    std::atomic<unsigned long long> number(0);
+    std::atomic<int> computed(0);
+    auto key = [&]() { return std::make_pair(number.load(), 0ULL); };
+    auto compute = [&](std::vector<int> & data) { ++computed; data.assign(1000, static_cast<int>(number.load())); };
+
+    rsimpl::derived_frame<std::vector<int>>::reference first;
+    const std::vector<int> * previous = nullptr;
+    std::set<const std::vector<int> *> slots;
+    for(int i = 1; i <= 50; ++i)
+    {
+        number = i;
+        rsimpl::derived_frame<std::vector<int>>::reference results[4];
+        std::vector<std::thread> readers;
+        for(auto & result : results) readers.emplace_back([&]() { result = frame.get(key, compute); });
+        for(auto & reader : readers) reader.join();
+
+        REQUIRE(computed == i);
+        for(auto & result : results)
+        {
+            REQUIRE(result == results[0]);
+            REQUIRE(std::count(begin(*result), end(*result), i) == 1000);
+        }
+
+        // The previous frame is still intact after the next one is published, even if no reader holds it
+        if(previous) REQUIRE(std::count(begin(*previous), end(*previous), i - 1) == 1000);
+        previous = results[0].get();
+
+        // A frame a reader holds stays intact however many frames are published after it
+        if(!first) first = results[0];
+        REQUIRE(std::count(begin(*first), end(*first), 1) == 1000);
+        slots.insert(results[0].get());
+    }
+
+    // Slots are reused once released, so the held first frame costs one slot beside the published frame and the one before it
+    REQUIRE(slots.size() == 4);
+
+    // A failed computation is not published, and the next reader computes the frame again
+    number = 51;
+    REQUIRE_THROWS(frame.get(key, [](std::vector<int> &) { throw std::runtime_error("failed"); }));
+    REQUIRE((*frame.get(key, compute))[0] == 51);
+    REQUIRE(computed == 51);
+}
+
 TEST_CASE( "rs_create_context() returns a valid context", "[offline] [validation]" )
 {
     safe_context ctx;